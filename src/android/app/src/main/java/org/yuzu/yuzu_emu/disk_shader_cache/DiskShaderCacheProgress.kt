@@ -40,12 +40,20 @@ object DiskShaderCacheProgress {
                 )
 
                 LoadCallbackStage.Complete -> {}
+                LoadCallbackStage.HotSetReady -> emulationViewModel.updateProgress(
+                    emulationActivity.getString(
+                        R.string.building_shaders_background,
+                        max - progress
+                    ),
+                    progress,
+                    max
+                )
             }
         }
     }
 
     // Equivalent to VideoCore::LoadCallbackStage
     enum class LoadCallbackStage {
-        Prepare, Build, Complete
+        Prepare, Build, Complete, HotSetReady
     }
 }
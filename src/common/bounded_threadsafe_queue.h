@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
@@ -246,4 +247,107 @@ private:
     std::mutex read_mutex;
 };
 
+/**
+ * Bounded multi-producer single-consumer queue. Producers claim a slot with a single atomic
+ * increment and never take a lock unless the queue is full. The consumer is only notified while
+ * it sleeps, so a burst of pushes costs at most one wakeup.
+ */
+template <typename T, size_t Capacity = detail::DefaultCapacity>
+class LockFreeMPSCQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    LockFreeMPSCQueue() {
+        for (size_t index = 0; index < Capacity; ++index) {
+            m_slots[index].sequence.store(index, std::memory_order::relaxed);
+        }
+    }
+
+    /// Pushes an element, waiting for a free slot when the queue is full.
+    /// Returns the position of the element, elements are popped in increasing position order.
+    template <typename... Args>
+    size_t EmplaceWait(Args&&... args) {
+        const size_t position = m_write_index.fetch_add(1, std::memory_order::relaxed);
+        Slot& slot = m_slots[position % Capacity];
+        if (slot.sequence.load(std::memory_order::acquire) != position) {
+            WaitForSlot(slot, position);
+        }
+        slot.data = T(std::forward<Args>(args)...);
+        slot.sequence.store(position + 1, std::memory_order::release);
+
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (m_consumer_waiting.load(std::memory_order::relaxed)) {
+            std::scoped_lock lock{consumer_cv_mutex};
+            consumer_cv.notify_one();
+        }
+        return position;
+    }
+
+    bool TryPop(T& t) {
+        Slot& slot = m_slots[m_read_index % Capacity];
+        if (slot.sequence.load(std::memory_order::acquire) != m_read_index + 1) {
+            return false;
+        }
+        t = std::move(slot.data);
+        slot.sequence.store(m_read_index + Capacity, std::memory_order::release);
+        ++m_read_index;
+
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (m_waiting_producers.load(std::memory_order::relaxed) != 0) {
+            std::scoped_lock lock{producer_cv_mutex};
+            producer_cv.notify_all();
+        }
+        return true;
+    }
+
+    void PopWait(T& t, std::stop_token stop_token) {
+        if (TryPop(t)) {
+            return;
+        }
+        {
+            std::unique_lock lock{consumer_cv_mutex};
+            m_consumer_waiting.store(true, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            Common::CondvarWait(consumer_cv, lock, stop_token, [this] {
+                const Slot& slot = m_slots[m_read_index % Capacity];
+                return slot.sequence.load(std::memory_order::acquire) == m_read_index + 1;
+            });
+            m_consumer_waiting.store(false, std::memory_order::relaxed);
+        }
+        if (stop_token.stop_requested()) {
+            return;
+        }
+        TryPop(t);
+    }
+
+private:
+    struct Slot {
+        /// Position that may be written to the slot, plus one when the slot holds data
+        std::atomic_size_t sequence;
+        T data{};
+    };
+
+    void WaitForSlot(Slot& slot, size_t position) {
+        std::unique_lock lock{producer_cv_mutex};
+        m_waiting_producers.fetch_add(1, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        producer_cv.wait(lock, [&slot, position] {
+            return slot.sequence.load(std::memory_order::acquire) == position;
+        });
+        m_waiting_producers.fetch_sub(1, std::memory_order::relaxed);
+    }
+
+    alignas(128) std::atomic_size_t m_write_index{0};
+    alignas(128) size_t m_read_index{0};
+    std::atomic_bool m_consumer_waiting{false};
+    std::atomic_size_t m_waiting_producers{0};
+
+    std::array<Slot, Capacity> m_slots;
+
+    std::condition_variable_any producer_cv;
+    std::mutex producer_cv_mutex;
+    std::condition_variable_any consumer_cv;
+    std::mutex consumer_cv_mutex;
+};
+
 } // namespace Common
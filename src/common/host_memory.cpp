@@ -92,14 +92,7 @@ public:
     explicit Impl(size_t backing_size_, size_t virtual_size_)
         : backing_size{backing_size_}, virtual_size{virtual_size_}, process{GetCurrentProcess()},
           kernelbase_dll("Kernelbase") {
-        if (!kernelbase_dll.IsOpen()) {
-            LOG_CRITICAL(HW_Memory, "Failed to load Kernelbase.dll");
-            throw std::bad_alloc{};
-        }
-        GetFuncAddress(kernelbase_dll, "CreateFileMapping2", pfn_CreateFileMapping2);
-        GetFuncAddress(kernelbase_dll, "VirtualAlloc2", pfn_VirtualAlloc2);
-        GetFuncAddress(kernelbase_dll, "MapViewOfFile3", pfn_MapViewOfFile3);
-        GetFuncAddress(kernelbase_dll, "UnmapViewOfFile2", pfn_UnmapViewOfFile2);
+        LoadFunctions();
 
         // Allocate backing file map
         backing_handle =
@@ -128,16 +121,23 @@ public:
             LOG_CRITICAL(HW_Memory, "Failed to map {} MiB of virtual memory", backing_size >> 20);
             throw std::bad_alloc{};
         }
-        // Allocate virtual address placeholder
-        virtual_base = static_cast<u8*>(pfn_VirtualAlloc2(process, nullptr, virtual_size,
-                                                          MEM_RESERVE | MEM_RESERVE_PLACEHOLDER,
-                                                          PAGE_NOACCESS, nullptr, 0));
-        if (!virtual_base) {
-            Release();
-            LOG_CRITICAL(HW_Memory, "Failed to reserve {} GiB of virtual memory",
-                         virtual_size >> 30);
+        ReserveVirtualMemory();
+    }
+
+    explicit Impl(const Impl& backing, size_t virtual_size_)
+        : backing_size{backing.backing_size}, virtual_size{virtual_size_},
+          process{GetCurrentProcess()}, kernelbase_dll("Kernelbase") {
+        LoadFunctions();
+
+        // Views are mapped from our own handle, the backing view belongs to the other buffer
+        if (!DuplicateHandle(process, backing.backing_handle, process, &backing_handle, 0, FALSE,
+                             DUPLICATE_SAME_ACCESS)) {
+            LOG_CRITICAL(HW_Memory, "Failed to duplicate the backing memory file handle");
             throw std::bad_alloc{};
         }
+        backing_base = backing.backing_base;
+        owns_backing = false;
+        ReserveVirtualMemory();
     }
 
     ~Impl() {
@@ -206,6 +206,30 @@ public:
     u8* virtual_base{};
 
 private:
+    void LoadFunctions() {
+        if (!kernelbase_dll.IsOpen()) {
+            LOG_CRITICAL(HW_Memory, "Failed to load Kernelbase.dll");
+            throw std::bad_alloc{};
+        }
+        GetFuncAddress(kernelbase_dll, "CreateFileMapping2", pfn_CreateFileMapping2);
+        GetFuncAddress(kernelbase_dll, "VirtualAlloc2", pfn_VirtualAlloc2);
+        GetFuncAddress(kernelbase_dll, "MapViewOfFile3", pfn_MapViewOfFile3);
+        GetFuncAddress(kernelbase_dll, "UnmapViewOfFile2", pfn_UnmapViewOfFile2);
+    }
+
+    /// Allocate virtual address placeholder
+    void ReserveVirtualMemory() {
+        virtual_base = static_cast<u8*>(pfn_VirtualAlloc2(process, nullptr, virtual_size,
+                                                          MEM_RESERVE | MEM_RESERVE_PLACEHOLDER,
+                                                          PAGE_NOACCESS, nullptr, 0));
+        if (!virtual_base) {
+            Release();
+            LOG_CRITICAL(HW_Memory, "Failed to reserve {} GiB of virtual memory",
+                         virtual_size >> 30);
+            throw std::bad_alloc{};
+        }
+    }
+
     /// Release all resources in the object
     void Release() {
         if (!placeholders.empty()) {
@@ -222,7 +246,7 @@ private:
                 LOG_CRITICAL(HW_Memory, "Failed to free virtual memory");
             }
         }
-        if (backing_base) {
+        if (backing_base && owns_backing) {
             if (!pfn_UnmapViewOfFile2(process, backing_base, MEM_PRESERVE_PLACEHOLDER)) {
                 LOG_CRITICAL(HW_Memory, "Failed to unmap backing memory placeholder");
             }
@@ -352,6 +376,7 @@ private:
 
     HANDLE process{};        ///< Current process handle
     HANDLE backing_handle{}; ///< File based backing memory
+    bool owns_backing{true}; ///< False when the backing view belongs to another buffer
 
     DynamicLibrary kernelbase_dll;
     PFN_CreateFileMapping2 pfn_CreateFileMapping2{};
@@ -483,6 +508,36 @@ public:
         good = true;
     }
 
+    explicit Impl(const Impl& backing, size_t virtual_size_)
+        : backing_size{backing.backing_size}, virtual_size{virtual_size_}, owns_backing{false} {
+        bool good = false;
+        SCOPE_EXIT {
+            if (!good) {
+                Release();
+            }
+        };
+
+        // Views are mapped from our own descriptor, the backing map belongs to the other buffer
+        fd = dup(backing.fd);
+        if (fd < 0) {
+            LOG_CRITICAL(HW_Memory, "dup failed: {}", strerror(errno));
+            throw std::bad_alloc{};
+        }
+        backing_base = backing.backing_base;
+
+        virtual_base = virtual_map_base = static_cast<u8*>(ChooseVirtualBase(virtual_size));
+        if (virtual_base == MAP_FAILED) {
+            LOG_CRITICAL(HW_Memory, "mmap failed: {}", strerror(errno));
+            throw std::bad_alloc{};
+        }
+#if defined(__linux__)
+        madvise(virtual_base, virtual_size, MADV_HUGEPAGE);
+#endif
+
+        free_manager.SetAddressSpace(virtual_base, virtual_size);
+        good = true;
+    }
+
     ~Impl() {
         Release();
     }
@@ -581,7 +636,7 @@ private:
             ASSERT_MSG(ret == 0, "munmap failed: {}", strerror(errno));
         }
 
-        if (backing_base != MAP_FAILED) {
+        if (backing_base != MAP_FAILED && owns_backing) {
             int ret = munmap(backing_base, backing_size);
             ASSERT_MSG(ret == 0, "munmap failed: {}", strerror(errno));
         }
@@ -614,6 +669,7 @@ private:
     }
 
     int fd{-1}; // memfd file descriptor, -1 is the error value of memfd_create
+    bool owns_backing{true}; // False when the backing map belongs to another buffer
     FreeRegionManager free_manager{};
 };
 
@@ -627,6 +683,10 @@ public:
         throw std::bad_alloc{};
     }
 
+    explicit Impl(const Impl& /* backing */, size_t /* virtual_size */) {
+        throw std::bad_alloc{};
+    }
+
     void Map(size_t virtual_offset, size_t host_offset, size_t length, MemoryPermission perm) {}
 
     void Unmap(size_t virtual_offset, size_t length) {}
@@ -672,6 +732,26 @@ HostMemory::HostMemory(size_t backing_size_, size_t virtual_size_)
     }
 }
 
+HostMemory::HostMemory(HostMemory& backing, size_t virtual_size_)
+    : backing_size(backing.backing_size), virtual_size(virtual_size_) {
+    backing_base = backing.backing_base;
+    if (!backing.impl) {
+        // The backing memory is a fallback buffer, it can only be accessed through its base
+        return;
+    }
+    try {
+        impl = std::make_unique<HostMemory::Impl>(
+            *backing.impl, AlignUp(virtual_size, PageAlignment) + HugePageSize);
+        virtual_base = reinterpret_cast<u8*>(
+            Common::AlignUp(reinterpret_cast<uintptr_t>(impl->virtual_base), HugePageSize));
+        virtual_base_offset = virtual_base - impl->virtual_base;
+    } catch (const std::bad_alloc&) {
+        LOG_ERROR(HW_Memory, "Failed to reserve {} GiB for another view of the backing memory",
+                  virtual_size >> 30);
+        virtual_base = nullptr;
+    }
+}
+
 HostMemory::~HostMemory() = default;
 
 HostMemory::HostMemory(HostMemory&&) noexcept = default;
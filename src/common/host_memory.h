@@ -25,6 +25,14 @@ DECLARE_ENUM_FLAG_OPERATORS(MemoryPermission)
 class HostMemory {
 public:
     explicit HostMemory(size_t backing_size_, size_t virtual_size_);
+
+    /**
+     * Creates another virtual range over the backing memory of an existing buffer, so the same
+     * memory can be mapped with a different layout. The backing memory stays owned by the other
+     * buffer, which has to outlive this one.
+     */
+    explicit HostMemory(HostMemory& backing, size_t virtual_size_);
+
     ~HostMemory();
 
     /**
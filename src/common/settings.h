@@ -276,6 +276,8 @@ struct Values {
 
     SwitchableSetting<bool> use_disk_shader_cache{linkage, true, "use_disk_shader_cache",
                                                   Category::Renderer};
+    SwitchableSetting<bool> use_disk_texture_cache{linkage, false, "use_disk_texture_cache",
+                                                   Category::Renderer};
     SwitchableSetting<bool> use_asynchronous_gpu_emulation{
         linkage, true, "use_asynchronous_gpu_emulation", Category::Renderer};
     SwitchableSetting<AstcDecodeMode, true> accelerate_astc{linkage,
@@ -390,6 +392,13 @@ struct Values {
                                                            VramUsageMode::Aggressive,
                                                            "vram_usage_mode",
                                                            Category::RendererAdvanced};
+    SwitchableSetting<u32, true> vram_budget{linkage,
+                                             0,
+                                             0,
+                                             std::numeric_limits<u16>::max(),
+                                             "vram_budget",
+                                             Category::RendererAdvanced,
+                                             Specialization::Countable};
     SwitchableSetting<bool> async_presentation{linkage,
 #ifdef ANDROID
                                                true,
@@ -425,6 +434,8 @@ struct Values {
                                                 Category::RendererAdvanced};
     SwitchableSetting<bool> barrier_feedback_loops{linkage, true, "barrier_feedback_loops",
                                                    Category::RendererAdvanced};
+    SwitchableSetting<bool> use_gpu_fastmem{linkage, false, "use_gpu_fastmem",
+                                            Category::RendererAdvanced};
 
     Setting<bool> renderer_debug{linkage, false, "debug", Category::RendererDebug};
     Setting<bool> renderer_shader_feedback{linkage, false, "shader_feedback",
@@ -591,6 +602,12 @@ struct Values {
                                     Category::DebuggingGraphics};
     Setting<bool> disable_macro_hle{linkage, false, "disable_macro_hle",
                                     Category::DebuggingGraphics};
+    Setting<bool> disable_macro_optimizer{linkage, false, "disable_macro_optimizer",
+                                          Category::DebuggingGraphics};
+    Setting<bool> disable_register_batching{linkage, false, "disable_register_batching",
+                                            Category::DebuggingGraphics};
+    Setting<bool> record_gpu_trace{linkage, false, "record_gpu_trace",
+                                   Category::DebuggingGraphics};
     Setting<bool> extended_logging{
         linkage, false, "extended_logging", Category::Debugging, Specialization::Default, false};
     Setting<bool> use_debug_asserts{linkage, false, "use_debug_asserts", Category::Debugging};
@@ -35,6 +35,7 @@ enum class HaltReason : u64 {
     BreakLoop = 0x02000000,
     SupervisorCall = 0x04000000,
     InstructionBreakpoint = 0x08000000,
+    ProfileSample = 0x10000000,
     PrefetchAbort = 0x20000000,
 };
 DECLARE_ENUM_FLAG_OPERATORS(HaltReason);
@@ -94,6 +95,10 @@ public:
     // It is safe to call this if the CPU is not running.
     virtual void SignalInterrupt(Kernel::KThread* thread) = 0;
 
+    // Signal execution to halt so the guest profiler can take a sample.
+    // It is safe to call this if the CPU is not running.
+    virtual void SignalProfileSample() {}
+
     // Stack trace generation.
     void LogBacktrace(Kernel::KProcess* process) const;
 
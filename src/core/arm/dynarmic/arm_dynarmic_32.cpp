@@ -436,6 +436,10 @@ void ArmDynarmic32::SignalInterrupt(Kernel::KThread* thread) {
     m_jit->HaltExecution(BreakLoop);
 }
 
+void ArmDynarmic32::SignalProfileSample() {
+    m_jit->HaltExecution(ProfileSample);
+}
+
 void ArmDynarmic32::ClearInstructionCache() {
     m_jit->ClearCache();
 }
@@ -466,6 +466,10 @@ void ArmDynarmic64::SignalInterrupt(Kernel::KThread* thread) {
     m_jit->HaltExecution(BreakLoop);
 }
 
+void ArmDynarmic64::SignalProfileSample() {
+    m_jit->HaltExecution(ProfileSample);
+}
+
 void ArmDynarmic64::ClearInstructionCache() {
     m_jit->ClearCache();
 }
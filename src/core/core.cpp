@@ -1,10 +1,12 @@
 // SPDX-FileCopyrightText: 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "audio_core/audio_core.h"
 #include "common/fs/fs.h"
@@ -57,6 +59,7 @@
 #include "core/reporter.h"
 #include "core/telemetry_session.h"
 #include "core/tools/freezer.h"
+#include "core/tools/guest_profiler.h"
 #include "core/tools/renderdoc.h"
 #include "hid_core/hid_core.h"
 #include "network/network.h"
@@ -298,12 +301,23 @@ struct System::Impl {
         if (Settings::values.enable_renderdoc_hotkey) {
             renderdoc_api = std::make_unique<Tools::RenderdocAPI>();
         }
+        guest_profiler = std::make_unique<Tools::GuestProfiler>(system);
 
         LOG_DEBUG(Core, "Initialized OK");
 
         return SystemResultStatus::Success;
     }
 
+    SystemResultStatus InitializeGPU(System& system, Frontend::EmuWindow& emu_window) {
+        host1x_core = std::make_unique<Tegra::Host1x::Host1x>(system);
+        gpu_core = VideoCore::CreateGPU(emu_window, system);
+        if (!gpu_core) {
+            return SystemResultStatus::ErrorVideoCore;
+        }
+        is_powered_on = true;
+        return SystemResultStatus::Success;
+    }
+
     SystemResultStatus Load(System& system, Frontend::EmuWindow& emu_window,
                             const std::string& filepath,
                             Service::AM::FrontendAppletParameters& params) {
@@ -401,6 +415,11 @@ struct System::Impl {
     void ShutdownMainProcess() {
         SetShuttingDown(true);
 
+        // Write the guest profile while the modules can still be symbolized
+        if (guest_profiler) {
+            guest_profiler->Stop();
+        }
+
         // Log last frame performance stats if game was loaded
         if (perf_stats) {
             const auto perf_results = GetAndResetPerfStats();
@@ -414,6 +433,10 @@ struct System::Impl {
                                         perf_results.frametime * 1000.0);
             telemetry_session->AddField(performance, "Mean_Frametime_MS",
                                         perf_stats->GetMeanFrametime());
+            telemetry_session->AddField(performance, "Shutdown_ReadbackStall",
+                                        perf_results.readback_stall * 100.0);
+            telemetry_session->AddField(performance, "Shutdown_GPUInvalidations",
+                                        perf_results.gpu_invalidations);
         }
 
         is_powered_on = false;
@@ -516,6 +539,7 @@ struct System::Impl {
     std::array<u8, 0x20> build_id{};
 
     std::unique_ptr<Tools::RenderdocAPI> renderdoc_api;
+    std::unique_ptr<Tools::GuestProfiler> guest_profiler;
 
     /// Applets
     Service::AM::AppletManager applet_manager;
@@ -637,6 +661,10 @@ SystemResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::stri
     return impl->Load(*this, emu_window, filepath, params);
 }
 
+SystemResultStatus System::InitializeGPU(Frontend::EmuWindow& emu_window) {
+    return impl->InitializeGPU(*this, emu_window);
+}
+
 bool System::IsPoweredOn() const {
     return impl->is_powered_on.load(std::memory_order::relaxed);
 }
@@ -654,8 +682,37 @@ std::span<GPUDirtyMemoryManager> System::GetGPUDirtyMemoryManager() {
 }
 
 void System::GatherGPUDirtyMemory(std::function<void(PAddr, size_t)>& callback) {
+    // Writes from different cores to neighbouring memory are invalidated together
+    std::vector<std::pair<PAddr, size_t>> ranges;
+    std::function<void(PAddr, size_t)> collect = [&ranges](PAddr address, size_t size) {
+        ranges.emplace_back(address, size);
+    };
     for (auto& manager : impl->gpu_dirty_memory_managers) {
-        manager.Gather(callback);
+        manager.Gather(collect);
+    }
+    if (ranges.empty()) {
+        return;
+    }
+    std::ranges::sort(ranges);
+
+    u64 num_invalidations = 0;
+    auto [run_address, run_size] = ranges.front();
+    for (auto it = std::next(ranges.begin()); it != ranges.end(); ++it) {
+        const auto [address, size] = *it;
+        if (address <= run_address + run_size) {
+            run_size = std::max(run_size, static_cast<size_t>(address + size - run_address));
+            continue;
+        }
+        callback(run_address, run_size);
+        ++num_invalidations;
+        run_address = address;
+        run_size = size;
+    }
+    callback(run_address, run_size);
+    ++num_invalidations;
+
+    if (impl->perf_stats) {
+        impl->perf_stats->AddGPUInvalidations(num_invalidations);
     }
 }
 
@@ -983,6 +1040,10 @@ Tools::RenderdocAPI& System::GetRenderdocAPI() {
     return *impl->renderdoc_api;
 }
 
+Tools::GuestProfiler& System::GetGuestProfiler() {
+    return *impl->guest_profiler;
+}
+
 void System::RunServer(std::unique_ptr<Service::ServerManager>&& server_manager) {
     return impl->kernel.RunServer(std::move(server_manager));
 }
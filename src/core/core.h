@@ -109,8 +109,9 @@ class RoomNetwork;
 }
 
 namespace Tools {
+class GuestProfiler;
 class RenderdocAPI;
-}
+} // namespace Tools
 
 namespace Core {
 
@@ -211,6 +212,13 @@ public:
                                           const std::string& filepath,
                                           Service::AM::FrontendAppletParameters& params);
 
+    /**
+     * Initialize the GPU without loading an application, for tools driving the GPU directly.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns SystemResultStatus code, indicating if the operation succeeded.
+     */
+    [[nodiscard]] SystemResultStatus InitializeGPU(Frontend::EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -395,6 +403,9 @@ public:
 
     [[nodiscard]] Tools::RenderdocAPI& GetRenderdocAPI();
 
+    /// Gets the sampling profiler of the application guest code.
+    [[nodiscard]] Tools::GuestProfiler& GetGuestProfiler();
+
     void SetExitLocked(bool locked);
     bool GetExitLocked() const;
 
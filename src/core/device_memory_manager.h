@@ -53,6 +53,10 @@ public:
 
     void Unmap(DAddr address, size_t size);
 
+    /// Backs a device range with contiguous physical memory that belongs to no process, for tools
+    /// that replay GPU work without running an application
+    void MapPhysical(DAddr address, PAddr physical_address, size_t size);
+
     void TrackContinuityImpl(DAddr address, VAddr virtual_address, size_t size, Asid asid);
     void TrackContinuity(DAddr address, VAddr virtual_address, size_t size, Asid asid) {
         std::scoped_lock lk(mapping_guard);
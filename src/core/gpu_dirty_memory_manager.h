@@ -24,27 +24,14 @@ public:
     ~GPUDirtyMemoryManager() = default;
 
     void Collect(PAddr address, size_t size) {
-        TransformAddress t = BuildTransform(address, size);
-        TransformAddress tmp, original;
-        do {
-            tmp = current.load(std::memory_order_acquire);
-            original = tmp;
-            if (tmp.address != t.address) {
-                if (IsValid(tmp.address)) {
-                    std::scoped_lock lk(guard);
-                    back_buffer.emplace_back(tmp);
-                    current.exchange(t, std::memory_order_relaxed);
-                    return;
-                }
-                tmp.address = t.address;
-                tmp.mask = 0;
-            }
-            if ((tmp.mask | t.mask) == tmp.mask) {
-                return;
-            }
-            tmp.mask |= t.mask;
-        } while (!current.compare_exchange_weak(original, tmp, std::memory_order_release,
-                                                std::memory_order_relaxed));
+        // Each transform tracks a single page, ranges crossing pages are collected per page
+        while ((address & page_mask) + size > page_size) [[unlikely]] {
+            const size_t chunk_size = page_size - (address & page_mask);
+            CollectPage(address, chunk_size);
+            address += chunk_size;
+            size -= chunk_size;
+        }
+        CollectPage(address, size);
     }
 
     void Gather(std::function<void(PAddr, size_t)>& callback) {
@@ -56,6 +43,20 @@ public:
                 front_buffer.emplace_back(t);
             }
         }
+        // Ranges that continue the previous one, like a write crossing a page, are merged
+        PAddr run_address{};
+        size_t run_size{};
+        const auto add_range = [&](PAddr address, size_t size) {
+            if (run_size != 0 && run_address + run_size == address) {
+                run_size += size;
+                return;
+            }
+            if (run_size != 0) {
+                callback(run_address, run_size);
+            }
+            run_address = address;
+            run_size = size;
+        };
         for (auto& transform : front_buffer) {
             size_t offset = 0;
             u64 mask = transform.mask;
@@ -65,12 +66,15 @@ public:
                 mask = mask >> empty_bits;
 
                 const size_t continuous_bits = std::countr_one(mask);
-                callback((static_cast<PAddr>(transform.address) << page_bits) + offset,
-                         continuous_bits << align_bits);
+                add_range((static_cast<PAddr>(transform.address) << page_bits) + offset,
+                          continuous_bits << align_bits);
                 mask = continuous_bits < align_size ? (mask >> continuous_bits) : 0;
                 offset += continuous_bits << align_bits;
             }
         }
+        if (run_size != 0) {
+            callback(run_address, run_size);
+        }
         front_buffer.clear();
     }
 
@@ -89,6 +93,30 @@ private:
     constexpr static size_t align_mask = align_size - 1;
     constexpr static TransformAddress default_transform = {.address = ~0U, .mask = 0U};
 
+    void CollectPage(PAddr address, size_t size) {
+        TransformAddress t = BuildTransform(address, size);
+        TransformAddress tmp, original;
+        do {
+            tmp = current.load(std::memory_order_acquire);
+            original = tmp;
+            if (tmp.address != t.address) {
+                if (IsValid(tmp.address)) {
+                    std::scoped_lock lk(guard);
+                    back_buffer.emplace_back(tmp);
+                    current.exchange(t, std::memory_order_relaxed);
+                    return;
+                }
+                tmp.address = t.address;
+                tmp.mask = 0;
+            }
+            if ((tmp.mask | t.mask) == tmp.mask) {
+                return;
+            }
+            tmp.mask |= t.mask;
+        } while (!current.compare_exchange_weak(original, tmp, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    }
+
     bool IsValid(PAddr address) {
         return address < (1ULL << 39);
     }
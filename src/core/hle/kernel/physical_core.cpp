@@ -10,6 +10,7 @@
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/physical_core.h"
 #include "core/hle/kernel/svc.h"
+#include "core/tools/guest_profiler.h"
 
 namespace Kernel {
 
@@ -97,6 +98,14 @@ void PhysicalCore::RunThread(Kernel::KThread* thread) {
             ExitContext();
         }
 
+        // Record a profiler sample, and keep running if nothing else stopped us.
+        if (True(hr & Core::HaltReason::ProfileSample)) {
+            system.GetGuestProfiler().AddSample(*interface, process);
+            if (hr == Core::HaltReason::ProfileSample) {
+                continue;
+            }
+        }
+
         // Determine why we stopped.
         const bool supervisor_call = True(hr & Core::HaltReason::SupervisorCall);
         const bool prefetch_abort = True(hr & Core::HaltReason::PrefetchAbort);
@@ -235,6 +244,16 @@ void PhysicalCore::Interrupt() {
     arm_interface->SignalInterrupt(thread);
 }
 
+void PhysicalCore::RequestProfileSample() {
+    // Lock core context.
+    std::scoped_lock lk{m_guard};
+
+    // Halt the CPU if it is running.
+    if (m_arm_interface != nullptr) {
+        m_arm_interface->SignalProfileSample();
+    }
+}
+
 void PhysicalCore::ClearInterrupt() {
     std::scoped_lock lk{m_guard};
     m_is_interrupted = false;
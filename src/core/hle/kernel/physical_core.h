@@ -52,6 +52,9 @@ public:
     // Interrupt this core.
     void Interrupt();
 
+    // Halt this core so the guest profiler can sample it.
+    void RequestProfileSample();
+
     // Clear this core's interrupt.
     void ClearInterrupt();
 
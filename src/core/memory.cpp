@@ -256,6 +256,34 @@ struct Memory::Impl {
             return false;
         }
 
+        // Consecutive pages of the same type that are contiguous in host memory are passed to the
+        // callbacks as a single run, so large blocks are copied and flushed once per run.
+        Common::PageType run_type{};
+        u64 run_vaddr{};
+        u8* run_ptr{};
+        std::size_t run_size{};
+        const auto flush_run = [&] {
+            if (run_size == 0) {
+                return;
+            }
+            switch (run_type) {
+            case Common::PageType::Unmapped:
+                on_unmapped(run_size, run_vaddr);
+                break;
+            case Common::PageType::Memory:
+            case Common::PageType::DebugMemory:
+                on_memory(run_size, run_ptr);
+                break;
+            case Common::PageType::RasterizerCachedMemory:
+                on_rasterizer(run_vaddr, run_size, run_ptr);
+                break;
+            default:
+                UNREACHABLE();
+            }
+            increment(run_size);
+            run_size = 0;
+        };
+
         while (remaining_size) {
             const std::size_t copy_amount =
                 std::min(static_cast<std::size_t>(YUZU_PAGESIZE) - page_offset, remaining_size);
@@ -263,37 +291,43 @@ struct Memory::Impl {
                 static_cast<u64>((page_index << YUZU_PAGEBITS) + page_offset);
 
             const auto [pointer, type] = page_table.pointers[page_index].PointerType();
+            u8* mem_ptr{};
             switch (type) {
-            case Common::PageType::Unmapped: {
+            case Common::PageType::Unmapped:
                 user_accessible = false;
-                on_unmapped(copy_amount, current_vaddr);
                 break;
-            }
-            case Common::PageType::Memory: {
-                u8* mem_ptr =
+            case Common::PageType::Memory:
+                mem_ptr =
                     reinterpret_cast<u8*>(pointer + page_offset + (page_index << YUZU_PAGEBITS));
-                on_memory(copy_amount, mem_ptr);
                 break;
-            }
-            case Common::PageType::DebugMemory: {
-                u8* const mem_ptr{GetPointerFromDebugMemory(current_vaddr)};
-                on_memory(copy_amount, mem_ptr);
+            case Common::PageType::DebugMemory:
+                mem_ptr = GetPointerFromDebugMemory(current_vaddr);
                 break;
-            }
-            case Common::PageType::RasterizerCachedMemory: {
-                u8* const host_ptr{GetPointerFromRasterizerCachedMemory(current_vaddr)};
-                on_rasterizer(current_vaddr, copy_amount, host_ptr);
+            case Common::PageType::RasterizerCachedMemory:
+                mem_ptr = GetPointerFromRasterizerCachedMemory(current_vaddr);
                 break;
-            }
             default:
                 UNREACHABLE();
             }
 
+            const bool extends_run =
+                run_size != 0 && type == run_type &&
+                (type == Common::PageType::Unmapped ||
+                 reinterpret_cast<uintptr_t>(run_ptr) + run_size ==
+                     reinterpret_cast<uintptr_t>(mem_ptr));
+            if (!extends_run) {
+                flush_run();
+                run_type = type;
+                run_vaddr = current_vaddr;
+                run_ptr = mem_ptr;
+            }
+            run_size += copy_amount;
+
             page_index++;
             page_offset = 0;
-            increment(copy_amount);
             remaining_size -= copy_amount;
         }
+        flush_run();
 
         return user_accessible;
     }
@@ -335,17 +369,38 @@ struct Memory::Impl {
         return ReadBlockImpl<true>(src_addr, dest_buffer, size);
     }
 
+    /// Returns true if [src_addr, src_addr + size) is backed by contiguous host memory
+    bool IsHostContiguous(const VAddr src_addr, const std::size_t size) const {
+        const auto& page_table = *current_page_table;
+        if (!AddressSpaceContains(page_table, src_addr, size)) [[unlikely]] {
+            return false;
+        }
+        const std::size_t first_page = src_addr >> YUZU_PAGEBITS;
+        const std::size_t last_page = (src_addr + std::max<std::size_t>(size, 1) - 1) >>
+                                      YUZU_PAGEBITS;
+        if (page_table.blocks[first_page] == page_table.blocks[last_page]) {
+            return true;
+        }
+        // Separate mappings of adjacent physical memory can still be accessed in place
+        const u64 backing = page_table.backing_addr[first_page];
+        for (std::size_t page = first_page; page <= last_page; ++page) {
+            if (page_table.pointers[page].Type() == Common::PageType::Unmapped ||
+                page_table.backing_addr[page] != backing) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     const u8* GetSpan(const VAddr src_addr, const std::size_t size) const {
-        if (current_page_table->blocks[src_addr >> YUZU_PAGEBITS] ==
-            current_page_table->blocks[(src_addr + size) >> YUZU_PAGEBITS]) {
+        if (IsHostContiguous(src_addr, size)) {
             return GetPointerSilent(src_addr);
         }
         return nullptr;
     }
 
     u8* GetSpan(const VAddr src_addr, const std::size_t size) {
-        if (current_page_table->blocks[src_addr >> YUZU_PAGEBITS] ==
-            current_page_table->blocks[(src_addr + size) >> YUZU_PAGEBITS]) {
+        if (IsHostContiguous(src_addr, size)) {
             return GetPointerSilent(src_addr);
         }
         return nullptr;
@@ -799,33 +854,72 @@ struct Memory::Impl {
         return true;
     }
 
-    void HandleRasterizerDownload(VAddr v_address, size_t size) {
-        const auto* p = GetPointerImpl(
-            v_address, []() {}, []() {});
+    /**
+     * Calls operation for each range of device memory backing [v_address, v_address + size).
+     * Pages that are contiguous in device memory are merged, so the GPU is notified once per run
+     * instead of once per page.
+     */
+    template <typename Func>
+    void ApplyOpOnDeviceRanges(VAddr v_address, size_t size, Common::ScratchBuffer<u32>& scratch,
+                               Func&& operation) {
         if (!gpu_device_memory) [[unlikely]] {
             gpu_device_memory = &system.Host1x().MemoryManager();
         }
+        DAddr run_address{};
+        size_t run_size{};
+        const VAddr end_address = v_address + size;
+        while (v_address < end_address) {
+            const VAddr page_end = (v_address & ~YUZU_PAGEMASK) + YUZU_PAGESIZE;
+            const size_t chunk_size = std::min(page_end, end_address) - v_address;
+            const auto* p = GetPointerSilent(v_address);
+
+            size_t num_addresses{};
+            DAddr page_address{};
+            gpu_device_memory->ApplyOpOnPointer(p, scratch, [&](DAddr address) {
+                ++num_addresses;
+                page_address = address;
+            });
+            if (num_addresses == 1 && run_size != 0 && page_address == run_address + run_size) {
+                run_size += chunk_size;
+            } else {
+                if (run_size != 0) {
+                    operation(run_address, run_size);
+                    run_size = 0;
+                }
+                if (num_addresses == 1) {
+                    run_address = page_address;
+                    run_size = chunk_size;
+                } else {
+                    // Memory mapped more than once on the device is notified on every mapping
+                    gpu_device_memory->ApplyOpOnPointer(
+                        p, scratch, [&](DAddr address) { operation(address, chunk_size); });
+                }
+            }
+            v_address += chunk_size;
+        }
+        if (run_size != 0) {
+            operation(run_address, run_size);
+        }
+    }
+
+    void HandleRasterizerDownload(VAddr v_address, size_t size) {
         const size_t core = system.GetCurrentHostThreadID();
         auto& current_area = rasterizer_read_areas[core];
-        gpu_device_memory->ApplyOpOnPointer(p, scratch_buffers[core], [&](DAddr address) {
-            const DAddr end_address = address + size;
-            if (current_area.start_address <= address && end_address <= current_area.end_address)
-                [[likely]] {
-                return;
-            }
-            current_area = system.GPU().OnCPURead(address, size);
-        });
+        ApplyOpOnDeviceRanges(
+            v_address, size, scratch_buffers[core], [&](DAddr address, size_t range_size) {
+                const DAddr end_address = address + range_size;
+                if (current_area.start_address <= address &&
+                    end_address <= current_area.end_address) [[likely]] {
+                    return;
+                }
+                current_area = system.GPU().OnCPURead(address, range_size);
+            });
     }
 
     void HandleRasterizerWrite(VAddr v_address, size_t size) {
-        const auto* p = GetPointerImpl(
-            v_address, []() {}, []() {});
         constexpr size_t sys_core = Core::Hardware::NUM_CPU_CORES - 1;
         const size_t core = std::min(system.GetCurrentHostThreadID(),
                                      sys_core); // any other calls threads go to syscore.
-        if (!gpu_device_memory) [[unlikely]] {
-            gpu_device_memory = &system.Host1x().MemoryManager();
-        }
         // Guard on sys_core;
         if (core == sys_core) [[unlikely]] {
             sys_core_guard.lock();
@@ -835,19 +929,25 @@ struct Memory::Impl {
                 sys_core_guard.unlock();
             }
         };
-        gpu_device_memory->ApplyOpOnPointer(p, scratch_buffers[core], [&](DAddr address) {
-            auto& current_area = rasterizer_write_areas[core];
-            PAddr subaddress = address >> YUZU_PAGEBITS;
-            bool do_collection = current_area.last_address == subaddress;
-            if (!do_collection) [[unlikely]] {
-                do_collection = system.GPU().OnCPUWrite(address, size);
-                if (!do_collection) {
-                    return;
+        ApplyOpOnDeviceRanges(
+            v_address, size, scratch_buffers[core], [&](DAddr address, size_t range_size) {
+                auto& current_area = rasterizer_write_areas[core];
+                const PAddr subaddress = address >> YUZU_PAGEBITS;
+                // Only single page writes can be answered from the last written page
+                const bool is_single_page =
+                    subaddress == (address + range_size - 1) >> YUZU_PAGEBITS;
+                bool do_collection = is_single_page && current_area.last_address == subaddress;
+                if (!do_collection) [[unlikely]] {
+                    do_collection = system.GPU().OnCPUWrite(address, range_size);
+                    if (!do_collection) {
+                        return;
+                    }
+                    if (is_single_page) {
+                        current_area.last_address = subaddress;
+                    }
                 }
-                current_area.last_address = subaddress;
-            }
-            gpu_dirty_managers[core].Collect(address, size);
-        });
+                gpu_dirty_managers[core].Collect(address, range_size);
+            });
     }
 
     struct GPUDirtyState {
@@ -366,6 +366,13 @@ public:
      */
     bool ReadBlockUnsafe(Common::ProcessAddress src_addr, void* dest_buffer, std::size_t size);
 
+    /**
+     * Gets a pointer to a range of the current process' address space that can be accessed in
+     * place, avoiding a copy.
+     *
+     * @returns The host pointer backing src_addr, or nullptr if the range is not backed by
+     *          contiguous host memory.
+     */
     const u8* GetSpan(const VAddr src_addr, const std::size_t size) const;
     u8* GetSpan(const VAddr src_addr, const std::size_t size);
 
@@ -77,6 +77,15 @@ void PerfStats::EndGameFrame() {
     game_frames.fetch_add(1, std::memory_order_relaxed);
 }
 
+void PerfStats::AddReadbackStall(Clock::duration stall_time) {
+    const auto stall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stall_time);
+    readback_stall_ns.fetch_add(static_cast<u64>(stall_ns.count()), std::memory_order_relaxed);
+}
+
+void PerfStats::AddGPUInvalidations(u64 count) {
+    gpu_invalidations.fetch_add(count, std::memory_order_relaxed);
+}
+
 double PerfStats::GetMeanFrametime() const {
     std::scoped_lock lock{object_mutex};
 
@@ -99,12 +108,18 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
     const auto system_us_per_second = (current_system_time_us - reset_point_system_us) / interval;
     const auto current_frames = static_cast<double>(game_frames.load(std::memory_order_relaxed));
     const auto current_fps = current_frames / interval;
+    const auto num_invalidations =
+        static_cast<double>(gpu_invalidations.exchange(0, std::memory_order_relaxed));
     const PerfStatsResults results{
         .system_fps = static_cast<double>(system_frames) / interval,
         .average_game_fps = (current_fps + previous_fps) / 2.0,
         .frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                      static_cast<double>(system_frames),
         .emulation_speed = system_us_per_second.count() / 1'000'000.0,
+        .readback_stall =
+            static_cast<double>(readback_stall_ns.exchange(0, std::memory_order_relaxed)) /
+            1'000'000'000.0 / interval,
+        .gpu_invalidations = current_frames > 0.0 ? num_invalidations / current_frames : 0.0,
     };
 
     // Reset counters
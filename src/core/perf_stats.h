@@ -21,6 +21,10 @@ struct PerfStatsResults {
     double frametime;
     /// Ratio of walltime / emulated time elapsed
     double emulation_speed;
+    /// Fraction of walltime spent by guest threads waiting for GPU memory to be downloaded
+    double readback_stall;
+    /// Average number of GPU cache invalidations caused by CPU writes per game frame
+    double gpu_invalidations;
 };
 
 /**
@@ -38,6 +42,12 @@ public:
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Accounts time a guest thread was blocked waiting for GPU written memory to be downloaded
+    void AddReadbackStall(Clock::duration stall_time);
+
+    /// Accounts GPU cache invalidations issued for memory written by the CPU
+    void AddGPUInvalidations(u64 count);
+
     PerfStatsResults GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -73,6 +83,10 @@ private:
     u32 system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     std::atomic<u32> game_frames = 0;
+    /// Cumulative time guest threads were blocked on GPU memory downloads, in nanoseconds
+    std::atomic<u64> readback_stall_ns = 0;
+    /// Cumulative number of GPU cache invalidations caused by CPU writes
+    std::atomic<u64> gpu_invalidations = 0;
 
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
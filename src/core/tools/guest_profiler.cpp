@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+
+#include "common/demangle.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/arm/arm_interface.h"
+#include "core/arm/debug.h"
+#include "core/arm/symbols.h"
+#include "core/core.h"
+#include "core/hardware_properties.h"
+#include "core/hle/kernel/k_process.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/physical_core.h"
+#include "core/memory.h"
+#include "core/tools/guest_profiler.h"
+
+namespace Tools {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr auto SAMPLE_INTERVAL = 1ms;
+constexpr size_t MAX_STACK_DEPTH = 64;
+
+} // Anonymous namespace
+
+GuestProfiler::GuestProfiler(Core::System& system_) : system{system_} {}
+
+GuestProfiler::~GuestProfiler() {
+    Stop();
+}
+
+void GuestProfiler::ToggleProfiling() {
+    if (IsProfiling()) {
+        Stop();
+        return;
+    }
+    {
+        std::scoped_lock lk{sample_mutex};
+        samples.clear();
+        is_profiling = true;
+    }
+    sample_thread = std::jthread([this](std::stop_token stop_token) { SampleThread(stop_token); });
+    LOG_INFO(Core, "Started guest profiling");
+}
+
+void GuestProfiler::Stop() {
+    std::map<std::vector<u64>, u64> profile;
+    {
+        std::scoped_lock lk{sample_mutex};
+        if (!is_profiling) {
+            return;
+        }
+        is_profiling = false;
+        profile = std::move(samples);
+        samples.clear();
+    }
+    sample_thread.request_stop();
+    sample_thread = {};
+    WriteProfile(profile);
+}
+
+void GuestProfiler::AddSample(const Core::ArmInterface& arm_interface,
+                              Kernel::KProcess* process) {
+    if (process != system.ApplicationProcess()) {
+        return;
+    }
+    Kernel::Svc::ThreadContext ctx;
+    arm_interface.GetContext(ctx);
+
+    std::vector<u64> stack{ctx.pc};
+    if (process->Is64Bit()) {
+        // Walk the frame records, each one holds the previous frame pointer and the return address
+        auto& memory = process->GetMemory();
+        u64 lr = ctx.lr;
+        u64 fp = ctx.fp;
+        while (stack.size() < MAX_STACK_DEPTH) {
+            stack.push_back(lr);
+            if (fp == 0 || fp % 4 != 0 || !memory.IsValidVirtualAddressRange(fp, 16)) {
+                break;
+            }
+            lr = memory.Read64(fp + 8);
+            fp = memory.Read64(fp);
+        }
+    }
+    std::scoped_lock lk{sample_mutex};
+    if (is_profiling) {
+        ++samples[std::move(stack)];
+    }
+}
+
+void GuestProfiler::SampleThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("GuestProfiler");
+
+    auto& kernel = system.Kernel();
+    while (!stop_token.stop_requested()) {
+        std::this_thread::sleep_for(SAMPLE_INTERVAL);
+        for (size_t core = 0; core < Core::Hardware::NUM_CPU_CORES; ++core) {
+            kernel.PhysicalCore(core).RequestProfileSample();
+        }
+    }
+}
+
+void GuestProfiler::WriteProfile(const std::map<std::vector<u64>, u64>& profile) {
+    Kernel::KProcess* const process = system.ApplicationProcess();
+    if (profile.empty() || process == nullptr) {
+        LOG_INFO(Core, "Stopped guest profiling without samples");
+        return;
+    }
+    const auto modules = Core::FindModules(process);
+    std::map<VAddr, Core::Symbols::Symbols> symbols;
+    for (const auto& [base, name] : modules) {
+        symbols.emplace(base,
+                        Core::Symbols::GetSymbols(base, process->GetMemory(), process->Is64Bit()));
+    }
+    std::unordered_map<u64, std::string> frame_names;
+    const auto frame_name = [&](u64 address) -> const std::string& {
+        const auto [it, inserted] = frame_names.try_emplace(address);
+        if (!inserted) {
+            return it->second;
+        }
+        auto module = modules.upper_bound(address);
+        if (module == modules.begin()) {
+            it->second = fmt::format("unknown+{:x}", address);
+            return it->second;
+        }
+        --module;
+        const u64 offset = address - module->first;
+        const auto symbol = Core::Symbols::GetSymbolName(symbols[module->first], offset);
+        if (symbol) {
+            it->second = fmt::format("{}!{}", module->second, Common::DemangleSymbol(*symbol));
+        } else {
+            it->second = fmt::format("{}+{:x}", module->second, offset);
+        }
+        return it->second;
+    };
+
+    // Folded stacks list the outermost frame first, one line per distinct stack
+    std::string output;
+    u64 num_samples = 0;
+    for (const auto& [stack, count] : profile) {
+        for (auto frame = stack.rbegin(); frame != stack.rend(); ++frame) {
+            output += frame_name(*frame);
+            output += std::next(frame) != stack.rend() ? ';' : ' ';
+        }
+        output += fmt::format("{}\n", count);
+        num_samples += count;
+    }
+
+    const std::time_t t = std::time(nullptr);
+    const auto path = Common::FS::GetYuzuPath(Common::FS::YuzuPath::LogDir);
+    const auto filename = fmt::format("{:%F-%H-%M}_{:016X}.folded", *std::localtime(&t),
+                                      system.GetApplicationProcessProgramID());
+    const auto filepath = path / filename;
+    if (!Common::FS::CreateParentDir(filepath)) {
+        LOG_ERROR(Core, "Failed to create the guest profile directory");
+        return;
+    }
+    Common::FS::IOFile file(filepath, Common::FS::FileAccessMode::Write,
+                            Common::FS::FileType::TextFile);
+    void(file.WriteString(output));
+    LOG_INFO(Core, "Wrote guest profile with {} samples to {}", num_samples,
+             Common::FS::PathToUTF8String(filepath));
+}
+
+} // namespace Tools
@@ -0,0 +1,65 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core {
+class ArmInterface;
+class System;
+} // namespace Core
+
+namespace Kernel {
+class KProcess;
+}
+
+namespace Tools {
+
+/**
+ * Sampling profiler for guest code. While it runs, the emulated cores are periodically halted
+ * and the call stack of the running guest thread is recorded. When stopped, the samples are
+ * symbolized against the loaded modules and written to the log directory as folded stacks,
+ * the input format of flame graph tools.
+ */
+class GuestProfiler {
+public:
+    explicit GuestProfiler(Core::System& system);
+    ~GuestProfiler();
+
+    /// Starts profiling, or stops and writes the collected profile
+    void ToggleProfiling();
+
+    /// Stops profiling and writes the collected profile, does nothing when not profiling
+    void Stop();
+
+    [[nodiscard]] bool IsProfiling() const noexcept {
+        return is_profiling.load(std::memory_order_relaxed);
+    }
+
+    /// Records the call stack of a core halted for a sample
+    void AddSample(const Core::ArmInterface& arm_interface, Kernel::KProcess* process);
+
+private:
+    void SampleThread(std::stop_token stop_token);
+
+    void WriteProfile(const std::map<std::vector<u64>, u64>& profile);
+
+    Core::System& system;
+
+    std::atomic_bool is_profiling{};
+    std::jthread sample_thread;
+    std::mutex sample_mutex;
+
+    /// Number of times each call stack was sampled, with the innermost frame first
+    std::map<std::vector<u64>, u64> samples;
+};
+
+} // namespace Tools
@@ -0,0 +1,594 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/detached_tasks.h"
+#include "common/fs/path_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "core/frontend/graphics_context.h"
+#include "core/hle/kernel/board/nintendo/nx/k_system_control.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/draw_manager.h"
+#include "video_core/engines/engine_interface.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/puller.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_trace.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+using Tegra::CommandHeader;
+using Tegra::GpuTraceAddressSpace;
+using Tegra::GpuTraceChannel;
+using Tegra::GpuTraceCommands;
+using Tegra::GpuTraceEntry;
+using Tegra::GpuTraceMap;
+using Tegra::GpuTraceMemory;
+using Tegra::GpuTraceUnmap;
+using Tegra::SubmissionMode;
+using Tegra::Engines::Maxwell3D;
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t NUM_SUBCHANNELS = 8;
+constexpr u32 BIND_OBJECT_METHOD = static_cast<u32>(Tegra::BufferMethods::BindObject);
+constexpr u32 NON_PULLER_METHODS = static_cast<u32>(Tegra::BufferMethods::NonPullerMethods);
+
+class ReplayWindow final : public Core::Frontend::EmuWindow {
+public:
+    std::unique_ptr<Core::Frontend::GraphicsContext> CreateSharedContext() const override {
+        return std::make_unique<Core::Frontend::GraphicsContext>();
+    }
+
+    bool IsShown() const override {
+        return false;
+    }
+};
+
+enum class Engine : size_t {
+    Puller,
+    Maxwell3D,
+    KeplerCompute,
+    Fermi2D,
+    MaxwellDMA,
+    KeplerMemory,
+    Unbound,
+    Count,
+};
+
+constexpr std::array<std::string_view, static_cast<size_t>(Engine::Count)> ENGINE_NAMES{
+    "Puller", "Maxwell3D", "KeplerCompute", "Fermi2D", "MaxwellDMA", "KeplerMemory", "Unbound",
+};
+
+Engine EngineFromClass(u32 engine_class) {
+    switch (static_cast<Tegra::EngineID>(engine_class)) {
+    case Tegra::EngineID::MAXWELL_B:
+        return Engine::Maxwell3D;
+    case Tegra::EngineID::KEPLER_COMPUTE_B:
+        return Engine::KeplerCompute;
+    case Tegra::EngineID::FERMI_TWOD_A:
+        return Engine::Fermi2D;
+    case Tegra::EngineID::MAXWELL_DMA_COPY_A:
+        return Engine::MaxwellDMA;
+    case Tegra::EngineID::KEPLER_INLINE_TO_MEMORY_B:
+        return Engine::KeplerMemory;
+    }
+    return Engine::Unbound;
+}
+
+struct EngineStats {
+    u64 num_methods{};
+    std::chrono::nanoseconds time{};
+};
+
+/// A run of command words of a trace entry that only calls methods of one subchannel
+struct Segment {
+    s32 channel;
+    Engine engine;
+    /// GPU address of the words, zero when they are pushed as a prefetched command list
+    GPUVAddr address;
+    std::span<const CommandHeader> commands;
+};
+
+/// Decodes the command stream like the DMA pusher does, to attribute methods to engines
+class StreamDecoder {
+public:
+    void Decode(const GpuTraceCommands& entry, std::vector<Segment>& segments,
+                std::array<EngineStats, static_cast<size_t>(Engine::Count)>& stats) {
+        const std::span<const CommandHeader> commands{entry.commands};
+        size_t segment_start{};
+        u32 segment_subchannel{subchannel};
+        const auto cut{[&](size_t index) {
+            if (index != segment_start) {
+                segments.push_back({
+                    .channel = entry.channel,
+                    .engine = engines[segment_subchannel],
+                    .address = entry.address != 0
+                                   ? entry.address + segment_start * sizeof(CommandHeader)
+                                   : 0,
+                    .commands = commands.subspan(segment_start, index - segment_start),
+                });
+            }
+            segment_start = index;
+        }};
+        for (size_t index = 0; index < commands.size(); ++index) {
+            const CommandHeader& header{commands[index]};
+            if (method_count != 0) {
+                Call(header.argument, stats);
+                if (!non_incrementing) {
+                    ++method;
+                }
+                if (increment_once) {
+                    non_incrementing = true;
+                }
+                --method_count;
+                continue;
+            }
+            if (header.subchannel != segment_subchannel) {
+                cut(index);
+                segment_subchannel = header.subchannel;
+            }
+            subchannel = header.subchannel;
+            method = header.method;
+            switch (header.mode) {
+            case SubmissionMode::Increasing:
+            case SubmissionMode::NonIncreasing:
+            case SubmissionMode::IncreaseOnce:
+                method_count = header.method_count;
+                non_incrementing = header.mode == SubmissionMode::NonIncreasing;
+                increment_once = header.mode == SubmissionMode::IncreaseOnce;
+                break;
+            case SubmissionMode::Inline:
+                Call(header.arg_count, stats);
+                break;
+            default:
+                break;
+            }
+        }
+        cut(commands.size());
+    }
+
+private:
+    void Call(u32 argument, std::array<EngineStats, static_cast<size_t>(Engine::Count)>& stats) {
+        if (method < NON_PULLER_METHODS) {
+            if (method == BIND_OBJECT_METHOD) {
+                engines[subchannel] = EngineFromClass(argument);
+            }
+            ++stats[static_cast<size_t>(Engine::Puller)].num_methods;
+            return;
+        }
+        ++stats[static_cast<size_t>(engines[subchannel])].num_methods;
+    }
+
+    std::array<Engine, NUM_SUBCHANNELS> engines{
+        Engine::Unbound, Engine::Unbound, Engine::Unbound, Engine::Unbound,
+        Engine::Unbound, Engine::Unbound, Engine::Unbound, Engine::Unbound,
+    };
+    u32 subchannel{};
+    u32 method{};
+    u32 method_count{};
+    bool non_incrementing{};
+    bool increment_once{};
+};
+
+void PrintHelp(const char* argv0) {
+    fmt::print("Usage: {} [options] <trace.bin>\n"
+               "-e, --per-engine  Replay engine runs separately to time each engine\n"
+               "-f, --fastmem     Translate GPU addresses through a host mapped arena\n"
+               "-m, --macros      Macro engine: jit (default), threaded or interpreter\n"
+               "-n, --iterations  Number of times the trace is replayed, defaults to 1\n"
+               "-s, --serial      Call register methods one at a time instead of in batches\n"
+               "-h, --help        Display this help and exit\n"
+               "-v, --version     Output version information and exit\n"
+               "\n"
+               "Guest memory the GPU accessed and the mappings of its address spaces are restored\n"
+               "before each command list, outside of the timed region. Pushbuffers are fetched\n"
+               "from the restored memory like on the recording run.\n",
+               argv0);
+}
+
+/// Backs the device memory mapped by the trace with host memory that belongs to no process
+class ReplayMemory {
+public:
+    explicit ReplayMemory(Tegra::MaxwellDeviceMemoryManager& device_memory_)
+        : device_memory{device_memory_},
+          physical_size{
+              Kernel::Board::Nintendo::Nx::KSystemControl::Init::GetIntendedMemorySize()} {}
+
+    /// Back the pages of a device range that are not backed yet
+    void Back(DAddr address, u64 size) {
+        const DAddr end = Common::AlignUp(address + size, Core::DEVICE_PAGESIZE);
+        DAddr page = Common::AlignDown(address, Core::DEVICE_PAGESIZE);
+        while (page < end) {
+            if (!backed_pages.insert(page).second) {
+                page += Core::DEVICE_PAGESIZE;
+                continue;
+            }
+            const DAddr run_start = page;
+            page += Core::DEVICE_PAGESIZE;
+            while (page < end && backed_pages.insert(page).second) {
+                page += Core::DEVICE_PAGESIZE;
+            }
+            const u64 run_size = page - run_start;
+            if (next_physical + run_size > physical_size) {
+                LOG_CRITICAL(HW_GPU, "The trace maps more device memory than can be backed");
+                return;
+            }
+            device_memory.MapPhysical(run_start, next_physical, run_size);
+            next_physical += run_size;
+        }
+    }
+
+    /// Restore the contents of a device page
+    void Write(DAddr address, std::span<const u8> data) {
+        if (u8* const pointer = device_memory.GetPointer<u8>(address)) {
+            std::memcpy(pointer, data.data(), data.size());
+        }
+    }
+
+private:
+    Tegra::MaxwellDeviceMemoryManager& device_memory;
+    const u64 physical_size;
+    std::unordered_set<DAddr> backed_pages;
+    PAddr next_physical{};
+};
+
+/// Recreates the address spaces and channels of a trace, and restores the memory they access
+class ReplayState {
+public:
+    explicit ReplayState(Core::System& system_)
+        : system{system_}, gpu{system.GPU()}, memory{system.Host1x().MemoryManager()} {}
+
+    /// Apply an entry that is not a command list
+    void Apply(const GpuTraceEntry& entry) {
+        std::visit([this](const auto& value) { Apply(value); }, entry);
+    }
+
+    /// Channel that replays the command lists of a traced channel, or null if it is unknown
+    Tegra::Control::ChannelState* Channel(s32 channel_id) {
+        const auto it = channels.find(channel_id);
+        if (it == channels.end()) {
+            LOG_ERROR(HW_GPU, "Trace uses channel {} without binding an address space",
+                      channel_id);
+            return nullptr;
+        }
+        return it->second.get();
+    }
+
+    /// Number of draws the 3D engines of the replayed channels sent to the rasterizer
+    u64 NumDraws() const {
+        u64 num_draws{};
+        for (const auto& [id, channel] : channels) {
+            num_draws += channel->maxwell_3d->draw_manager->GetNumDraws();
+        }
+        return num_draws;
+    }
+
+    /// Translation counters of all the address spaces of the trace
+    Tegra::MemoryTranslationStatistics TranslationStatistics() const {
+        Tegra::MemoryTranslationStatistics total{};
+        for (const auto& [id, memory_manager] : address_spaces) {
+            const auto stats{memory_manager->GetTranslationStatistics()};
+            total.num_direct_translations += stats.num_direct_translations;
+            total.num_page_walks += stats.num_page_walks;
+        }
+        return total;
+    }
+
+    /// Write the words of a command list to its pushbuffer, so the DMA pusher fetches them
+    void RestorePushbuffer(Tegra::Control::ChannelState& channel,
+                           const GpuTraceCommands& commands) {
+        if (commands.address == 0) {
+            return;
+        }
+        channel.memory_manager->WriteBlockUnsafe(commands.address, commands.commands.data(),
+                                                 commands.commands.size() * sizeof(CommandHeader));
+    }
+
+private:
+    void Apply(const GpuTraceCommands&) {
+        // Command lists are pushed by the caller, so only they are timed
+    }
+
+    void Apply(const GpuTraceAddressSpace& address_space) {
+        if (address_spaces.contains(address_space.id)) {
+            return;
+        }
+        auto memory_manager{std::make_shared<Tegra::MemoryManager>(
+            system, address_space.address_space_bits, address_space.split_address,
+            address_space.big_page_bits, address_space.page_bits)};
+        gpu.InitAddressSpace(*memory_manager);
+        address_spaces.emplace(address_space.id, std::move(memory_manager));
+    }
+
+    void Apply(const GpuTraceChannel& channel_entry) {
+        if (channels.contains(channel_entry.channel)) {
+            return;
+        }
+        const auto it = address_spaces.find(channel_entry.address_space);
+        if (it == address_spaces.end()) {
+            LOG_ERROR(HW_GPU, "Channel {} uses unknown address space {}", channel_entry.channel,
+                      channel_entry.address_space);
+            return;
+        }
+        auto channel{gpu.AllocateChannel()};
+        channel->memory_manager = it->second;
+        gpu.InitChannel(*channel, 0);
+        channels.emplace(channel_entry.channel, std::move(channel));
+    }
+
+    void Apply(const GpuTraceMap& map) {
+        Tegra::MemoryManager* const memory_manager = AddressSpace(map.address_space);
+        if (!memory_manager) {
+            return;
+        }
+        if (map.sparse) {
+            memory_manager->MapSparse(map.gpu_addr, map.size, map.big_pages);
+            return;
+        }
+        memory.Back(map.device_addr, map.size);
+        memory_manager->Map(map.gpu_addr, map.device_addr, map.size, map.kind, map.big_pages);
+    }
+
+    void Apply(const GpuTraceUnmap& unmap) {
+        if (Tegra::MemoryManager* const memory_manager = AddressSpace(unmap.address_space)) {
+            memory_manager->Unmap(unmap.gpu_addr, unmap.size);
+        }
+    }
+
+    void Apply(const GpuTraceMemory& page) {
+        memory.Write(page.device_addr, page.data);
+    }
+
+    Tegra::MemoryManager* AddressSpace(u64 id) {
+        const auto it = address_spaces.find(id);
+        if (it == address_spaces.end()) {
+            LOG_ERROR(HW_GPU, "Trace maps unknown address space {}", id);
+            return nullptr;
+        }
+        return it->second.get();
+    }
+
+    Core::System& system;
+    Tegra::GPU& gpu;
+    ReplayMemory memory;
+    std::unordered_map<u64, std::shared_ptr<Tegra::MemoryManager>> address_spaces;
+    std::unordered_map<s32, std::shared_ptr<Tegra::Control::ChannelState>> channels;
+};
+
+/// Build the command list of a segment, pushing a command list consumes it
+Tegra::CommandList BuildCommandList(const Segment& segment) {
+    if (segment.address == 0) {
+        return Tegra::CommandList(boost::container::small_vector<CommandHeader, 512>(
+            segment.commands.begin(), segment.commands.end()));
+    }
+    Tegra::CommandList command_list(1);
+    Tegra::CommandListHeader& header{command_list.command_lists[0]};
+    header.raw = 0;
+    header.addr.Assign(segment.address);
+    header.size.Assign(segment.commands.size());
+    return command_list;
+}
+
+void Replay(Tegra::GPU& gpu, Tegra::Control::ChannelState& channel,
+            Tegra::CommandList&& command_list) {
+    gpu.BindChannel(channel.bind_id);
+    channel.dma_pusher->Push(std::move(command_list));
+    channel.dma_pusher->DispatchCalls();
+}
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    Common::DetachedTasks detached_tasks;
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+
+    bool per_engine{};
+    bool fastmem{};
+    u64 num_iterations{1};
+    std::string_view macro_engine{"jit"};
+    bool serial_methods{};
+
+    static struct option long_options[] = {
+        {"per-engine", no_argument, 0, 'e'},
+        {"fastmem", no_argument, 0, 'f'},
+        {"macros", required_argument, 0, 'm'},
+        {"iterations", required_argument, 0, 'n'},
+        {"serial", no_argument, 0, 's'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+    int option_index = 0;
+    while (optind < argc) {
+        const int arg = getopt_long(argc, argv, "efm:n:shv", long_options, &option_index);
+        if (arg == -1) {
+            break;
+        }
+        switch (static_cast<char>(arg)) {
+        case 'e':
+            per_engine = true;
+            break;
+        case 'f':
+            fastmem = true;
+            break;
+        case 'm':
+            macro_engine = optarg;
+            break;
+        case 'n':
+            num_iterations = std::max<u64>(std::strtoull(optarg, nullptr, 0), 1);
+            break;
+        case 's':
+            serial_methods = true;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            fmt::print("yuzu GPU replay {} {}\n", Common::g_scm_branch, Common::g_scm_desc);
+            return 0;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+    if (optind + 1 != argc) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    std::vector<GpuTraceEntry> entries;
+    if (!Tegra::ReadGpuTrace(Common::FS::ToU8String(argv[optind]), entries)) {
+        return -1;
+    }
+    // The segments of entry i are [first_segment[i], first_segment[i + 1])
+    std::vector<Segment> segments;
+    std::vector<size_t> first_segment;
+    first_segment.reserve(entries.size() + 1);
+    std::array<EngineStats, static_cast<size_t>(Engine::Count)> stats{};
+    u64 num_command_lists{};
+    u64 num_memory_pages{};
+    std::unordered_map<s32, StreamDecoder> decoders;
+    std::vector<Segment> engine_segments;
+    for (const GpuTraceEntry& entry : entries) {
+        first_segment.push_back(segments.size());
+        if (std::holds_alternative<GpuTraceMemory>(entry)) {
+            ++num_memory_pages;
+        }
+        const auto* const commands = std::get_if<GpuTraceCommands>(&entry);
+        if (!commands) {
+            continue;
+        }
+        ++num_command_lists;
+        engine_segments.clear();
+        decoders[commands->channel].Decode(*commands, engine_segments, stats);
+        if (per_engine) {
+            segments.insert(segments.end(), engine_segments.begin(), engine_segments.end());
+            continue;
+        }
+        // Replay whole command lists, engine runs are only split to time them separately
+        segments.push_back({
+            .channel = commands->channel,
+            .engine = Engine::Unbound,
+            .address = commands->address,
+            .commands = commands->commands,
+        });
+    }
+    first_segment.push_back(segments.size());
+    LOG_INFO(HW_GPU, "Loaded {} command lists and {} memory pages from {}", num_command_lists,
+             num_memory_pages, argv[optind]);
+
+    // Replay on the null renderer, so only the GPU frontend is measured
+    Settings::values.renderer_backend.SetValue(Settings::RendererBackend::Null);
+    Settings::values.use_asynchronous_gpu_emulation.SetValue(false);
+    if (macro_engine == "threaded") {
+        Settings::values.disable_macro_jit.SetValue(true);
+    } else if (macro_engine == "interpreter") {
+        Settings::values.disable_macro_jit.SetValue(true);
+        Settings::values.disable_macro_optimizer.SetValue(true);
+    } else if (macro_engine != "jit") {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    Settings::values.disable_register_batching.SetValue(serial_methods);
+    Settings::values.use_gpu_fastmem.SetValue(fastmem);
+    Core::System system;
+    system.Initialize();
+    ReplayWindow window;
+    if (system.InitializeGPU(window) != Core::SystemResultStatus::Success) {
+        LOG_CRITICAL(HW_GPU, "Failed to initialize the GPU");
+        return -1;
+    }
+    Tegra::GPU& gpu{system.GPU()};
+    ReplayState state{system};
+
+    // Memory is restored and command lists are built outside of the timed region, only pushing
+    // and dispatching the command lists is timed
+    std::chrono::duration<double> elapsed{};
+    for (u64 iteration = 0; iteration < num_iterations; ++iteration) {
+        for (size_t index = 0; index < entries.size(); ++index) {
+            const auto* const commands = std::get_if<GpuTraceCommands>(&entries[index]);
+            if (!commands) {
+                state.Apply(entries[index]);
+                continue;
+            }
+            Tegra::Control::ChannelState* const channel = state.Channel(commands->channel);
+            if (!channel) {
+                continue;
+            }
+            state.RestorePushbuffer(*channel, *commands);
+            for (size_t segment = first_segment[index]; segment < first_segment[index + 1];
+                 ++segment) {
+                Tegra::CommandList command_list{BuildCommandList(segments[segment])};
+                const auto start{Clock::now()};
+                Replay(gpu, *channel, std::move(command_list));
+                const auto time{Clock::now() - start};
+                elapsed += time;
+                stats[static_cast<size_t>(segments[segment].engine)].time += time;
+            }
+        }
+    }
+
+    u64 num_methods{};
+    for (const EngineStats& engine_stats : stats) {
+        num_methods += engine_stats.num_methods;
+    }
+    // Draws are counted by the engine, so the draws macros issue are included
+    const u64 total_draws{state.NumDraws()};
+    const double seconds{elapsed.count()};
+    const double iterations{static_cast<double>(num_iterations)};
+    fmt::print("{} command lists, {} methods, {} draws per iteration\n", num_command_lists,
+               num_methods, total_draws / num_iterations);
+    fmt::print("{:.3f} s for {} iterations, {:.0f} methods/s, {:.0f} draws/s\n", seconds,
+               num_iterations, static_cast<double>(num_methods) * iterations / seconds,
+               static_cast<double>(total_draws) / seconds);
+    // Includes the translations of the memory restored outside of the timed region
+    const auto translations{state.TranslationStatistics()};
+    fmt::print("{} direct GPU address translations, {} page table walks\n",
+               translations.num_direct_translations, translations.num_page_walks);
+    for (size_t index = 0; index < stats.size(); ++index) {
+        const EngineStats& engine_stats{stats[index]};
+        if (engine_stats.num_methods == 0) {
+            continue;
+        }
+        if (per_engine) {
+            const auto engine_ms{std::chrono::duration<double, std::milli>(engine_stats.time)};
+            fmt::print("{:>14}: {:>12} methods {:>10.3f} ms\n", ENGINE_NAMES[index],
+                       engine_stats.num_methods, engine_ms.count());
+        } else {
+            fmt::print("{:>14}: {:>12} methods\n", ENGINE_NAMES[index], engine_stats.num_methods);
+        }
+    }
+    detached_tasks.WaitForAllTasks();
+    return 0;
+}
@@ -0,0 +1,416 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <ios>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/fs/path_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "common/thread_worker.h"
+#include "shader_recompiler/backend/bindings.h"
+#include "shader_recompiler/backend/glsl/emit_glsl.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/object_pool.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/program_header.h"
+#include "shader_recompiler/stage.h"
+#include "video_core/renderer_opengl/gl_compute_pipeline.h"
+#include "video_core/renderer_opengl/gl_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/shader_environment.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+using Shader::Stage;
+using VideoCommon::FileEnvironment;
+using VideoCommon::PipelineCacheRecord;
+
+enum class Backend {
+    None,
+    SPIRV,
+    GLSL,
+};
+
+struct ShaderPools {
+    Shader::ObjectPool<Shader::IR::Inst> inst{8192};
+    Shader::ObjectPool<Shader::IR::Block> block{32};
+    Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
+};
+
+struct ShaderReport {
+    Stage stage{};
+    std::chrono::microseconds translate_time{};
+    size_t num_insts{};
+    size_t code_size{};
+    std::string error;
+};
+
+struct PipelineReport {
+    bool is_valid{};
+    std::vector<ShaderReport> shaders;
+};
+
+/// Pipeline key sizes of the renderer that wrote a cache file
+struct KeySizes {
+    size_t compute{};
+    size_t graphics{};
+};
+
+void PrintHelp(const char* argv0) {
+    fmt::print("Usage: {} [options] <cache.bin>...\n"
+               "-b, --backend   Backend to emit code with: spirv (default), glsl or none\n"
+               "-j, --jobs      Number of translation threads, defaults to the number of cores\n"
+               "-o, --output    Write the deduplicated pipelines of all inputs to this file\n"
+               "-p, --prune     Leave the pipelines that fail to translate out of the output\n"
+               "-q, --quiet     Only report failures and the summary\n"
+               "-h, --help      Display this help and exit\n"
+               "-v, --version   Output version information and exit\n"
+               "\n"
+               "Caches written by older versions are converted to the indexed format in memory.\n"
+               "Their renderer is taken from the file name, vulkan.bin or opengl.bin.\n",
+               argv0);
+}
+
+std::string_view StageName(Stage stage) {
+    switch (stage) {
+    case Stage::VertexA:
+        return "VA";
+    case Stage::VertexB:
+        return "VB";
+    case Stage::TessellationControl:
+        return "TC";
+    case Stage::TessellationEval:
+        return "TE";
+    case Stage::Geometry:
+        return "GS";
+    case Stage::Fragment:
+        return "FS";
+    case Stage::Compute:
+        return "CS";
+    }
+    return "??";
+}
+
+std::optional<Backend> ParseBackend(std::string_view name) {
+    if (name == "spirv") {
+        return Backend::SPIRV;
+    }
+    if (name == "glsl") {
+        return Backend::GLSL;
+    }
+    if (name == "none") {
+        return Backend::None;
+    }
+    return std::nullopt;
+}
+
+/// Legacy cache files don't record their key sizes, the renderer is known from the file name
+KeySizes GetKeySizes(const std::filesystem::path& filename) {
+    const std::filesystem::path name{filename.filename()};
+    if (name == "vulkan.bin") {
+        return {
+            .compute = sizeof(Vulkan::ComputePipelineCacheKey),
+            .graphics = sizeof(Vulkan::GraphicsPipelineCacheKey),
+        };
+    }
+    if (name == "opengl.bin") {
+        return {
+            .compute = sizeof(OpenGL::ComputePipelineKey),
+            .graphics = sizeof(OpenGL::GraphicsPipelineKey),
+        };
+    }
+    return {};
+}
+
+Shader::Profile MakeProfile() {
+    // Conservative host, so the cache is validated against the widest set of lowering passes
+    return Shader::Profile{
+        .supported_spirv = 0x00010300,
+        .support_vertex_instance_id = true,
+        .support_vote = true,
+        .support_geometry_streams = true,
+        .max_user_clip_distances = 8,
+    };
+}
+
+size_t CountInsts(const Shader::IR::Program& program) {
+    size_t num_insts{};
+    for (const Shader::IR::Block* const block : program.blocks) {
+        num_insts += block->Instructions().size();
+    }
+    return num_insts;
+}
+
+PipelineReport TranslatePipeline(const PipelineCacheRecord& record, Backend backend,
+                                 const Shader::Profile& profile,
+                                 const Shader::HostTranslateInfo& host_info) {
+    PipelineReport report;
+    std::span<const u8> key;
+    std::vector<FileEnvironment> envs;
+    try {
+        envs = VideoCommon::DeserializePipelineRecord(record.data, key);
+    } catch (const std::ios_base::failure& e) {
+        report.shaders.push_back({.error = fmt::format("Malformed record: {}", e.what())});
+        return report;
+    }
+    ShaderPools pools;
+    Shader::Backend::Bindings binding;
+    std::optional<Shader::IR::Program> vertex_a;
+    report.is_valid = true;
+    for (FileEnvironment& env : envs) {
+        ShaderReport& shader{report.shaders.emplace_back()};
+        shader.stage = env.ShaderStage();
+        const auto start{std::chrono::steady_clock::now()};
+        try {
+            const bool is_compute{shader.stage == Stage::Compute};
+            const u32 cfg_offset{is_compute ? env.StartAddress()
+                                            : static_cast<u32>(env.StartAddress() +
+                                                               sizeof(Shader::ProgramHeader))};
+            Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset,
+                                           shader.stage == Stage::VertexA);
+            Shader::IR::Program program{
+                Shader::Maxwell::TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
+            if (shader.stage == Stage::VertexA) {
+                // VertexA is only emitted merged with the following VertexB
+                shader.num_insts = CountInsts(program);
+                vertex_a = std::move(program);
+            } else {
+                if (shader.stage == Stage::VertexB && vertex_a) {
+                    program = Shader::Maxwell::MergeDualVertexPrograms(*vertex_a, program, env);
+                    vertex_a.reset();
+                }
+                shader.num_insts = CountInsts(program);
+                switch (backend) {
+                case Backend::None:
+                    break;
+                case Backend::SPIRV:
+                    shader.code_size =
+                        Shader::Backend::SPIRV::EmitSPIRV(profile, {}, program, binding).size() *
+                        sizeof(u32);
+                    break;
+                case Backend::GLSL:
+                    shader.code_size =
+                        Shader::Backend::GLSL::EmitGLSL(profile, {}, program, binding).size();
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            shader.error = e.what();
+            report.is_valid = false;
+        }
+        shader.translate_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    }
+    return report;
+}
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+
+    Backend backend{Backend::SPIRV};
+    size_t num_jobs{std::max(std::thread::hardware_concurrency(), 1U)};
+    std::filesystem::path output;
+    bool prune{};
+    bool quiet{};
+
+    static struct option long_options[] = {
+        {"backend", required_argument, 0, 'b'},
+        {"jobs", required_argument, 0, 'j'},
+        {"output", required_argument, 0, 'o'},
+        {"prune", no_argument, 0, 'p'},
+        {"quiet", no_argument, 0, 'q'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+    int option_index = 0;
+    while (optind < argc) {
+        const int arg = getopt_long(argc, argv, "b:j:o:pqhv", long_options, &option_index);
+        if (arg == -1) {
+            break;
+        }
+        switch (static_cast<char>(arg)) {
+        case 'b':
+            if (const auto parsed = ParseBackend(optarg)) {
+                backend = *parsed;
+            } else {
+                LOG_CRITICAL(Shader, "Unknown backend \"{}\"", optarg);
+                return -1;
+            }
+            break;
+        case 'j':
+            num_jobs = std::max<size_t>(std::strtoul(optarg, nullptr, 0), 1);
+            break;
+        case 'o':
+            output = Common::FS::ToU8String(optarg);
+            break;
+        case 'p':
+            prune = true;
+            break;
+        case 'q':
+            quiet = true;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            fmt::print("yuzu shader cache tool {} {}\n", Common::g_scm_branch, Common::g_scm_desc);
+            return 0;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+    if (optind >= argc) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    // Load and deduplicate the pipelines of every input, later inputs replace earlier records
+    std::vector<PipelineCacheRecord> records;
+    std::optional<u32> cache_version;
+    for (int index = optind; index < argc; ++index) {
+        const std::filesystem::path filename{Common::FS::ToU8String(argv[index])};
+        std::vector<PipelineCacheRecord> file_records;
+        const KeySizes key_sizes{GetKeySizes(filename)};
+        const std::optional<u32> file_version{VideoCommon::ReadPipelineCache(
+            filename, file_records, key_sizes.compute, key_sizes.graphics)};
+        if (!file_version) {
+            continue;
+        }
+        if (cache_version && *cache_version != *file_version) {
+            LOG_WARNING(Shader, "Skipping {}, cache version {} does not match {}", argv[index],
+                        *file_version, *cache_version);
+            continue;
+        }
+        cache_version = file_version;
+        LOG_INFO(Shader, "Loaded {} pipelines from {}", file_records.size(), argv[index]);
+        std::ranges::move(file_records, std::back_inserter(records));
+    }
+    if (!cache_version) {
+        LOG_CRITICAL(Shader, "No pipeline cache could be loaded");
+        return -1;
+    }
+    const size_t num_loaded{records.size()};
+    std::unordered_map<u64, size_t> latest;
+    for (size_t index = 0; index < records.size(); ++index) {
+        latest.insert_or_assign(records[index].key_hash, index);
+    }
+    size_t num_unique{};
+    for (size_t index = 0; index < records.size(); ++index) {
+        if (latest.at(records[index].key_hash) != index) {
+            continue;
+        }
+        if (num_unique != index) {
+            records[num_unique] = std::move(records[index]);
+        }
+        ++num_unique;
+    }
+    records.resize(num_unique);
+
+    const Shader::Profile profile{MakeProfile()};
+    const Shader::HostTranslateInfo host_info{
+        .support_float64 = true,
+        .support_float16 = true,
+        .support_int64 = true,
+        .needs_demote_reorder = false,
+        .support_snorm_render_buffer = true,
+        .support_viewport_index_layer = true,
+        .min_ssbo_alignment = 16,
+        .support_geometry_shader_passthrough = false,
+        .support_conditional_barrier = false,
+    };
+    std::vector<PipelineReport> reports(records.size());
+    const auto start{std::chrono::steady_clock::now()};
+    {
+        Common::ThreadWorker workers(num_jobs, "ShaderCacheTool");
+        for (size_t index = 0; index < records.size(); ++index) {
+            workers.QueueWork([&, index] {
+                reports[index] = TranslatePipeline(records[index], backend, profile, host_info);
+            });
+        }
+        workers.WaitForRequests();
+    }
+    const auto wall_time{std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start)};
+
+    size_t num_shaders{};
+    size_t num_failed_shaders{};
+    size_t num_failed_pipelines{};
+    std::chrono::microseconds total_time{};
+    for (size_t index = 0; index < records.size(); ++index) {
+        const PipelineReport& report{reports[index]};
+        num_failed_pipelines += report.is_valid ? 0 : 1;
+        for (const ShaderReport& shader : report.shaders) {
+            ++num_shaders;
+            total_time += shader.translate_time;
+            const bool failed{!shader.error.empty()};
+            num_failed_shaders += failed ? 1 : 0;
+            if (quiet && !failed) {
+                continue;
+            }
+            fmt::print("{:016x} {} {:>8} us {:>7} insts {:>8} bytes {}\n",
+                       records[index].key_hash, StageName(shader.stage),
+                       shader.translate_time.count(), shader.num_insts, shader.code_size,
+                       failed ? shader.error : "ok");
+        }
+    }
+    fmt::print("{} pipelines ({} duplicates removed), {} shaders, {} failed shaders in {} "
+               "pipelines\n",
+               records.size(), num_loaded - records.size(), num_shaders, num_failed_shaders,
+               num_failed_pipelines);
+    fmt::print("Translation time {} ms, wall time {} ms with {} threads\n",
+               total_time.count() / 1000, wall_time.count(), num_jobs);
+
+    if (!output.empty()) {
+        if (prune) {
+            size_t num_valid{};
+            for (size_t index = 0; index < records.size(); ++index) {
+                if (!reports[index].is_valid) {
+                    continue;
+                }
+                if (num_valid != index) {
+                    records[num_valid] = std::move(records[index]);
+                }
+                ++num_valid;
+            }
+            records.resize(num_valid);
+        }
+        if (!VideoCommon::WritePipelineCache(output, *cache_version, records)) {
+            return -1;
+        }
+        fmt::print("Wrote {} pipelines to {}\n", records.size(),
+                   Common::FS::PathToUTF8String(output));
+    }
+    return num_failed_pipelines == 0 ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Shader {
+
+/// Bump allocator for short lived IR containers, memory is only released on destruction
+class Arena {
+public:
+    explicit Arena(size_t block_size = 64 * 1024) : new_block_size{block_size} {}
+
+    Arena& operator=(const Arena&) = delete;
+    Arena(const Arena&) = delete;
+
+    [[nodiscard]] void* Allocate(size_t size, size_t alignment) {
+        void* pointer{cursor};
+        size_t space{remaining};
+        if (!std::align(alignment, size, pointer, space)) {
+            NewBlock(std::max(new_block_size, size + alignment));
+            pointer = cursor;
+            space = remaining;
+            std::align(alignment, size, pointer, space);
+        }
+        cursor = static_cast<std::byte*>(pointer) + size;
+        remaining = space - size;
+        return pointer;
+    }
+
+private:
+    void NewBlock(size_t size) {
+        cursor = blocks.emplace_back(new std::byte[size]).get();
+        remaining = size;
+        // Grow geometrically to keep the number of blocks low on large shaders
+        new_block_size *= 2;
+    }
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::byte* cursor{};
+    size_t remaining{};
+    size_t new_block_size{};
+};
+
+/// Standard allocator interface over an arena, deallocations are no-ops
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(Arena& arena_) noexcept : arena{&arena_} {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena{other.arena} {}
+
+    [[nodiscard]] T* allocate(size_t n) {
+        return static_cast<T*>(arena->Allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    [[nodiscard]] bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+private:
+    template <typename>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+};
+
+} // namespace Shader
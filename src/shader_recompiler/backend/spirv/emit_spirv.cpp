@@ -496,6 +496,34 @@ std::vector<u32> EmitSPIRV(const Profile& profile, const RuntimeInfo& runtime_in
     return ctx.Assemble();
 }
 
+void AdvanceBindings(const Profile& profile, const Info& info, Bindings& bindings) {
+    // Keep in sync with the descriptor definitions in EmitContext
+    const auto num_descriptors{[](const auto& descriptors) {
+        u32 count{};
+        for (const auto& desc : descriptors) {
+            count += desc.count;
+        }
+        return count;
+    }};
+    const bool is_unified{profile.unified_descriptor_binding};
+    u32& uniform_binding{is_unified ? bindings.unified : bindings.uniform_buffer};
+    u32& storage_binding{is_unified ? bindings.unified : bindings.storage_buffer};
+    u32& texture_binding{is_unified ? bindings.unified : bindings.texture};
+    u32& image_binding{is_unified ? bindings.unified : bindings.image};
+    if (profile.support_descriptor_aliasing) {
+        uniform_binding += static_cast<u32>(info.constant_buffer_descriptors.size());
+    } else {
+        uniform_binding += num_descriptors(info.constant_buffer_descriptors);
+    }
+    storage_binding += num_descriptors(info.storage_buffers_descriptors);
+    texture_binding += static_cast<u32>(info.texture_buffer_descriptors.size());
+    image_binding += static_cast<u32>(info.image_buffer_descriptors.size());
+    texture_binding += static_cast<u32>(info.texture_descriptors.size());
+    bindings.texture_scaling_index += static_cast<u32>(info.texture_descriptors.size());
+    image_binding += static_cast<u32>(info.image_descriptors.size());
+    bindings.image_scaling_index += static_cast<u32>(info.image_descriptors.size());
+}
+
 Id EmitPhi(EmitContext& ctx, IR::Inst* inst) {
     const size_t num_args{inst->NumArgs()};
     boost::container::small_vector<Id, 32> blocks;
@@ -33,6 +33,10 @@ constexpr u32 RENDERAREA_LAYOUT_OFFSET = offsetof(RenderAreaLayout, render_area)
 [[nodiscard]] std::vector<u32> EmitSPIRV(const Profile& profile, const RuntimeInfo& runtime_info,
                                          IR::Program& program, Bindings& bindings);
 
+/// Advance bindings past the descriptors EmitSPIRV would assign to a program, allowing the stages
+/// of a pipeline to be emitted concurrently from precomputed bindings
+void AdvanceBindings(const Profile& profile, const Info& info, Bindings& bindings);
+
 [[nodiscard]] inline std::vector<u32> EmitSPIRV(const Profile& profile, IR::Program& program) {
     Bindings binding;
     return EmitSPIRV(profile, {}, program, binding);
@@ -6,6 +6,7 @@
 #include <vector>
 #include <queue>
 
+#include "common/microprofile.h"
 #include "common/settings.h"
 #include "shader_recompiler/exception.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
@@ -17,6 +18,9 @@
 #include "shader_recompiler/host_translate_info.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_TranslateProgram, "Shader", "Translate Program", MP_RGB(96, 160, 255));
+MICROPROFILE_DEFINE(Shader_BuildASL, "Shader", "Build ASL", MP_RGB(128, 192, 255));
+
 namespace Shader::Maxwell {
 namespace {
 IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
@@ -239,8 +243,13 @@ void LowerGeometryPassthrough(const IR::Program& program, const HostTranslateInf
 
 IR::Program TranslateProgram(ObjectPool<IR::Inst>& inst_pool, ObjectPool<IR::Block>& block_pool,
                              Environment& env, Flow::CFG& cfg, const HostTranslateInfo& host_info) {
+    MICROPROFILE_SCOPE(Shader_TranslateProgram);
+
     IR::Program program;
-    program.syntax_list = BuildASL(inst_pool, block_pool, env, cfg, host_info);
+    {
+        MICROPROFILE_SCOPE(Shader_BuildASL);
+        program.syntax_list = BuildASL(inst_pool, block_pool, env, cfg, host_info);
+    }
     program.blocks = GenerateBlocks(program.syntax_list);
     program.post_order_blocks = PostOrder(program.syntax_list.front());
     program.stage = env.ShaderStage();
@@ -304,6 +313,7 @@ IR::Program TranslateProgram(ObjectPool<IR::Inst>& inst_pool, ObjectPool<IR::Blo
     if (Settings::values.resolution_info.active) {
         Optimization::RescalingPass(program);
     }
+    Optimization::GlobalValueNumberingPass(program);
     Optimization::DeadCodeEliminationPass(program);
     if (Settings::values.renderer_debug) {
         Optimization::VerificationPass(program);
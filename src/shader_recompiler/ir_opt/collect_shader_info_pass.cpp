@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "common/alignment.h"
+#include "common/microprofile.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/ir/modifiers.h"
 #include "shader_recompiler/frontend/ir/program.h"
@@ -9,6 +10,9 @@
 #include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/shader_info.h"
 
+MICROPROFILE_DEFINE(Shader_CollectShaderInfo, "Shader", "Collect Shader Info",
+                    MP_RGB(255, 192, 128));
+
 namespace Shader::Optimization {
 namespace {
 void AddConstantBufferDescriptor(Info& info, u32 index, u32 count) {
@@ -943,6 +947,8 @@ void GatherInfoFromHeader(Environment& env, Info& info) {
 } // Anonymous namespace
 
 void CollectShaderInfoPass(Environment& env, IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_CollectShaderInfo);
+
     Info& info{program.info};
     const u32 base{[&] {
         switch (program.stage) {
@@ -1,12 +1,18 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/program.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_ConditionalBarrier, "Shader", "Conditional Barrier",
+                    MP_RGB(192, 128, 255));
+
 namespace Shader::Optimization {
 
 void ConditionalBarrierPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_ConditionalBarrier);
+
     s32 conditional_control_flow_count{0};
     s32 conditional_return_count{0};
     for (IR::AbstractSyntaxNode& node : program.syntax_list) {
@@ -7,6 +7,7 @@
 #include <type_traits>
 
 #include "common/bit_cast.h"
+#include "common/microprofile.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/exception.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
@@ -14,6 +15,9 @@
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_ConstantPropagation, "Shader", "Constant Propagation",
+                    MP_RGB(128, 255, 192));
+
 namespace Shader::Optimization {
 namespace {
 // Metaprogramming stuff to get arguments information out of a lambda
@@ -1101,6 +1105,8 @@ void ConstantPropagation(Environment& env, IR::Block& block, IR::Inst& inst) {
 } // Anonymous namespace
 
 void ConstantPropagationPass(Environment& env, IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_ConstantPropagation);
+
     const auto end{program.post_order_blocks.rend()};
     for (auto it = program.post_order_blocks.rbegin(); it != end; ++it) {
         IR::Block* const block{*it};
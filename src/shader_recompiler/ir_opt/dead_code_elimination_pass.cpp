@@ -1,13 +1,19 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_DeadCodeElimination, "Shader", "Dead Code Elimination",
+                    MP_RGB(255, 128, 128));
+
 namespace Shader::Optimization {
 
 void DeadCodeEliminationPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_DeadCodeElimination);
+
     // We iterate over the instructions in reverse order.
     // This is because removing an instruction reduces the number of uses for earlier instructions.
     for (IR::Block* const block : program.post_order_blocks) {
@@ -1,12 +1,19 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_VertexATransform, "Shader", "Vertex A Transform",
+                    MP_RGB(160, 224, 128));
+MICROPROFILE_DEFINE(Shader_VertexBTransform, "Shader", "Vertex B Transform",
+                    MP_RGB(128, 224, 160));
+
 namespace Shader::Optimization {
 
 void VertexATransformPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_VertexATransform);
     for (IR::Block* const block : program.blocks) {
         for (IR::Inst& inst : block->Instructions()) {
             if (inst.GetOpcode() == IR::Opcode::Epilogue) {
@@ -17,6 +24,7 @@ void VertexATransformPass(IR::Program& program) {
 }
 
 void VertexBTransformPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_VertexBTransform);
     for (IR::Block* const block : program.blocks) {
         for (IR::Inst& inst : block->Instructions()) {
             if (inst.GetOpcode() == IR::Opcode::Prologue) {
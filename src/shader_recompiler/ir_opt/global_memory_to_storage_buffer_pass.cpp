@@ -7,6 +7,7 @@
 #include <boost/container/small_vector.hpp>
 
 #include "common/alignment.h"
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/breadth_first_search.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
@@ -14,6 +15,9 @@
 #include "shader_recompiler/host_translate_info.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_GlobalMemoryToStorageBuffer, "Shader", "Global Memory to Storage Buffer",
+                    MP_RGB(255, 224, 128));
+
 namespace Shader::Optimization {
 namespace {
 /// Address in constant buffers to the storage buffer descriptor
@@ -521,6 +525,8 @@ void Replace(IR::Block& block, IR::Inst& inst, const IR::U32& storage_index,
 } // Anonymous namespace
 
 void GlobalMemoryToStorageBufferPass(IR::Program& program, const HostTranslateInfo& host_info) {
+    MICROPROFILE_SCOPE(Shader_GlobalMemoryToStorageBuffer);
+
     StorageInfo info;
     for (IR::Block* const block : program.post_order_blocks) {
         for (IR::Inst& inst : block->Instructions()) {
@@ -0,0 +1,306 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Dominator based global value numbering, as described in
+//
+// Preston Briggs, Keith D. Cooper and L. Taylor Simpson. Value Numbering.
+// Software: Practice and Experience, 27(6), 701-724, 1997.
+//
+// Pure instructions are hash-consed on their opcode, flags and resolved arguments while walking
+// the dominator tree. An instruction equal to one in a dominating block is replaced by it.
+
+#include <array>
+#include <bit>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/container_hash.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "shader_recompiler/arena.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/value.h"
+#include "shader_recompiler/ir_opt/passes.h"
+
+MICROPROFILE_DEFINE(Shader_GlobalValueNumbering, "Shader", "Global Value Numbering",
+                    MP_RGB(160, 255, 128));
+
+namespace Shader::Optimization {
+namespace {
+struct ValueKey {
+    IR::Opcode opcode{};
+    u32 flags{};
+    std::array<IR::Value, 5> args{};
+
+    [[nodiscard]] bool operator==(const ValueKey&) const = default;
+};
+
+size_t HashValue(const IR::Value& value) {
+    if (!value.IsImmediate()) {
+        return std::bit_cast<size_t>(value.Inst());
+    }
+    switch (value.Type()) {
+    case IR::Type::U1:
+        return value.U1() ? 1 : 0;
+    case IR::Type::U32:
+        return value.U32();
+    case IR::Type::F32:
+        return std::bit_cast<u32>(value.F32());
+    case IR::Type::U64:
+        return static_cast<size_t>(value.U64());
+    default:
+        // Equality takes care of the rest
+        return static_cast<size_t>(value.Type());
+    }
+}
+
+struct ValueKeyHash {
+    size_t operator()(const ValueKey& key) const noexcept {
+        size_t seed{static_cast<size_t>(key.opcode)};
+        Common::HashCombine(seed, key.flags);
+        for (const IR::Value& arg : key.args) {
+            Common::HashCombine(seed, HashValue(arg));
+        }
+        return seed;
+    }
+};
+
+/// Return true when two instructions with equal keys always produce the same value
+bool IsValueNumberable(const IR::Inst& inst) {
+    if (inst.MayHaveSideEffects() || inst.IsPseudoInstruction() ||
+        inst.HasAssociatedPseudoOperation()) {
+        return false;
+    }
+    switch (inst.GetOpcode()) {
+    case IR::Opcode::Phi:
+    case IR::Opcode::Identity:
+    case IR::Opcode::Void:
+    // Context state that may change between instructions
+    case IR::Opcode::GetRegister:
+    case IR::Opcode::GetPred:
+    case IR::Opcode::GetGotoVariable:
+    case IR::Opcode::GetIndirectBranchVariable:
+    case IR::Opcode::GetAttribute:
+    case IR::Opcode::GetAttributeU32:
+    case IR::Opcode::GetAttributeIndexed:
+    case IR::Opcode::GetPatch:
+    case IR::Opcode::GetZFlag:
+    case IR::Opcode::GetSFlag:
+    case IR::Opcode::GetCFlag:
+    case IR::Opcode::GetOFlag:
+    case IR::Opcode::IsHelperInvocation:
+    // Memory that may be written by this or other invocations
+    case IR::Opcode::LoadGlobalU8:
+    case IR::Opcode::LoadGlobalS8:
+    case IR::Opcode::LoadGlobalU16:
+    case IR::Opcode::LoadGlobalS16:
+    case IR::Opcode::LoadGlobal32:
+    case IR::Opcode::LoadGlobal64:
+    case IR::Opcode::LoadGlobal128:
+    case IR::Opcode::LoadStorageU8:
+    case IR::Opcode::LoadStorageS8:
+    case IR::Opcode::LoadStorageU16:
+    case IR::Opcode::LoadStorageS16:
+    case IR::Opcode::LoadStorage32:
+    case IR::Opcode::LoadStorage64:
+    case IR::Opcode::LoadStorage128:
+    case IR::Opcode::LoadLocal:
+    case IR::Opcode::LoadSharedU8:
+    case IR::Opcode::LoadSharedS8:
+    case IR::Opcode::LoadSharedU16:
+    case IR::Opcode::LoadSharedS16:
+    case IR::Opcode::LoadSharedU32:
+    case IR::Opcode::LoadSharedU64:
+    case IR::Opcode::LoadSharedU128:
+    // Texture operations with implicit derivatives or on writable images
+    case IR::Opcode::BindlessImageSampleImplicitLod:
+    case IR::Opcode::BindlessImageSampleDrefImplicitLod:
+    case IR::Opcode::BindlessImageQueryLod:
+    case IR::Opcode::BindlessImageRead:
+    case IR::Opcode::BoundImageSampleImplicitLod:
+    case IR::Opcode::BoundImageSampleDrefImplicitLod:
+    case IR::Opcode::BoundImageQueryLod:
+    case IR::Opcode::BoundImageRead:
+    case IR::Opcode::ImageSampleImplicitLod:
+    case IR::Opcode::ImageSampleDrefImplicitLod:
+    case IR::Opcode::ImageQueryLod:
+    case IR::Opcode::ImageRead:
+    // Operations that depend on the active invocations or their neighbours
+    case IR::Opcode::VoteAll:
+    case IR::Opcode::VoteAny:
+    case IR::Opcode::VoteEqual:
+    case IR::Opcode::SubgroupBallot:
+    case IR::Opcode::ShuffleIndex:
+    case IR::Opcode::ShuffleUp:
+    case IR::Opcode::ShuffleDown:
+    case IR::Opcode::ShuffleButterfly:
+    case IR::Opcode::FSwizzleAdd:
+    case IR::Opcode::DPdxFine:
+    case IR::Opcode::DPdyFine:
+    case IR::Opcode::DPdxCoarse:
+    case IR::Opcode::DPdyCoarse:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool IsCommutative(IR::Opcode opcode) {
+    switch (opcode) {
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::IAdd64:
+    case IR::Opcode::IMul32:
+    case IR::Opcode::BitwiseAnd32:
+    case IR::Opcode::BitwiseOr32:
+    case IR::Opcode::BitwiseXor32:
+    case IR::Opcode::SMin32:
+    case IR::Opcode::UMin32:
+    case IR::Opcode::SMax32:
+    case IR::Opcode::UMax32:
+    case IR::Opcode::IEqual:
+    case IR::Opcode::INotEqual:
+    case IR::Opcode::LogicalAnd:
+    case IR::Opcode::LogicalOr:
+    case IR::Opcode::LogicalXor:
+        return true;
+    default:
+        return false;
+    }
+}
+
+ValueKey MakeKey(IR::Inst& inst) {
+    ValueKey key{
+        .opcode = inst.GetOpcode(),
+        .flags = inst.Flags<u32>(),
+    };
+    const size_t num_args{inst.NumArgs()};
+    for (size_t index = 0; index < num_args; ++index) {
+        key.args[index] = inst.Arg(index);
+    }
+    if (IsCommutative(key.opcode) && HashValue(key.args[1]) < HashValue(key.args[0])) {
+        std::swap(key.args[0], key.args[1]);
+    }
+    return key;
+}
+
+using BlockIdMap = std::unordered_map<const IR::Block*, size_t, std::hash<const IR::Block*>,
+                                      std::equal_to<const IR::Block*>,
+                                      ArenaAllocator<std::pair<const IR::Block* const, size_t>>>;
+using ValueTable = std::unordered_map<ValueKey, IR::Inst*, ValueKeyHash, std::equal_to<ValueKey>,
+                                      ArenaAllocator<std::pair<const ValueKey, IR::Inst*>>>;
+
+/// Cooper, Harvey and Kennedy's iterative dominator algorithm over the reverse post order
+std::vector<size_t> ImmediateDominators(std::span<IR::Block* const> rpo, const BlockIdMap& ids) {
+    static constexpr size_t UNDEFINED{~size_t{0}};
+    std::vector<size_t> idom(rpo.size(), UNDEFINED);
+    idom[0] = 0;
+    const auto intersect{[&](size_t lhs, size_t rhs) {
+        while (lhs != rhs) {
+            while (lhs > rhs) {
+                lhs = idom[lhs];
+            }
+            while (rhs > lhs) {
+                rhs = idom[rhs];
+            }
+        }
+        return lhs;
+    }};
+    bool changed{true};
+    while (changed) {
+        changed = false;
+        for (size_t id = 1; id < rpo.size(); ++id) {
+            size_t new_idom{UNDEFINED};
+            for (const IR::Block* const pred : rpo[id]->ImmPredecessors()) {
+                const auto it{ids.find(pred)};
+                if (it == ids.end() || idom[it->second] == UNDEFINED) {
+                    continue;
+                }
+                new_idom = new_idom == UNDEFINED ? it->second : intersect(it->second, new_idom);
+            }
+            if (new_idom != UNDEFINED && idom[id] != new_idom) {
+                idom[id] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+struct ScopeFrame {
+    size_t block;
+    size_t next_child;
+    size_t table_mark;
+};
+} // Anonymous namespace
+
+void GlobalValueNumberingPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_GlobalValueNumbering);
+
+    if (program.post_order_blocks.empty()) {
+        return;
+    }
+    std::vector<IR::Block*> rpo(program.post_order_blocks.rbegin(),
+                                program.post_order_blocks.rend());
+    // Table entries are erased as scopes close, keep their nodes off the general purpose heap
+    Arena arena;
+    BlockIdMap ids{BlockIdMap::allocator_type{arena}};
+    ids.reserve(rpo.size());
+    for (size_t id = 0; id < rpo.size(); ++id) {
+        ids.emplace(rpo[id], id);
+    }
+    const std::vector<size_t> idom{ImmediateDominators(rpo, ids)};
+    std::vector<std::vector<size_t>> children(rpo.size());
+    for (size_t id = 1; id < rpo.size(); ++id) {
+        children[idom[id]].push_back(id);
+    }
+
+    // Walk the dominator tree in pre-order, values are visible while their block is on the stack
+    ValueTable table{ValueTable::allocator_type{arena}};
+    std::vector<const ValueKey*> scope_keys;
+    std::vector<ScopeFrame> stack;
+    size_t num_insts{};
+    size_t num_eliminated{};
+    const auto enter_block{[&](size_t id) {
+        stack.push_back({.block = id, .next_child = 0, .table_mark = scope_keys.size()});
+        for (IR::Inst& inst : rpo[id]->Instructions()) {
+            ++num_insts;
+            const size_t num_args{inst.NumArgs()};
+            for (size_t index = 0; index < num_args; ++index) {
+                const IR::Value arg{inst.Arg(index)};
+                if (arg.IsIdentity()) {
+                    inst.SetArg(index, arg.Resolve());
+                }
+            }
+            if (!IsValueNumberable(inst)) {
+                continue;
+            }
+            const auto [it, is_new]{table.try_emplace(MakeKey(inst), &inst)};
+            if (is_new) {
+                scope_keys.push_back(&it->first);
+            } else {
+                inst.ReplaceUsesWith(IR::Value{it->second});
+                ++num_eliminated;
+            }
+        }
+    }};
+    enter_block(0);
+    while (!stack.empty()) {
+        ScopeFrame& frame{stack.back()};
+        if (frame.next_child < children[frame.block].size()) {
+            enter_block(children[frame.block][frame.next_child++]);
+            continue;
+        }
+        while (scope_keys.size() > frame.table_mark) {
+            const ValueKey key{*scope_keys.back()};
+            table.erase(key);
+            scope_keys.pop_back();
+        }
+        stack.pop_back();
+    }
+    LOG_DEBUG(Shader, "Eliminated {} of {} instructions", num_eliminated, num_insts);
+}
+
+} // namespace Shader::Optimization
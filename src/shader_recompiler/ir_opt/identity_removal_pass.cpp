@@ -3,13 +3,18 @@
 
 #include <vector>
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_IdentityRemoval, "Shader", "Identity Removal", MP_RGB(224, 224, 160));
+
 namespace Shader::Optimization {
 
 void IdentityRemovalPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_IdentityRemoval);
+
     std::vector<IR::Inst*> to_invalidate;
     for (IR::Block* const block : program.blocks) {
         for (auto inst = block->begin(); inst != block->end();) {
@@ -7,6 +7,7 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include "common/microprofile.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/breadth_first_search.h"
@@ -15,6 +16,8 @@
 #include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/shader_info.h"
 
+MICROPROFILE_DEFINE(Shader_Layer, "Shader", "Layer", MP_RGB(128, 224, 224));
+
 namespace Shader::Optimization {
 
 static IR::Attribute EmulatedLayerAttribute(VaryingState& stores) {
@@ -39,6 +42,8 @@ static bool PermittedProgramStage(Stage stage) {
 }
 
 void LayerPass(IR::Program& program, const HostTranslateInfo& host_info) {
+    MICROPROFILE_SCOPE(Shader_Layer);
+
     if (host_info.support_viewport_index_layer || !PermittedProgramStage(program.stage)) {
         return;
     }
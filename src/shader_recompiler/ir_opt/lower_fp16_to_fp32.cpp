@@ -1,9 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_LowerFp16ToFp32, "Shader", "Lower FP16 to FP32", MP_RGB(224, 160, 255));
+
 namespace Shader::Optimization {
 namespace {
 IR::Opcode Replace(IR::Opcode op) {
@@ -129,6 +132,8 @@ IR::Opcode Replace(IR::Opcode op) {
 } // Anonymous namespace
 
 void LowerFp16ToFp32(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_LowerFp16ToFp32);
+
     for (IR::Block* const block : program.blocks) {
         for (IR::Inst& inst : block->Instructions()) {
             inst.ReplaceOpcode(Replace(inst.GetOpcode()));
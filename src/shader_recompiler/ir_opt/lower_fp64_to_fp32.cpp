@@ -1,11 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
 #include "shader_recompiler/frontend/ir/opcodes.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_LowerFp64ToFp32, "Shader", "Lower FP64 to FP32", MP_RGB(192, 160, 255));
+
 namespace Shader::Optimization {
 namespace {
 
@@ -175,6 +178,8 @@ void Lower(IR::Block& block, IR::Inst& inst) {
 } // Anonymous namespace
 
 void LowerFp64ToFp32(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_LowerFp64ToFp32);
+
     for (IR::Block* const block : program.blocks) {
         for (IR::Inst& inst : block->Instructions()) {
             Lower(*block, inst);
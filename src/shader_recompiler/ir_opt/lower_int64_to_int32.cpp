@@ -3,6 +3,7 @@
 
 #include <utility>
 
+#include "common/microprofile.h"
 #include "shader_recompiler/exception.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
@@ -10,6 +11,9 @@
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_LowerInt64ToInt32, "Shader", "Lower Int64 to Int32",
+                    MP_RGB(160, 128, 255));
+
 namespace Shader::Optimization {
 namespace {
 std::pair<IR::U32, IR::U32> Unpack(IR::IREmitter& ir, const IR::Value& packed) {
@@ -225,6 +229,8 @@ void Lower(IR::Block& block, IR::Inst& inst) {
 } // Anonymous namespace
 
 void LowerInt64ToInt32(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_LowerInt64ToInt32);
+
     const auto end{program.post_order_blocks.rend()};
     for (auto it = program.post_order_blocks.rbegin(); it != end; ++it) {
         IR::Block* const block{*it};
@@ -3,11 +3,14 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_Position, "Shader", "Position", MP_RGB(128, 160, 192));
+
 namespace Shader::Optimization {
 
 namespace {
@@ -20,6 +23,8 @@ using PositionInstVector = boost::container::small_vector<PositionInst, 24>;
 } // Anonymous namespace
 
 void PositionPass(Environment& env, IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_Position);
+
     if (env.ShaderStage() != Stage::VertexB || env.ReadViewportTransformState()) {
         return;
     }
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "common/settings.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
@@ -10,6 +11,8 @@
 #include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/shader_info.h"
 
+MICROPROFILE_DEFINE(Shader_Rescaling, "Shader", "Rescaling", MP_RGB(255, 160, 192));
+
 namespace Shader::Optimization {
 namespace {
 [[nodiscard]] bool IsTextureTypeRescalable(TextureType type) {
@@ -337,6 +340,8 @@ void Visit(const IR::Program& program, IR::Block& block, IR::Inst& inst) {
 } // Anonymous namespace
 
 void RescalingPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_Rescaling);
+
     const bool is_fragment_shader{program.stage == Stage::Fragment};
     if (is_fragment_shader) {
         for (IR::Block* const block : program.post_order_blocks) {
@@ -17,9 +17,15 @@
 #include <map>
 #include <span>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include <boost/container/small_vector.hpp>
+
+#include "common/microprofile.h"
+#include "shader_recompiler/arena.h"
+
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/opcodes.h"
 #include "shader_recompiler/frontend/ir/pred.h"
@@ -27,6 +33,8 @@
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_SsaRewrite, "Shader", "SSA Rewrite", MP_RGB(64, 192, 128));
+
 namespace Shader::Optimization {
 namespace {
 struct FlagTag {
@@ -52,9 +60,29 @@ struct IndirectBranchVariable {
 
 using Variant = std::variant<IR::Reg, IR::Pred, ZeroFlagTag, SignFlagTag, CarryFlagTag,
                              OverflowFlagTag, GotoVariable, IndirectBranchVariable>;
-using ValueMap = std::unordered_map<IR::Block*, IR::Value>;
+template <typename Key, typename Value>
+using ArenaMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>,
+                                    ArenaAllocator<std::pair<const Key, Value>>>;
+using ValueMap = ArenaMap<IR::Block*, IR::Value>;
+using PhiMap = std::map<Variant, IR::Inst*, std::less<Variant>,
+                        ArenaAllocator<std::pair<const Variant, IR::Inst*>>>;
+
+template <size_t... indices>
+std::array<ValueMap, sizeof...(indices)> MakeValueMaps(Arena& arena,
+                                                       std::index_sequence<indices...>) {
+    return {((void)indices, ValueMap(ValueMap::allocator_type{arena}))...};
+}
 
 struct DefTable {
+    explicit DefTable(Arena& arena_)
+        : arena{arena_},
+          preds{MakeValueMaps(arena, std::make_index_sequence<IR::NUM_USER_PREDS>{})},
+          goto_vars(decltype(goto_vars)::allocator_type{arena}),
+          indirect_branch_var(ValueMap::allocator_type{arena}),
+          zero_flag(ValueMap::allocator_type{arena}), sign_flag(ValueMap::allocator_type{arena}),
+          carry_flag(ValueMap::allocator_type{arena}),
+          overflow_flag(ValueMap::allocator_type{arena}) {}
+
     const IR::Value& Def(IR::Block* block, IR::Reg variable) {
         return block->SsaRegValue(variable);
     }
@@ -70,10 +98,10 @@ struct DefTable {
     }
 
     const IR::Value& Def(IR::Block* block, GotoVariable variable) {
-        return goto_vars[variable.index][block];
+        return GotoVars(variable.index)[block];
     }
     void SetDef(IR::Block* block, GotoVariable variable, const IR::Value& value) {
-        goto_vars[variable.index].insert_or_assign(block, value);
+        GotoVars(variable.index).insert_or_assign(block, value);
     }
 
     const IR::Value& Def(IR::Block* block, IndirectBranchVariable) {
@@ -111,8 +139,13 @@ struct DefTable {
         overflow_flag.insert_or_assign(block, value);
     }
 
+    ValueMap& GotoVars(u32 index) {
+        return goto_vars.try_emplace(index, ValueMap::allocator_type{arena}).first->second;
+    }
+
+    Arena& arena;
     std::array<ValueMap, IR::NUM_USER_PREDS> preds;
-    std::unordered_map<u32, ValueMap> goto_vars;
+    ArenaMap<u32, ValueMap> goto_vars;
     ValueMap indirect_branch_var;
     ValueMap zero_flag;
     ValueMap sign_flag;
@@ -158,6 +191,10 @@ struct ReadState {
 
 class Pass {
 public:
+    explicit Pass(Arena& arena_)
+        : arena{arena_}, incomplete_phis(decltype(incomplete_phis)::allocator_type{arena}),
+          current_def{arena} {}
+
     template <typename Type>
     void WriteVariable(Type variable, IR::Block* block, const IR::Value& value) {
         current_def.SetDef(block, variable, value);
@@ -165,10 +202,12 @@ public:
 
     template <typename Type>
     IR::Value ReadVariable(Type variable, IR::Block* root_block) {
-        boost::container::small_vector<ReadState<Type>, 64> stack{
-            ReadState<Type>(nullptr),
-            ReadState<Type>(root_block),
-        };
+        // Deep reads spill the stack into the arena instead of the heap
+        using Stack =
+            boost::container::small_vector<ReadState<Type>, 64, ArenaAllocator<ReadState<Type>>>;
+        Stack stack(typename Stack::allocator_type{ArenaAllocator<ReadState<Type>>{arena}});
+        stack.emplace_back(nullptr);
+        stack.emplace_back(root_block);
         const auto prepare_phi_operand{[&] {
             if (stack.back().pred_it == stack.back().pred_end) {
                 IR::Inst* const phi{stack.back().phi};
@@ -194,7 +233,8 @@ public:
                     IR::Inst* phi{&*block->PrependNewInst(block->begin(), IR::Opcode::Phi)};
                     phi->SetFlags(IR::TypeOf(UndefOpcode(variable)));
 
-                    incomplete_phis[block].insert_or_assign(variable, phi);
+                    incomplete_phis.try_emplace(block, PhiMap::allocator_type{arena})
+                        .first->second.insert_or_assign(variable, phi);
                     stack.back().result = IR::Value{&*phi};
                 } else if (const std::span imm_preds = block->ImmPredecessors();
                            imm_preds.size() == 1) {
@@ -295,7 +335,8 @@ private:
         return same;
     }
 
-    std::unordered_map<IR::Block*, std::map<Variant, IR::Inst*>> incomplete_phis;
+    Arena& arena;
+    ArenaMap<IR::Block*, PhiMap> incomplete_phis;
     DefTable current_def;
 };
 
@@ -391,7 +432,10 @@ IR::Type GetConcreteType(IR::Inst* inst) {
 } // Anonymous namespace
 
 void SsaRewritePass(IR::Program& program) {
-    Pass pass;
+    MICROPROFILE_SCOPE(Shader_SsaRewrite);
+
+    Arena arena;
+    Pass pass{arena};
     const auto end{program.post_order_blocks.rend()};
     for (auto block = program.post_order_blocks.rbegin(); block != end; ++block) {
         VisitBlock(pass, *block);
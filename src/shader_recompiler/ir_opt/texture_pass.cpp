@@ -7,6 +7,7 @@
 
 #include <boost/container/small_vector.hpp>
 
+#include "common/microprofile.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/breadth_first_search.h"
@@ -15,6 +16,8 @@
 #include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/shader_info.h"
 
+MICROPROFILE_DEFINE(Shader_Texture, "Shader", "Texture", MP_RGB(255, 128, 64));
+
 namespace Shader::Optimization {
 namespace {
 struct ConstBufferAddr {
@@ -523,6 +526,8 @@ void PatchTexelFetch(IR::Block& block, IR::Inst& inst, TexturePixelFormat pixel_
 } // Anonymous namespace
 
 void TexturePass(Environment& env, IR::Program& program, const HostTranslateInfo& host_info) {
+    MICROPROFILE_SCOPE(Shader_Texture);
+
     TextureInstVector to_replace;
     for (IR::Block* const block : program.post_order_blocks) {
         for (IR::Inst& inst : block->Instructions()) {
@@ -1,11 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/microprofile.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/ir_emitter.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_VendorWorkaround, "Shader", "Vendor Workaround", MP_RGB(192, 192, 128));
+
 namespace Shader::Optimization {
 
 namespace {
@@ -63,6 +66,8 @@ void AddingByteSwapsWorkaround(IR::Block& block, IR::Inst& inst) {
 } // Anonymous namespace
 
 void VendorWorkaroundPass(IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_VendorWorkaround);
+
     for (IR::Block* const block : program.post_order_blocks) {
         for (IR::Inst& inst : block->Instructions()) {
             switch (inst.GetOpcode()) {
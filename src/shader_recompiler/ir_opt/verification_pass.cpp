@@ -1,14 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <functional>
 #include <map>
 #include <set>
+#include <utility>
 
+#include "common/microprofile.h"
+#include "shader_recompiler/arena.h"
 #include "shader_recompiler/exception.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
 
+MICROPROFILE_DEFINE(Shader_Verification, "Shader", "Verification", MP_RGB(160, 160, 160));
+
 namespace Shader::Optimization {
 
 static void ValidateTypes(const IR::Program& program) {
@@ -30,8 +36,10 @@ static void ValidateTypes(const IR::Program& program) {
     }
 }
 
-static void ValidateUses(const IR::Program& program) {
-    std::map<IR::Inst*, int> actual_uses;
+static void ValidateUses(const IR::Program& program, Arena& arena) {
+    using UseMap = std::map<IR::Inst*, int, std::less<IR::Inst*>,
+                            ArenaAllocator<std::pair<IR::Inst* const, int>>>;
+    UseMap actual_uses{UseMap::allocator_type{arena}};
     for (const auto& block : program.blocks) {
         for (const IR::Inst& inst : *block) {
             const size_t num_args{inst.NumArgs()};
@@ -50,8 +58,10 @@ static void ValidateUses(const IR::Program& program) {
     }
 }
 
-static void ValidateForwardDeclarations(const IR::Program& program) {
-    std::set<const IR::Inst*> definitions;
+static void ValidateForwardDeclarations(const IR::Program& program, Arena& arena) {
+    using DefinitionSet =
+        std::set<const IR::Inst*, std::less<const IR::Inst*>, ArenaAllocator<const IR::Inst*>>;
+    DefinitionSet definitions{DefinitionSet::allocator_type{arena}};
     for (const IR::Block* const block : program.blocks) {
         for (const IR::Inst& inst : *block) {
             definitions.emplace(&inst);
@@ -88,9 +98,13 @@ static void ValidatePhiNodes(const IR::Program& program) {
 }
 
 void VerificationPass(const IR::Program& program) {
+    MICROPROFILE_SCOPE(Shader_Verification);
+
+    // Both maps hold one node per instruction, allocate them from a single arena
+    Arena arena;
     ValidateTypes(program);
-    ValidateUses(program);
-    ValidateForwardDeclarations(program);
+    ValidateUses(program, arena);
+    ValidateForwardDeclarations(program, arena);
     ValidatePhiNodes(program);
 }
 
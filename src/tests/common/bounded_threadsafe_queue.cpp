@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/bounded_threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("LockFreeMPSCQueue: Positions follow pop order", "[common]") {
+    LockFreeMPSCQueue<std::size_t, 8> queue;
+    std::stop_source stop_source;
+    for (std::size_t i = 0; i < 8; i++) {
+        REQUIRE(queue.EmplaceWait(i * 2) == i);
+    }
+    std::size_t value{};
+    for (std::size_t i = 0; i < 8; i++) {
+        queue.PopWait(value, stop_source.get_token());
+        REQUIRE(value == i * 2);
+    }
+    REQUIRE(!queue.TryPop(value));
+}
+
+TEST_CASE("LockFreeMPSCQueue: Multiple producers", "[common]") {
+    static constexpr std::size_t NumProducers = 4;
+    static constexpr std::size_t NumElements = 0x4000;
+
+    // Small capacity so producers have to wait for the consumer
+    LockFreeMPSCQueue<std::pair<std::size_t, std::size_t>, 16> queue;
+    std::array<std::vector<std::size_t>, NumProducers> positions;
+    std::vector<std::jthread> producers;
+    for (std::size_t producer = 0; producer < NumProducers; producer++) {
+        producers.emplace_back([&queue, &positions, producer] {
+            for (std::size_t i = 0; i < NumElements; i++) {
+                positions[producer].push_back(queue.EmplaceWait(producer, i));
+            }
+        });
+    }
+
+    std::stop_source stop_source;
+    std::array<std::size_t, NumProducers> next_element{};
+    std::vector<std::pair<std::size_t, std::size_t>> popped;
+    for (std::size_t i = 0; i < NumProducers * NumElements; i++) {
+        std::pair<std::size_t, std::size_t> element;
+        queue.PopWait(element, stop_source.get_token());
+        // Elements of each producer keep their order
+        REQUIRE(element.second == next_element[element.first]++);
+        popped.push_back(element);
+    }
+    producers.clear();
+
+    for (std::size_t producer = 0; producer < NumProducers; producer++) {
+        for (std::size_t i = 0; i < NumElements; i++) {
+            REQUIRE(popped[positions[producer][i]] == std::make_pair(producer, i));
+        }
+    }
+}
+
+} // namespace Common
@@ -184,3 +184,21 @@ TEST_CASE("HostMemory: Partial sparse middle unmap and check bindings", "[common
     REQUIRE(ptr[0x0000] == 19);
     REQUIRE(ptr[0x3fff] == 12);
 }
+
+TEST_CASE("HostMemory: Map through another view of the backing", "[common]") {
+    HostMemory mem(BACKING_SIZE, VIRTUAL_SIZE);
+    HostMemory view(mem, 1ULL << 40);
+    REQUIRE(view.BackingBasePointer() == mem.BackingBasePointer());
+    mem.Map(0x5000, 0x3000, 0x1000, PERMS, HEAP);
+    view.Map(0x10000000, 0x2000, 0x2000, PERMS, HEAP);
+
+    volatile u8* const data = mem.VirtualBasePointer() + 0x5000;
+    volatile u8* const view_data = view.VirtualBasePointer() + 0x10000000;
+    data[0x10] = 27;
+    REQUIRE(view_data[0x1010] == 27);
+    view_data[0x20] = 38;
+    REQUIRE(mem.BackingBasePointer()[0x2020] == 38);
+
+    view.Unmap(0x10000000, 0x1000, HEAP);
+    REQUIRE(view_data[0x1010] == 27);
+}
@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/lru_cache.h"
+
+namespace {
+struct Traits {
+    using ObjectType = int;
+    using TickType = u64;
+};
+} // Anonymous namespace
+
+TEST_CASE("LeastRecentlyUsedCache: Iterates items below a tick in use order", "[common]") {
+    Common::LeastRecentlyUsedCache<Traits> cache;
+    const size_t first = cache.Insert(1, 0);
+    cache.Insert(2, 1);
+    cache.Insert(3, 2);
+    cache.Touch(first, 3);
+
+    std::vector<int> items;
+    cache.ForEachItemBelow(2, [&](int item) { items.push_back(item); });
+    REQUIRE(items == std::vector<int>{2, 3});
+}
+
+TEST_CASE("LeastRecentlyUsedCache: Stops when the callback returns true", "[common]") {
+    Common::LeastRecentlyUsedCache<Traits> cache;
+    for (int i = 0; i < 4; ++i) {
+        cache.Insert(i, 0);
+    }
+    std::vector<int> items;
+    cache.ForEachItemBelow(0, [&](int item) {
+        items.push_back(item);
+        return items.size() == 2;
+    });
+    REQUIRE(items == std::vector<int>{0, 1});
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/gpu_dirty_memory_manager.h"
+
+namespace {
+std::vector<std::pair<PAddr, size_t>> GatherRanges(Core::GPUDirtyMemoryManager& manager) {
+    std::vector<std::pair<PAddr, size_t>> ranges;
+    std::function<void(PAddr, size_t)> callback = [&](PAddr address, size_t size) {
+        ranges.emplace_back(address, size);
+    };
+    manager.Gather(callback);
+    return ranges;
+}
+} // Anonymous namespace
+
+TEST_CASE("GPUDirtyMemoryManager: Collect within a page", "[core]") {
+    Core::GPUDirtyMemoryManager manager;
+    manager.Collect(0x10040, 0x40);
+    manager.Collect(0x10080, 0x40);
+    const auto ranges = GatherRanges(manager);
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(ranges[0].first == 0x10040);
+    REQUIRE(ranges[0].second == 0x80);
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Collect across pages", "[core]") {
+    Core::GPUDirtyMemoryManager manager;
+    manager.Collect(0x10400, 0x1000);
+    const auto ranges = GatherRanges(manager);
+    REQUIRE(ranges.size() == 1);
+    REQUIRE(ranges[0].first == 0x10400);
+    REQUIRE(ranges[0].second == 0x1000);
+}
+
+TEST_CASE("GPUDirtyMemoryManager: Gather keeps separate ranges apart", "[core]") {
+    Core::GPUDirtyMemoryManager manager;
+    manager.Collect(0x10000, 0x40);
+    manager.Collect(0x10100, 0x40);
+    manager.Collect(0x20000, 0x40);
+    const auto ranges = GatherRanges(manager);
+    REQUIRE(ranges.size() == 3);
+    REQUIRE(ranges[0].first == 0x10000);
+    REQUIRE(ranges[1].first == 0x10100);
+    REQUIRE(ranges[2].first == 0x20000);
+    REQUIRE(GatherRanges(manager).empty());
+}
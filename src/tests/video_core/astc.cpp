@@ -0,0 +1,264 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/textures/astc.h"
+
+namespace {
+using Tegra::Texture::ASTC::Decompress;
+using Tegra::Texture::ASTC::DecompressBlock;
+
+using Block = std::array<u8, 16>;
+using Texels = std::array<u32, 12 * 12>;
+
+struct Footprint {
+    u32 width;
+    u32 height;
+    /// Hash of the texels decoded from the blocks of ASTC[random_blocks], see HashTexels
+    u64 golden_hash;
+};
+
+constexpr Footprint FOOTPRINTS[]{
+    {4, 4, 0x517857F20E9FCFCD},   {5, 4, 0xE76817E5E73E4088},   {5, 5, 0x5C0274DB00F07BC7},
+    {6, 5, 0x8512B14D8246F869},   {6, 6, 0x03F9D93A9F9557E8},   {8, 5, 0xDCA82BB7110A43E7},
+    {8, 6, 0xE623156B2D9C7591},   {8, 8, 0xB16C8B14C2E497B7},   {10, 5, 0x679FB6956651DE05},
+    {10, 6, 0xBCA89FBC19ED2274},  {10, 8, 0x63D2519BEDF44DDB},  {10, 10, 0x1105A4C84C4721D7},
+    {12, 10, 0xFE6F049F005B5651}, {12, 12, 0x1A737CC83529889C},
+};
+
+/// Color endpoint modes the decoder supports, HDR modes are rejected
+constexpr u32 LDR_ENDPOINT_MODES[]{0, 1, 4, 5, 6, 8, 9, 10, 12, 13};
+
+class Random {
+public:
+    u32 Next() {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    }
+
+    u32 Next(u32 bound) {
+        return Next() % bound;
+    }
+
+private:
+    u32 state = 0xdeadbeef;
+};
+
+void SetBits(Block& block, u32 offset, u32 count, u32 value) {
+    for (u32 bit = 0; bit < count; ++bit) {
+        const u32 position = offset + bit;
+        const u8 mask = static_cast<u8>(1U << (position % 8));
+        if ((value >> bit) & 1) {
+            block[position / 8] |= mask;
+        } else {
+            block[position / 8] &= static_cast<u8>(~mask);
+        }
+    }
+}
+
+/// Builds a random block that fits every footprint: a weight grid of at most 3x4 with up to four
+/// weight levels, LDR endpoints with enough bits left for the smallest endpoint range and random
+/// endpoint and weight data
+Block MakeBlock(Random& random) {
+    for (;;) {
+        Block block;
+        for (u8& value : block) {
+            value = static_cast<u8>(random.Next());
+        }
+        const u32 num_partitions = random.Next(4) + 1;
+        const bool dual_plane = num_partitions < 4 && random.Next(2) == 0;
+        const u32 range = random.Next(3) + 2;
+        const u32 grid_a = random.Next(3);
+        const u32 grid_b = random.Next(2);
+        const u32 endpoint_mode = LDR_ENDPOINT_MODES[random.Next(std::size(LDR_ENDPOINT_MODES))];
+
+        // At most two bits per weight, and at least three bits per endpoint value
+        const u32 num_weights = (grid_a + 2) * (grid_b + 2) * (dual_plane ? 2 : 1);
+        const u32 header_bits = num_partitions == 1 ? 17 : 29;
+        const u32 color_bits = 128 - header_bits - num_weights * 2 - (dual_plane ? 2 : 0);
+        const u32 num_values = num_partitions * ((endpoint_mode >> 2) + 1) * 2;
+        if (num_values * 3 > color_bits) {
+            continue;
+        }
+
+        // Block mode with the low bits, bit 2, bit 3 and bit 8 set: a (B + 2) x (A + 2) grid
+        u32 mode = (range >> 1) | (1U << 2) | (1U << 3) | ((range & 1) << 4);
+        mode |= (grid_a << 5) | (grid_b << 7) | (1U << 8) | ((dual_plane ? 1U : 0U) << 10);
+        SetBits(block, 0, 11, mode);
+        SetBits(block, 11, 2, num_partitions - 1);
+
+        if (num_partitions == 1) {
+            SetBits(block, 13, 4, endpoint_mode);
+        } else {
+            // Shared endpoint mode, the partition index before it stays random
+            SetBits(block, 23, 6, endpoint_mode << 2);
+        }
+        return block;
+    }
+}
+
+/// FNV-1a over the texels of a block
+u64 HashTexels(u64 hash, std::span<const u32> texels) {
+    for (const u32 texel : texels) {
+        for (u32 byte = 0; byte < 4; ++byte) {
+            hash = (hash ^ ((texel >> (byte * 8)) & 0xFF)) * 0x100000001B3ULL;
+        }
+    }
+    return hash;
+}
+
+constexpr u64 HASH_SEED = 0xCBF29CE484222325ULL;
+
+} // Anonymous namespace
+
+TEST_CASE("ASTC[random_blocks]", "[video_core]") {
+    // The hashes were taken from the previous decoder, which read the block one bit at a time and
+    // interpolated each channel in double precision
+    std::array<u64, std::size(FOOTPRINTS)> hashes;
+    hashes.fill(HASH_SEED);
+    Random random;
+    for (u32 iteration = 0; iteration < 2000; ++iteration) {
+        const Block block = MakeBlock(random);
+        for (size_t index = 0; index < std::size(FOOTPRINTS); ++index) {
+            const Footprint& footprint = FOOTPRINTS[index];
+            Texels texels{};
+            DecompressBlock(block, footprint.width, footprint.height, texels);
+            const u32 num_texels = footprint.width * footprint.height;
+            hashes[index] = HashTexels(hashes[index], std::span(texels).first(num_texels));
+        }
+    }
+    for (size_t index = 0; index < std::size(FOOTPRINTS); ++index) {
+        const Footprint& footprint = FOOTPRINTS[index];
+        INFO("Footprint " << footprint.width << "x" << footprint.height);
+        REQUIRE(hashes[index] == footprint.golden_hash);
+    }
+}
+
+TEST_CASE("ASTC[void_extent]", "[video_core]") {
+    Random random;
+    for (u32 iteration = 0; iteration < 64; ++iteration) {
+        Block block{};
+        // LDR void extent with its reserved bits and all extent coordinates set, followed by a
+        // random color. Each channel is stored with 16 bits and decoded to its top byte.
+        SetBits(block, 0, 12, 0xDFC);
+        SetBits(block, 12, 32, 0xFFFFFFFF);
+        SetBits(block, 44, 20, 0xFFFFF);
+        u32 expected = 0;
+        for (u32 channel = 0; channel < 4; ++channel) {
+            const u32 value = random.Next(0x10000);
+            SetBits(block, 64 + channel * 16, 16, value);
+            expected |= (value >> 8) << (channel * 8);
+        }
+        for (const Footprint& footprint : FOOTPRINTS) {
+            Texels texels{};
+            DecompressBlock(block, footprint.width, footprint.height, texels);
+            const u32 num_texels = footprint.width * footprint.height;
+            for (u32 i = 0; i < num_texels; ++i) {
+                INFO("Footprint " << footprint.width << "x" << footprint.height << ", texel "
+                                  << i);
+                REQUIRE(texels[i] == expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("ASTC[decompress]", "[video_core]") {
+    static constexpr u32 WIDTH = 61;
+    static constexpr u32 HEIGHT = 37;
+    static constexpr u32 DEPTH = 2;
+
+    Random random;
+    for (const Footprint& footprint : FOOTPRINTS) {
+        const u32 cols = (WIDTH + footprint.width - 1) / footprint.width;
+        const u32 rows = (HEIGHT + footprint.height - 1) / footprint.height;
+        std::vector<Block> blocks(cols * rows * DEPTH);
+        for (Block& block : blocks) {
+            block = MakeBlock(random);
+        }
+        std::vector<u8> input(blocks.size() * sizeof(Block));
+        std::memcpy(input.data(), blocks.data(), input.size());
+
+        std::vector<u8> output(WIDTH * HEIGHT * DEPTH * 4);
+        Decompress(input, WIDTH, HEIGHT, DEPTH, footprint.width, footprint.height, output);
+
+        for (u32 z = 0; z < DEPTH; ++z) {
+            for (u32 y = 0; y < HEIGHT; ++y) {
+                for (u32 x = 0; x < WIDTH; ++x) {
+                    const u32 block_x = x / footprint.width;
+                    const u32 block_y = y / footprint.height;
+                    const Block& block = blocks[(z * rows + block_y) * cols + block_x];
+                    Texels reference{};
+                    DecompressBlock(block, footprint.width, footprint.height, reference);
+
+                    const u32 texel = (y % footprint.height) * footprint.width +
+                                      x % footprint.width;
+                    u32 value;
+                    std::memcpy(&value, output.data() + ((z * HEIGHT + y) * WIDTH + x) * 4,
+                                sizeof(value));
+                    INFO("Footprint " << footprint.width << "x" << footprint.height << ", texel "
+                                      << x << "," << y << "," << z);
+                    REQUIRE(value == reference[texel]);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("ASTC[empty]", "[video_core]") {
+    const std::vector<u8> input(sizeof(Block));
+    std::vector<u8> output(64);
+    for (const Footprint& footprint : FOOTPRINTS) {
+        Decompress(input, 0, 4, 1, footprint.width, footprint.height, output);
+        Decompress(input, 4, 0, 1, footprint.width, footprint.height, output);
+        Decompress(input, 4, 4, 0, footprint.width, footprint.height, output);
+    }
+    REQUIRE(std::ranges::all_of(output, [](u8 value) { return value == 0; }));
+}
+
+TEST_CASE("ASTC[benchmark]", "[video_core][.benchmark]") {
+    static constexpr u32 WIDTH = 1024;
+    static constexpr u32 HEIGHT = 1024;
+    static constexpr u32 NUM_RUNS = 4;
+
+    Random random;
+    std::vector<u8> output(WIDTH * HEIGHT * 4);
+    for (const Footprint& footprint : FOOTPRINTS) {
+        const u32 cols = (WIDTH + footprint.width - 1) / footprint.width;
+        const u32 rows = (HEIGHT + footprint.height - 1) / footprint.height;
+        std::vector<u8> input(cols * rows * sizeof(Block));
+        for (size_t offset = 0; offset < input.size(); offset += sizeof(Block)) {
+            const Block block = MakeBlock(random);
+            std::memcpy(input.data() + offset, block.data(), sizeof(Block));
+        }
+        const auto decode = [&] {
+            Decompress(input, WIDTH, HEIGHT, 1, footprint.width, footprint.height, output);
+            return output[0];
+        };
+        const std::string name =
+            std::to_string(footprint.width) + "x" + std::to_string(footprint.height);
+        BENCHMARK("ASTC " + name) {
+            return decode();
+        };
+
+        // Throughput in decoded RGBA8 texels, each run decodes 4 MiB
+        const auto start = std::chrono::steady_clock::now();
+        for (u32 run = 0; run < NUM_RUNS; ++run) {
+            decode();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        const double megabytes = static_cast<double>(output.size()) * NUM_RUNS / 1e6;
+        WARN("ASTC " << name << ": " << megabytes / elapsed.count() << " MB/s");
+    }
+}
@@ -0,0 +1,190 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <vector>
+
+#include <bc_decoder.h>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "video_core/surface.h"
+#include "video_core/texture_cache/decode_bc.h"
+
+namespace {
+using VideoCore::Surface::PixelFormat;
+using VideoCommon::BufferImageCopy;
+
+struct Extent {
+    u32 width;
+    u32 height;
+    u32 layers;
+};
+
+constexpr Extent EXTENTS[]{
+    {4, 4, 1}, {1, 1, 1}, {13, 7, 1}, {64, 64, 1}, {256, 128, 1}, {257, 130, 1}, {128, 64, 6},
+};
+
+std::vector<u8> MakePattern(size_t size) {
+    std::vector<u8> data(size);
+    u32 state = 0xdeadbeef;
+    for (u8& value : data) {
+        state = state * 1664525 + 1013904223;
+        value = static_cast<u8>(state >> 24);
+    }
+    return data;
+}
+
+/// Makes blocks of a single mode by replacing the low bits of their first byte
+std::vector<u8> MakeBlocks(size_t num_blocks, u32 block_size, u8 mode_mask, u8 mode_bits) {
+    std::vector<u8> data = MakePattern(num_blocks * block_size);
+    for (size_t offset = 0; offset < data.size(); offset += block_size) {
+        data[offset] = static_cast<u8>((data[offset] & ~mode_mask) | mode_bits);
+    }
+    return data;
+}
+
+/// BC7 modes are selected by the position of the lowest set bit
+u8 Bc7ModeMask(u32 mode) {
+    return static_cast<u8>((2U << mode) - 1);
+}
+
+BufferImageCopy MakeCopy(const Extent& extent) {
+    return BufferImageCopy{
+        .buffer_offset = 0,
+        .buffer_size = 0,
+        .buffer_row_length = Common::AlignUp(extent.width, 4U),
+        .buffer_image_height = Common::AlignUp(extent.height, 4U),
+        .image_subresource{
+            .base_level = 0,
+            .base_layer = 0,
+            .num_layers = static_cast<s32>(extent.layers),
+        },
+        .image_offset{},
+        .image_extent{extent.width, extent.height, 1},
+    };
+}
+
+/// Decodes the image one block at a time, in the same layout as DecompressBCn
+template <typename Func>
+std::vector<u8> ReferenceDecode(std::span<const u8> input, const Extent& extent, u32 block_size,
+                                u32 out_bpp, Func&& decode) {
+    const u32 width = extent.width;
+    const u32 height = extent.height * extent.layers;
+    const u32 block_width = std::min(width, 4U);
+    const u32 block_height = std::min(height, 4U);
+    std::vector<u8> output(width * height * out_bpp);
+    size_t input_offset = 0;
+    size_t output_offset = 0;
+    for (u32 y = 0; y < height; y += block_height) {
+        size_t src_offset = input_offset;
+        size_t dst_offset = output_offset;
+        for (u32 x = 0; x < width; x += block_width) {
+            decode(input.data() + src_offset, output.data() + dst_offset, x, y, width, height);
+            src_offset += block_size;
+            dst_offset += block_width * out_bpp;
+        }
+        input_offset += Common::AlignUp(width, 4U) * block_size / block_width;
+        output_offset += block_height * width * out_bpp;
+    }
+    return output;
+}
+
+template <typename Func>
+void CheckFormat(PixelFormat format, u32 block_size, Func&& decode, u8 mode_mask = 0,
+                 u8 mode_bits = 0) {
+    const u32 out_bpp = VideoCommon::ConvertedBytesPerBlock(format);
+    for (const Extent& extent : EXTENTS) {
+        const size_t num_blocks = Common::DivideUp(extent.width, 4U) *
+                                  Common::DivideUp(extent.height * extent.layers, 4U);
+        const std::vector<u8> input = MakeBlocks(num_blocks, block_size, mode_mask, mode_bits);
+        const std::vector<u8> expected =
+            ReferenceDecode(input, extent, block_size, out_bpp, decode);
+
+        std::vector<u8> output(expected.size());
+        BufferImageCopy copy = MakeCopy(extent);
+        VideoCommon::DecompressBCn(input, output, copy, format);
+        REQUIRE(output == expected);
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("DecodeBC: Matches block by block decoding", "[video_core]") {
+    CheckFormat(PixelFormat::BC1_RGBA_UNORM, 8, bcn::DecodeBc1);
+    CheckFormat(PixelFormat::BC3_UNORM, 16, bcn::DecodeBc3);
+    CheckFormat(PixelFormat::BC4_SNORM, 8,
+                [](const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+                    bcn::DecodeBc4(src, dst, x, y, width, height, true);
+                });
+    CheckFormat(PixelFormat::BC5_UNORM, 16,
+                [](const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+                    bcn::DecodeBc5(src, dst, x, y, width, height, false);
+                });
+    CheckFormat(PixelFormat::BC6H_UFLOAT, 16,
+                [](const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+                    bcn::DecodeBc6(src, dst, x, y, width, height, false);
+                });
+    CheckFormat(PixelFormat::BC7_UNORM, 16, bcn::DecodeBc7);
+}
+
+TEST_CASE("DecodeBC: Mode specialized paths match the reference decoder", "[video_core]") {
+    for (const u32 mode : {4U, 5U, 6U}) {
+        CheckFormat(PixelFormat::BC7_UNORM, 16, bcn::DecodeBc7, Bc7ModeMask(mode),
+                    static_cast<u8>(1U << mode));
+    }
+    for (const u8 mode : {0x03, 0x07, 0x0B, 0x0F}) {
+        CheckFormat(PixelFormat::BC6H_UFLOAT, 16,
+                    [](const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+                        bcn::DecodeBc6(src, dst, x, y, width, height, false);
+                    },
+                    0x1F, mode);
+        CheckFormat(PixelFormat::BC6H_SFLOAT, 16,
+                    [](const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+                        bcn::DecodeBc6(src, dst, x, y, width, height, true);
+                    },
+                    0x1F, mode);
+    }
+}
+
+TEST_CASE("DecodeBC: Benchmark", "[video_core][.benchmark]") {
+    constexpr Extent extent{2048, 2048, 1};
+    constexpr size_t num_blocks = (extent.width / 4) * (extent.height / 4);
+    const BufferImageCopy copy = MakeCopy(extent);
+    std::vector<u8> output(size_t{extent.width} * extent.height * 8);
+
+    const auto run = [&](PixelFormat format, const std::vector<u8>& input) {
+        BufferImageCopy image_copy = copy;
+        VideoCommon::DecompressBCn(input, output, image_copy, format);
+        return output[0];
+    };
+    const std::vector<u8> bc7_mode_6 = MakeBlocks(num_blocks, 16, Bc7ModeMask(6), 1U << 6);
+    const std::vector<u8> bc7_mode_5 = MakeBlocks(num_blocks, 16, Bc7ModeMask(5), 1U << 5);
+    const std::vector<u8> bc7_mixed = MakePattern(num_blocks * 16);
+    const std::vector<u8> bc6h_mode_11 = MakeBlocks(num_blocks, 16, 0x1F, 0x07);
+
+    // Each benchmark decodes 4 MiB of blocks into 16 MiB of RGBA8 or 32 MiB of RGBA16F texels
+    BENCHMARK("BC7 mode 6 reference") {
+        return ReferenceDecode(bc7_mode_6, extent, 16, 4, bcn::DecodeBc7)[0];
+    };
+    BENCHMARK("BC7 mode 6") {
+        return run(PixelFormat::BC7_UNORM, bc7_mode_6);
+    };
+    BENCHMARK("BC7 mode 5") {
+        return run(PixelFormat::BC7_UNORM, bc7_mode_5);
+    };
+    BENCHMARK("BC7 mixed modes") {
+        return run(PixelFormat::BC7_UNORM, bc7_mixed);
+    };
+    BENCHMARK("BC6H mode 11 reference") {
+        return ReferenceDecode(bc6h_mode_11, extent, 16, 8,
+                               [](const u8* src, u8* dst, size_t x, size_t y, size_t width,
+                                  size_t height) {
+                                   bcn::DecodeBc6(src, dst, x, y, width, height, false);
+                               })[0];
+    };
+    BENCHMARK("BC6H mode 11") {
+        return run(PixelFormat::BC6H_UFLOAT, bc6h_mode_11);
+    };
+}
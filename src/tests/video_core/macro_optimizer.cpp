@@ -0,0 +1,546 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/core.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/macro/macro.h"
+#include "video_core/macro/macro_hle.h"
+#include "video_core/macro/macro_interpreter.h"
+#include "video_core/macro/macro_optimizer.h"
+#include "video_core/macro/macro_threaded_interpreter.h"
+#include "video_core/memory_manager.h"
+
+namespace {
+using Tegra::Engines::Maxwell3D;
+using namespace Tegra::Macro;
+
+constexpr u32 CB_DATA_METHOD = MAXWELL3D_REG_INDEX(const_buffer.buffer);
+
+/// Scratch registers have no side effects, random macros only read and send to them
+constexpr u32 SCRATCH_METHOD = MAXWELL3D_REG_INDEX(shadow_scratch);
+constexpr u32 NUM_SCRATCH = 0x100;
+/// Registers are sent here on exit, past the methods the random bodies can reach
+constexpr u32 EPILOGUE_METHOD = SCRATCH_METHOD + 0xF0;
+
+u32 AddImmediate(u32 dst, u32 src_a, s32 immediate,
+                 ResultOperation result = ResultOperation::Move, bool is_exit = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::AddImmediate);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(immediate);
+    opcode.is_exit.Assign(is_exit ? 1 : 0);
+    return opcode.raw;
+}
+
+u32 Add(u32 dst, u32 src_a, u32 src_b, ResultOperation result = ResultOperation::Move,
+        bool is_exit = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::ALU);
+    opcode.alu_operation.Assign(ALUOperation::Add);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    opcode.is_exit.Assign(is_exit ? 1 : 0);
+    return opcode.raw;
+}
+
+u32 And(u32 dst, u32 src_a, u32 src_b) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::ALU);
+    opcode.alu_operation.Assign(ALUOperation::And);
+    opcode.result_operation.Assign(ResultOperation::Move);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    return opcode.raw;
+}
+
+u32 BranchNotZero(u32 src_a, s32 offset) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Branch);
+    opcode.branch_condition.Assign(BranchCondition::NotZero);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(offset);
+    return opcode.raw;
+}
+
+u32 BranchZero(u32 src_a, s32 offset, bool annul = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Branch);
+    opcode.branch_condition.Assign(BranchCondition::Zero);
+    opcode.branch_annul.Assign(annul ? 1 : 0);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(offset);
+    return opcode.raw;
+}
+
+u32 Nop(bool is_exit = false) {
+    return AddImmediate(0, 0, 0, ResultOperation::Move, is_exit);
+}
+
+u32 SetMethod(u32 method, u32 increment) {
+    return AddImmediate(0, 0, static_cast<s32>(method | (increment << 12)),
+                        ResultOperation::MoveAndSetMethod);
+}
+
+class Random {
+public:
+    u32 Next() {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    }
+
+    u32 Next(u32 bound) {
+        return Next() % bound;
+    }
+
+private:
+    u32 state = 0x1234567;
+};
+
+/// Builds an instruction that doesn't branch, change the method address or fetch parameters
+u32 RandomInstruction(Random& random, ResultOperation result) {
+    Opcode opcode{};
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(random.Next(8));
+    opcode.src_a.Assign(random.Next(8));
+    switch (random.Next(6)) {
+    case 0: {
+        static constexpr std::array ALU_OPERATIONS{
+            ALUOperation::Add, ALUOperation::AddWithCarry, ALUOperation::Subtract,
+            ALUOperation::SubtractWithBorrow, ALUOperation::Xor, ALUOperation::Or,
+            ALUOperation::And, ALUOperation::AndNot, ALUOperation::Nand,
+        };
+        opcode.operation.Assign(Operation::ALU);
+        opcode.alu_operation.Assign(ALU_OPERATIONS[random.Next(ALU_OPERATIONS.size())]);
+        opcode.src_b.Assign(random.Next(8));
+        break;
+    }
+    case 1:
+        opcode.operation.Assign(Operation::AddImmediate);
+        opcode.immediate.Assign(static_cast<s32>(random.Next(0x40000)) - 0x20000);
+        break;
+    case 2:
+    case 3:
+    case 4:
+        opcode.operation.Assign(static_cast<Operation>(random.Next(3) + 2));
+        opcode.src_b.Assign(random.Next(8));
+        opcode.bf_src_bit.Assign(random.Next(32));
+        opcode.bf_size.Assign(random.Next(32));
+        opcode.bf_dst_bit.Assign(random.Next(32));
+        break;
+    default:
+        // Reads through the zero register, so the address is always a scratch register
+        opcode.operation.Assign(Operation::Read);
+        opcode.src_a.Assign(0);
+        opcode.immediate.Assign(static_cast<s32>(SCRATCH_METHOD + random.Next(NUM_SCRATCH)));
+        break;
+    }
+    return opcode.raw;
+}
+
+/// Random macro made of a straight line prologue that fetches all parameters, a body with
+/// forward branches and an epilogue sending all registers
+std::vector<u32> MakeMacro(Random& random, u32& num_parameters) {
+    std::vector<u32> code;
+    num_parameters = 1;
+    code.push_back(SetMethod(SCRATCH_METHOD, 1));
+    const u32 prologue_size{random.Next(8)};
+    for (u32 i = 0; i < prologue_size; ++i) {
+        const bool send{random.Next(2) == 0};
+        code.push_back(RandomInstruction(
+            random, send ? ResultOperation::FetchAndSend : ResultOperation::IgnoreAndFetch));
+        ++num_parameters;
+    }
+    static constexpr std::array BODY_RESULTS{
+        ResultOperation::Move,
+        ResultOperation::Move,
+        ResultOperation::MoveAndSend,
+    };
+    const size_t body_begin{code.size()};
+    const size_t body_size{random.Next(24) + 1};
+    const size_t epilogue_begin{body_begin + body_size};
+    for (size_t pc = body_begin; pc < epilogue_begin; ++pc) {
+        const u32 kind{random.Next(8)};
+        // Branches can't sit in the delay slot of another branch
+        const bool after_branch{pc > body_begin && Opcode{code.back()}.operation ==
+                                                       Operation::Branch};
+        if (kind == 0 && !after_branch) {
+            Opcode opcode{};
+            opcode.operation.Assign(Operation::Branch);
+            opcode.branch_condition.Assign(static_cast<BranchCondition>(random.Next(2)));
+            opcode.branch_annul.Assign(random.Next(2));
+            opcode.src_a.Assign(random.Next(8));
+            const size_t target{pc + 1 + random.Next(static_cast<u32>(epilogue_begin - pc))};
+            opcode.immediate.Assign(static_cast<s32>(target - pc));
+            code.push_back(opcode.raw);
+        } else if (kind == 1) {
+            // Sends stay within the first half of the scratch registers
+            code.push_back(SetMethod(SCRATCH_METHOD + random.Next(NUM_SCRATCH / 4),
+                                     random.Next(2)));
+        } else {
+            code.push_back(RandomInstruction(random, BODY_RESULTS[random.Next(3)]));
+        }
+    }
+    code.push_back(SetMethod(EPILOGUE_METHOD, 1));
+    for (u32 reg = 1; reg < NUM_MACRO_REGISTERS; ++reg) {
+        code.push_back(Add(0, reg, 0, ResultOperation::MoveAndSend,
+                           reg == NUM_MACRO_REGISTERS - 1));
+    }
+    code.push_back(Nop());
+    return code;
+}
+
+/// Maxwell3D instance that runs macros on a given macro engine
+template <typename Engine>
+struct MacroRunner {
+    explicit MacroRunner(Core::System& system, Tegra::MemoryManager& memory_manager)
+        : maxwell3d{system, memory_manager}, engine{maxwell3d} {}
+
+    Maxwell3D maxwell3d;
+    Engine engine;
+};
+} // Anonymous namespace
+
+TEST_CASE("MacroOptimizer: Folds parameter independent code", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(2, 0, 5),
+        AddImmediate(3, 2, 3),
+        Add(4, 2, 3, ResultOperation::MoveAndSend),
+        Add(5, 1, 2, ResultOperation::MoveAndSend),
+        Nop(true),
+        Nop(),
+    };
+    const MacroAnalysis analysis{AnalyzeMacro(code)};
+    REQUIRE(analysis.instructions[0].constant == 5U);
+    REQUIRE(analysis.instructions[1].constant == 8U);
+    REQUIRE(analysis.instructions[2].constant == 13U);
+    // Depends on the first parameter
+    REQUIRE(!analysis.instructions[3].constant);
+
+    REQUIRE(!analysis.instructions[0].dead_store);
+    REQUIRE(analysis.instructions[2].dead_store);
+    REQUIRE(!analysis.instructions[2].is_nop);
+    REQUIRE(analysis.instructions[4].is_nop);
+    REQUIRE(analysis.instructions[5].is_nop);
+}
+
+TEST_CASE("MacroOptimizer: Removes overwritten register writes", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(2, 1, 1),
+        AddImmediate(2, 1, 2),
+        Add(0, 2, 0, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    const MacroAnalysis analysis{AnalyzeMacro(code)};
+    REQUIRE(analysis.instructions[0].dead_store);
+    REQUIRE(analysis.instructions[0].is_nop);
+    REQUIRE(!analysis.instructions[1].dead_store);
+    REQUIRE(!analysis.instructions[1].is_nop);
+}
+
+TEST_CASE("MacroOptimizer: Follows loops and delay slots", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(2, 0, 3),
+        AddImmediate(2, 2, -1),
+        BranchNotZero(2, -1),
+        AddImmediate(3, 0, 7),
+        Add(0, 3, 0, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    const MacroAnalysis analysis{AnalyzeMacro(code)};
+    REQUIRE(analysis.has_delayed_branch);
+    // The loop counter changes on each iteration
+    REQUIRE(!analysis.instructions[1].constant);
+    REQUIRE(!analysis.instructions[2].constant);
+    REQUIRE(!analysis.instructions[1].dead_store);
+    // The delay slot value reaches the send on every path
+    REQUIRE(!analysis.instructions[3].dead_store);
+    REQUIRE(analysis.instructions[4].constant == 7U);
+}
+
+TEST_CASE("MacroOptimizer: Detects batchable sends", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(0, 0, static_cast<s32>(CB_DATA_METHOD), ResultOperation::MoveAndSetMethod),
+        Add(2, 0, 0, ResultOperation::FetchAndSend),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        AddImmediate(0, 0, static_cast<s32>(CB_DATA_METHOD | (1U << 12)),
+                     ResultOperation::MoveAndSetMethod),
+        Add(0, 1, 0, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    const MacroAnalysis analysis{AnalyzeMacro(code)};
+    REQUIRE(analysis.instructions[1].batchable_send);
+    REQUIRE(analysis.instructions[2].batchable_send);
+    // Incrementing sends call a different method each time
+    REQUIRE(!analysis.instructions[4].batchable_send);
+    REQUIRE(analysis.num_batchable_sends == 2);
+}
+
+TEST_CASE("MacroOptimizer: Matches register writes", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(0, 0, 0x100 | (1 << 12), ResultOperation::MoveAndSetMethod),
+        Add(2, 1, 0, ResultOperation::FetchAndSend),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        AddImmediate(0, 0, 42, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    const auto program{MatchRegisterWrites(code)};
+    REQUIRE(program);
+    REQUIRE(program->num_parameters == 2);
+    REQUIRE(program->writes.size() == 3);
+    REQUIRE((program->writes[0].method == 0x100 && program->writes[0].is_parameter &&
+             program->writes[0].value == 0));
+    REQUIRE((program->writes[1].method == 0x101 && program->writes[1].is_parameter &&
+             program->writes[1].value == 1));
+    REQUIRE((program->writes[2].method == 0x102 && !program->writes[2].is_parameter &&
+             program->writes[2].value == 42));
+
+    // Sends of values computed from parameters can't be expressed as fixed writes
+    const std::vector<u32> computed{
+        AddImmediate(0, 0, 0x100, ResultOperation::MoveAndSetMethod),
+        AddImmediate(0, 1, 1, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    REQUIRE(!MatchRegisterWrites(computed));
+
+    // Branches may depend on parameters
+    const std::vector<u32> branching{
+        BranchNotZero(1, 2),
+        Nop(),
+        Add(0, 1, 0, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    REQUIRE(!MatchRegisterWrites(branching));
+}
+
+/// Uploads the words after the count in its first parameter to consecutive registers, fetching
+/// each word before the loop branch and sending it from the delay slot
+std::vector<u32> MakeUploadLoop(u32 method, u32 increment) {
+    return {
+        SetMethod(method, increment),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        AddImmediate(1, 1, -1),
+        BranchNotZero(1, -2),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        Nop(true),
+        Nop(),
+    };
+}
+
+TEST_CASE("MacroOptimizer: Matches register write loops", "[video_core]") {
+    const auto upload{MatchRegisterWriteLoop(MakeUploadLoop(SCRATCH_METHOD, 1))};
+    REQUIRE(upload);
+    REQUIRE(upload->count_parameter == 0);
+    // A zero count wraps around the loop counter
+    REQUIRE(upload->min_count == 1);
+    REQUIRE(upload->count_bias == 0);
+    REQUIRE(upload->prologue.empty());
+    REQUIRE(upload->epilogue.empty());
+    REQUIRE(upload->iteration.size() == 1);
+    REQUIRE(upload->iteration[0].write == MacroWrite{SCRATCH_METHOD, 1, true});
+    REQUIRE(upload->iteration[0].method_step == 1);
+    REQUIRE(upload->iteration[0].value_step == 1);
+    REQUIRE(upload->num_parameters == 1);
+    REQUIRE(upload->parameter_step == 1);
+
+    // Count in the second parameter, checked before each iteration, with writes around the loop
+    const std::vector<u32> bounded{
+        SetMethod(SCRATCH_METHOD, 0),
+        Add(0, 1, 0, ResultOperation::MoveAndSend),
+        Add(3, 0, 0, ResultOperation::IgnoreAndFetch),
+        SetMethod(SCRATCH_METHOD + 1, 1),
+        BranchZero(3, 5, true),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        AddImmediate(3, 3, -1),
+        BranchZero(0, -4, true),
+        AddImmediate(0, 0, 7, ResultOperation::MoveAndSend, true),
+        Nop(),
+    };
+    const auto program{MatchRegisterWriteLoop(bounded)};
+    REQUIRE(program);
+    REQUIRE(program->count_parameter == 1);
+    REQUIRE(program->min_count == 0);
+    REQUIRE(program->prologue == std::vector<MacroWrite>{{SCRATCH_METHOD, 0, true}});
+    REQUIRE(program->iteration.size() == 1);
+    REQUIRE(program->iteration[0].write == MacroWrite{SCRATCH_METHOD + 1, 2, true});
+    // The constant after the loop goes to the register after the last uploaded one
+    REQUIRE(program->epilogue.size() == 1);
+    REQUIRE(program->epilogue[0].write == MacroWrite{SCRATCH_METHOD + 1, 7, false});
+    REQUIRE(program->epilogue[0].method_step == 1);
+    REQUIRE(program->epilogue[0].value_step == 0);
+    REQUIRE(program->num_parameters == 2);
+
+    // Loops over bits of the count only look linear for small counts
+    const std::vector<u32> masked{
+        SetMethod(SCRATCH_METHOD, 1),
+        AddImmediate(4, 0, 0xF),
+        And(3, 1, 4),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        AddImmediate(3, 3, -1),
+        BranchNotZero(3, -2),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        Nop(true),
+        Nop(),
+    };
+    REQUIRE(!MatchRegisterWriteLoop(masked));
+
+    // A special path for a count that is not sampled, here eight
+    const std::vector<u32> special_count{
+        SetMethod(SCRATCH_METHOD, 1),
+        AddImmediate(3, 1, -8),
+        BranchZero(3, 2, true),
+        SetMethod(SCRATCH_METHOD + 0x40, 1),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        AddImmediate(1, 1, -1),
+        BranchNotZero(1, -2),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        Nop(true),
+        Nop(),
+    };
+    REQUIRE(!MatchRegisterWriteLoop(special_count));
+
+    // A second counter that skips the send on the thirtieth iteration, past the sampled counts
+    const std::vector<u32> late_branch{
+        SetMethod(SCRATCH_METHOD, 1),
+        AddImmediate(4, 0, -30),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        AddImmediate(4, 4, 1),
+        BranchZero(4, 2, true),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        AddImmediate(1, 1, -1),
+        BranchNotZero(1, -5),
+        Nop(),
+        Nop(true),
+        Nop(),
+    };
+    REQUIRE(!MatchRegisterWriteLoop(late_branch));
+}
+
+TEST_CASE("MacroOptimizer: Matches draw loops", "[video_core]") {
+    constexpr u32 DRAW_BEGIN = MAXWELL3D_REG_INDEX(draw.begin);
+    constexpr u32 DRAW_END = MAXWELL3D_REG_INDEX(draw.end);
+    constexpr u32 VERTEX_FIRST = MAXWELL3D_REG_INDEX(vertex_buffer.first);
+    constexpr u32 DRAW_ID = SCRATCH_METHOD;
+    // Draws as many inline (first, count) pairs as the first parameter says, with the topology in
+    // the second parameter. The draw index is sent to a scratch register before each draw.
+    const std::vector<u32> code{
+        Add(4, 0, 0, ResultOperation::IgnoreAndFetch),
+        AddImmediate(5, 0, 0),
+        BranchZero(1, 12, true),
+        AddImmediate(0, 0, static_cast<s32>(VERTEX_FIRST | (1 << 12)),
+                     ResultOperation::MoveAndSetMethodFetchAndSend),
+        Add(2, 0, 0, ResultOperation::IgnoreAndFetch),
+        Add(0, 2, 0, ResultOperation::MoveAndSend),
+        SetMethod(DRAW_ID, 0),
+        Add(0, 5, 0, ResultOperation::MoveAndSend),
+        SetMethod(DRAW_BEGIN, 0),
+        Add(0, 4, 0, ResultOperation::MoveAndSend),
+        AddImmediate(5, 5, 1),
+        AddImmediate(1, 1, -1),
+        AddImmediate(0, 0, static_cast<s32>(DRAW_END), ResultOperation::MoveAndSetMethodSend),
+        BranchZero(0, -11, true),
+        Nop(true),
+        Nop(),
+    };
+    const auto program{MatchRegisterWriteLoop(code)};
+    REQUIRE(program);
+    REQUIRE(program->count_parameter == 0);
+    REQUIRE(program->parameter_step == 2);
+    REQUIRE(program->iteration.size() == 5);
+    REQUIRE(std::ranges::any_of(program->iteration, [&](const LoopWrite& write) {
+        return IsDrawMethod(write.write.method);
+    }));
+    // The topology is the same parameter on every iteration, the draw index counts up
+    REQUIRE(program->iteration[3].write == MacroWrite{DRAW_BEGIN, 1, true});
+    REQUIRE(program->iteration[3].value_step == 0);
+    REQUIRE(program->iteration[2].write == MacroWrite{DRAW_ID, 0, false});
+    REQUIRE(program->iteration[2].value_step == 1);
+}
+
+TEST_CASE("MacroOptimizer: Write loop replacements match the interpreter", "[video_core]") {
+    Core::System system;
+    system.Initialize();
+    Tegra::Host1x::Host1x host1x{system};
+    Tegra::MemoryManager memory_manager{system, host1x.MemoryManager()};
+    MacroRunner<Tegra::MacroInterpreter> reference{system, memory_manager};
+    Maxwell3D maxwell3d{system, memory_manager};
+    Tegra::HLEMacro hle{maxwell3d};
+
+    Random random;
+    u32 position{};
+    for (const u32 increment : {0U, 1U, 3U}) {
+        const std::vector<u32> code{MakeUploadLoop(SCRATCH_METHOD, increment)};
+        const auto program{hle.GetHLEProgram(0, code)};
+        REQUIRE(program);
+        for (const u32 count : {1U, 2U, 7U, 40U}) {
+            std::vector<u32> parameters{count};
+            for (u32 i = 0; i < count; ++i) {
+                parameters.push_back(random.Next());
+            }
+            // Each run uploads to its own macro position, so no compiled macro is reused
+            for (const u32 word : code) {
+                reference.engine.AddCode(position, word);
+            }
+            reference.engine.Execute(position++, parameters);
+            program->Execute(parameters, 0);
+
+            for (u32 method = SCRATCH_METHOD; method < SCRATCH_METHOD + NUM_SCRATCH; ++method) {
+                INFO("Increment " << increment << ", count " << count << ", method 0x"
+                                  << std::hex << method);
+                REQUIRE(maxwell3d.GetRegisterValue(method) ==
+                        reference.maxwell3d.GetRegisterValue(method));
+            }
+        }
+    }
+}
+
+TEST_CASE("MacroOptimizer: Threaded interpreter matches the reference interpreter",
+          "[video_core]") {
+    Core::System system;
+    system.Initialize();
+    Tegra::Host1x::Host1x host1x{system};
+    Tegra::MemoryManager memory_manager{system, host1x.MemoryManager()};
+    MacroRunner<Tegra::MacroInterpreter> reference{system, memory_manager};
+    MacroRunner<Tegra::MacroThreadedInterpreter> threaded{system, memory_manager};
+
+    Random random;
+    for (u32 iteration = 0; iteration < 2000; ++iteration) {
+        u32 num_parameters{};
+        const std::vector<u32> code{MakeMacro(random, num_parameters)};
+        std::vector<u32> parameters(num_parameters);
+        for (u32& parameter : parameters) {
+            parameter = random.Next(4) == 0 ? 0 : random.Next();
+        }
+        for (u32 method = SCRATCH_METHOD; method < SCRATCH_METHOD + NUM_SCRATCH; ++method) {
+            const u32 value{random.Next(4) == 0 ? 0 : random.Next()};
+            reference.maxwell3d.CallMethod(method, value, true);
+            threaded.maxwell3d.CallMethod(method, value, true);
+        }
+        // Each iteration uploads to its own macro position, so no compiled macro is reused
+        for (const u32 word : code) {
+            reference.engine.AddCode(iteration, word);
+            threaded.engine.AddCode(iteration, word);
+        }
+        reference.engine.Execute(iteration, parameters);
+        threaded.engine.Execute(iteration, parameters);
+
+        for (u32 method = SCRATCH_METHOD; method < SCRATCH_METHOD + NUM_SCRATCH; ++method) {
+            INFO("Iteration " << iteration << ", method 0x" << std::hex << method);
+            REQUIRE(threaded.maxwell3d.GetRegisterValue(method) ==
+                    reference.maxwell3d.GetRegisterValue(method));
+        }
+    }
+}
@@ -4,7 +4,9 @@
 #include <memory>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/alignment.h"
@@ -21,6 +23,8 @@ constexpr u64 HIGH_PAGE_SIZE = 1ULL << HIGH_PAGE_BITS;
 
 constexpr VAddr c = 16 * HIGH_PAGE_SIZE;
 
+constexpr u64 LARGE_SIZE = 512ULL << 20;
+
 class RasterizerInterface {
 public:
     void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {
@@ -546,3 +550,85 @@ TEST_CASE("MemoryTracker: Cached write downloads") {
     memory_track->MarkRegionAsCpuModified(c, WORD);
     REQUIRE(rasterizer.Count() == 0);
 }
+
+TEST_CASE("MemoryTracker: Sparse modifications in a large region", "[video_core]") {
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    memory_track->UnmarkRegionAsCpuModified(c, LARGE_SIZE);
+    REQUIRE(!memory_track->IsRegionCpuModified(c, LARGE_SIZE));
+    REQUIRE(!memory_track->IsRegionGpuModified(c, LARGE_SIZE));
+
+    const std::vector<Range> writes{
+        {c + PAGE * 3, c + PAGE * 5},
+        {c + HIGH_PAGE_SIZE * 40 - PAGE, c + HIGH_PAGE_SIZE * 40 + PAGE},
+        {c + LARGE_SIZE - PAGE, c + LARGE_SIZE},
+    };
+    for (const auto& [begin, end] : writes) {
+        memory_track->MarkRegionAsGpuModified(begin, end - begin);
+    }
+    REQUIRE(memory_track->ModifiedGpuRegion(c, LARGE_SIZE) == Range{c + PAGE * 3, c + LARGE_SIZE});
+    REQUIRE(memory_track->IsRegionGpuModified(c + HIGH_PAGE_SIZE * 40, PAGE));
+    REQUIRE(!memory_track->IsRegionGpuModified(c + HIGH_PAGE_SIZE * 41, HIGH_PAGE_SIZE * 80));
+
+    // Ranges are split at region boundaries
+    int num = 0;
+    memory_track->ForEachDownloadRangeAndClear(c, LARGE_SIZE, [&](u64 offset, u64 size) { ++num; });
+    REQUIRE(num == 4);
+    REQUIRE(!memory_track->IsRegionGpuModified(c, LARGE_SIZE));
+    REQUIRE(memory_track->ModifiedGpuRegion(c, LARGE_SIZE) == Range{0, 0});
+
+    for (const auto& [begin, end] : writes) {
+        memory_track->MarkRegionAsCpuModified(begin, end - begin);
+    }
+    REQUIRE(memory_track->ModifiedCpuRegion(c, LARGE_SIZE) == Range{c + PAGE * 3, c + LARGE_SIZE});
+    std::vector<Range> uploads;
+    memory_track->ForEachUploadRange(c, LARGE_SIZE, [&](u64 offset, u64 size) {
+        uploads.emplace_back(offset, offset + size);
+    });
+    REQUIRE(uploads == std::vector<Range>{
+                           writes[0],
+                           {c + HIGH_PAGE_SIZE * 40 - PAGE, c + HIGH_PAGE_SIZE * 40},
+                           {c + HIGH_PAGE_SIZE * 40, c + HIGH_PAGE_SIZE * 40 + PAGE},
+                           writes[2],
+                       });
+    REQUIRE(!memory_track->IsRegionCpuModified(c, LARGE_SIZE));
+
+    memory_track->MarkRegionAsCpuModified(c, LARGE_SIZE);
+    REQUIRE(rasterizer.Count() == 0);
+}
+
+TEST_CASE("MemoryTracker: Untracked regions are created as CPU modified", "[video_core]") {
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    memory_track->UnmarkRegionAsCpuModified(c, HIGH_PAGE_SIZE);
+    REQUIRE(!memory_track->IsRegionCpuModified(c, HIGH_PAGE_SIZE));
+    REQUIRE(memory_track->IsRegionCpuModified(c, HIGH_PAGE_SIZE * 3));
+    REQUIRE(memory_track->ModifiedCpuRegion(c, HIGH_PAGE_SIZE * 3) ==
+            Range{c + HIGH_PAGE_SIZE, c + HIGH_PAGE_SIZE * 3});
+}
+
+TEST_CASE("MemoryTracker: Large region queries", "[video_core][.benchmark]") {
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    memory_track->UnmarkRegionAsCpuModified(c, LARGE_SIZE);
+    memory_track->MarkRegionAsGpuModified(c + HIGH_PAGE_SIZE * 100, PAGE);
+
+    BENCHMARK("Clean region CPU query") {
+        return memory_track->IsRegionCpuModified(c, LARGE_SIZE);
+    };
+    BENCHMARK("Sparse GPU download ranges") {
+        u64 total = 0;
+        memory_track->ForEachDownloadRange(c, LARGE_SIZE, false,
+                                           [&](u64 offset, u64 size) { total += size; });
+        return total;
+    };
+    BENCHMARK("Sparse upload after CPU write") {
+        memory_track->MarkRegionAsCpuModified(c + HIGH_PAGE_SIZE * 60, PAGE);
+        u64 total = 0;
+        memory_track->ForEachUploadRange(c, LARGE_SIZE, [&](u64 offset, u64 size) {
+            total += size;
+        });
+        return total;
+    };
+    memory_track->MarkRegionAsCpuModified(c, LARGE_SIZE);
+}
@@ -0,0 +1,224 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/surface.h"
+#include "video_core/texture_cache/types.h"
+#include "video_core/texture_cache/util.h"
+
+namespace {
+using namespace VideoCore::Surface;
+using VideoCommon::FindFormatConversion;
+using VideoCommon::FormatConversion;
+using VideoCommon::ImageCopy;
+
+constexpr u32 IMAGE_WIDTH = 32;
+constexpr u32 IMAGE_HEIGHT = 16;
+constexpr u32 IMAGE_LAYERS = 4;
+
+class Random {
+public:
+    u32 Next() {
+        state = state * 1664525 + 1013904223;
+        return state >> 8;
+    }
+
+    u32 Next(u32 bound) {
+        return Next() % bound;
+    }
+
+private:
+    u32 state = 0xc0ffee;
+};
+
+size_t TexelOffset(u32 x, u32 y, u32 layer, u32 bytes_per_block) {
+    return ((static_cast<size_t>(layer) * IMAGE_HEIGHT + y) * IMAGE_WIDTH + x) * bytes_per_block;
+}
+
+ImageCopy MakeCopy(Random& random) {
+    const u32 width = random.Next(IMAGE_WIDTH) + 1;
+    const u32 height = random.Next(IMAGE_HEIGHT) + 1;
+    const u32 num_layers = random.Next(IMAGE_LAYERS) + 1;
+    const auto make_layers = [&] {
+        return VideoCommon::SubresourceLayers{
+            .base_level = 0,
+            .base_layer = static_cast<s32>(random.Next(IMAGE_LAYERS - num_layers + 1)),
+            .num_layers = static_cast<s32>(num_layers),
+        };
+    };
+    const auto make_offset = [&] {
+        return VideoCommon::Offset3D{
+            .x = static_cast<s32>(random.Next(IMAGE_WIDTH - width + 1)),
+            .y = static_cast<s32>(random.Next(IMAGE_HEIGHT - height + 1)),
+            .z = 0,
+        };
+    };
+    return ImageCopy{
+        .src_subresource = make_layers(),
+        .dst_subresource = make_layers(),
+        .src_offset = make_offset(),
+        .dst_offset = make_offset(),
+        .extent = {width, height, 1},
+    };
+}
+
+/// Runs the buffer round trip of a reinterpretation on the CPU. Every copy is read into the
+/// staging buffer before any is written to the destination, like the GPU path does.
+void ReinterpretThroughBuffer(std::span<const u8> src, std::span<u8> dst,
+                              std::span<const ImageCopy> copies, u32 bytes_per_block) {
+    std::vector<size_t> offsets(copies.size());
+    std::vector<u8> buffer(
+        VideoCommon::MakeReinterpretBufferOffsets(copies, bytes_per_block, offsets));
+    const auto for_each_texel = [&](const ImageCopy& copy, auto&& func) {
+        size_t buffer_offset = 0;
+        for (s32 layer = 0; layer < copy.dst_subresource.num_layers; ++layer) {
+            for (u32 y = 0; y < copy.extent.height; ++y) {
+                for (u32 x = 0; x < copy.extent.width; ++x) {
+                    func(layer, x, y, buffer_offset);
+                    buffer_offset += bytes_per_block;
+                }
+            }
+        }
+    };
+    for (size_t i = 0; i < copies.size(); ++i) {
+        const ImageCopy& copy = copies[i];
+        for_each_texel(copy, [&](s32 layer, u32 x, u32 y, size_t buffer_offset) {
+            const size_t src_offset =
+                TexelOffset(copy.src_offset.x + x, copy.src_offset.y + y,
+                            copy.src_subresource.base_layer + layer, bytes_per_block);
+            std::memcpy(buffer.data() + offsets[i] + buffer_offset, src.data() + src_offset,
+                        bytes_per_block);
+        });
+    }
+    for (size_t i = 0; i < copies.size(); ++i) {
+        const ImageCopy& copy = copies[i];
+        for_each_texel(copy, [&](s32 layer, u32 x, u32 y, size_t buffer_offset) {
+            const size_t dst_offset =
+                TexelOffset(copy.dst_offset.x + x, copy.dst_offset.y + y,
+                            copy.dst_subresource.base_layer + layer, bytes_per_block);
+            std::memcpy(dst.data() + dst_offset, buffer.data() + offsets[i] + buffer_offset,
+                        bytes_per_block);
+        });
+    }
+}
+
+/// Copies the texels of each copy straight from the source to the destination
+void ReinterpretReference(std::span<const u8> src, std::span<u8> dst,
+                          std::span<const ImageCopy> copies, u32 bytes_per_block) {
+    for (const ImageCopy& copy : copies) {
+        for (s32 layer = 0; layer < copy.dst_subresource.num_layers; ++layer) {
+            for (u32 y = 0; y < copy.extent.height; ++y) {
+                for (u32 x = 0; x < copy.extent.width; ++x) {
+                    const size_t src_offset =
+                        TexelOffset(copy.src_offset.x + x, copy.src_offset.y + y,
+                                    copy.src_subresource.base_layer + layer, bytes_per_block);
+                    const size_t dst_offset =
+                        TexelOffset(copy.dst_offset.x + x, copy.dst_offset.y + y,
+                                    copy.dst_subresource.base_layer + layer, bytes_per_block);
+                    std::memcpy(dst.data() + dst_offset, src.data() + src_offset,
+                                bytes_per_block);
+                }
+            }
+        }
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("Surface: Reinterpret compatibility of every format pair", "[video_core]") {
+    for (size_t index_a = 0; index_a < MaxPixelFormat; ++index_a) {
+        const auto lhs = static_cast<PixelFormat>(index_a);
+        for (size_t index_b = 0; index_b < MaxPixelFormat; ++index_b) {
+            const auto rhs = static_cast<PixelFormat>(index_b);
+            const bool compatible = IsReinterpretCompatible(lhs, rhs);
+            REQUIRE(compatible == IsReinterpretCompatible(rhs, lhs));
+            if (!compatible) {
+                continue;
+            }
+            REQUIRE(BytesPerBlock(lhs) == BytesPerBlock(rhs));
+            REQUIRE(DefaultBlockWidth(lhs) == 1);
+            REQUIRE(DefaultBlockHeight(lhs) == 1);
+            REQUIRE(GetFormatType(lhs) != SurfaceType::DepthStencil);
+        }
+    }
+}
+
+TEST_CASE("Surface: Reinterpret compatible formats", "[video_core]") {
+    REQUIRE(IsReinterpretCompatible(PixelFormat::D32_FLOAT, PixelFormat::R32_UINT));
+    REQUIRE(IsReinterpretCompatible(PixelFormat::D16_UNORM, PixelFormat::R8G8_UNORM));
+    REQUIRE(IsReinterpretCompatible(PixelFormat::S8_UINT, PixelFormat::R8_UINT));
+    REQUIRE(IsReinterpretCompatible(PixelFormat::X8_D24_UNORM, PixelFormat::A8B8G8R8_UNORM));
+
+    // Depth and stencil are stored in separate aspects
+    REQUIRE(!IsReinterpretCompatible(PixelFormat::D24_UNORM_S8_UINT, PixelFormat::R32_UINT));
+    REQUIRE(!IsReinterpretCompatible(PixelFormat::D32_FLOAT_S8_UINT, PixelFormat::R32G32_UINT));
+    // Compressed blocks cover several texels
+    REQUIRE(!IsReinterpretCompatible(PixelFormat::BC1_RGBA_UNORM, PixelFormat::R32G32_UINT));
+    REQUIRE(!IsReinterpretCompatible(PixelFormat::D16_UNORM, PixelFormat::R32_FLOAT));
+}
+
+TEST_CASE("Surface: Conversion passes take priority over reinterpretation", "[video_core]") {
+    for (size_t index_a = 0; index_a < MaxPixelFormat; ++index_a) {
+        const auto dst = static_cast<PixelFormat>(index_a);
+        for (size_t index_b = 0; index_b < MaxPixelFormat; ++index_b) {
+            const auto src = static_cast<PixelFormat>(index_b);
+            if (FindFormatConversion(dst, src) == FormatConversion::None) {
+                continue;
+            }
+            // Every conversion pass is between a depth format and a color format of the same size
+            REQUIRE(BytesPerBlock(dst) == BytesPerBlock(src));
+            REQUIRE((GetFormatType(dst) == SurfaceType::ColorTexture) !=
+                    (GetFormatType(src) == SurfaceType::ColorTexture));
+        }
+    }
+    REQUIRE(FindFormatConversion(PixelFormat::D32_FLOAT, PixelFormat::R32_FLOAT) ==
+            FormatConversion::R32ToD32);
+    REQUIRE(FindFormatConversion(PixelFormat::B8G8R8A8_SRGB, PixelFormat::D32_FLOAT) ==
+            FormatConversion::D32FToABGR8);
+    REQUIRE(FindFormatConversion(PixelFormat::D32_FLOAT, PixelFormat::R32_UINT) ==
+            FormatConversion::None);
+}
+
+TEST_CASE("Surface: Reinterpret staging offsets round trip every texel", "[video_core]") {
+    static constexpr std::array<u32, 5> BYTES_PER_BLOCK{1, 2, 4, 8, 16};
+    Random random;
+    for (u32 iteration = 0; iteration < 200; ++iteration) {
+        const u32 bytes_per_block = BYTES_PER_BLOCK[random.Next(BYTES_PER_BLOCK.size())];
+        const size_t image_size = TexelOffset(0, 0, IMAGE_LAYERS, bytes_per_block);
+        std::vector<u8> src(image_size);
+        std::vector<u8> dst(image_size);
+        for (size_t i = 0; i < image_size; ++i) {
+            src[i] = static_cast<u8>(random.Next());
+            dst[i] = static_cast<u8>(random.Next());
+        }
+        std::vector<ImageCopy> copies(random.Next(6) + 1);
+        for (ImageCopy& copy : copies) {
+            copy = MakeCopy(random);
+        }
+
+        std::vector<size_t> offsets(copies.size());
+        const size_t buffer_size =
+            VideoCommon::MakeReinterpretBufferOffsets(copies, bytes_per_block, offsets);
+        for (size_t i = 0; i < copies.size(); ++i) {
+            REQUIRE(offsets[i] % std::max(bytes_per_block, 4U) == 0);
+            const size_t end = i + 1 < copies.size() ? offsets[i + 1] : buffer_size;
+            const ImageCopy& copy = copies[i];
+            REQUIRE(end - offsets[i] >= static_cast<size_t>(copy.extent.width) *
+                                            copy.extent.height *
+                                            static_cast<size_t>(copy.dst_subresource.num_layers) *
+                                            bytes_per_block);
+        }
+
+        std::vector<u8> expected{dst};
+        ReinterpretReference(src, expected, copies, bytes_per_block);
+        ReinterpretThroughBuffer(src, dst, copies, bytes_per_block);
+        REQUIRE(dst == expected);
+    }
+}
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <array>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/textures/decoders.h"
+
+namespace {
+using namespace Tegra::Texture;
+
+struct Layout {
+    u32 bytes_per_pixel;
+    u32 width;
+    u32 height;
+    u32 depth;
+    u32 block_height;
+    u32 block_depth;
+};
+
+constexpr std::array LAYOUTS{
+    Layout{1, 64, 8, 1, 0, 0},    Layout{1, 100, 37, 1, 2, 0},  Layout{2, 33, 17, 1, 1, 0},
+    Layout{4, 256, 64, 1, 4, 0},  Layout{4, 77, 45, 3, 3, 1},   Layout{8, 19, 9, 2, 0, 1},
+    Layout{16, 40, 70, 1, 5, 0},  Layout{16, 5, 3, 4, 1, 2},    Layout{4, 1, 1, 1, 0, 0},
+    Layout{2, 500, 20, 1, 1, 0},  Layout{8, 130, 130, 1, 4, 0}, Layout{1, 7, 200, 1, 5, 0},
+};
+
+constexpr SwizzleTable SWIZZLE_TABLE = MakeSwizzleTable();
+
+/// Byte by byte block linear addressing, used as the reference for the optimized paths
+u32 ReferenceOffset(u32 x, u32 y, u32 z, u32 stride, u32 height, u32 block_height,
+                    u32 block_depth) {
+    const u32 gobs_in_x = Common::DivCeil(stride, GOB_SIZE_X);
+    const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
+    const u32 slice_size = Common::DivCeil(height, GOB_SIZE_Y << block_height) * block_size;
+    const u32 offset_z = (z >> block_depth) * slice_size +
+                         ((z & ((1U << block_depth) - 1)) << (GOB_SIZE_SHIFT + block_height));
+    const u32 block_y = y / GOB_SIZE_Y;
+    const u32 offset_y = (block_y >> block_height) * block_size +
+                         ((block_y & ((1U << block_height) - 1)) << GOB_SIZE_SHIFT);
+    const u32 offset_x = (x / GOB_SIZE_X) << (GOB_SIZE_SHIFT + block_height + block_depth);
+    return offset_z + offset_y + offset_x + SWIZZLE_TABLE[y % GOB_SIZE_Y][x % GOB_SIZE_X];
+}
+
+std::vector<u8> MakePattern(size_t size) {
+    std::vector<u8> data(size);
+    u32 state = 0x12345678;
+    for (u8& value : data) {
+        state = state * 1664525 + 1013904223;
+        value = static_cast<u8>(state >> 24);
+    }
+    return data;
+}
+
+size_t SwizzledSize(const Layout& layout) {
+    return CalculateSize(true, layout.bytes_per_pixel, layout.width, layout.height, layout.depth,
+                         layout.block_height, layout.block_depth);
+}
+} // Anonymous namespace
+
+TEST_CASE("Texture Decoders: Unswizzle matches reference", "[video_core]") {
+    for (const Layout& layout : LAYOUTS) {
+        const u32 pitch = layout.width * layout.bytes_per_pixel;
+        const std::vector<u8> swizzled = MakePattern(SwizzledSize(layout));
+        std::vector<u8> linear(pitch * layout.height * layout.depth);
+        UnswizzleTexture(linear, swizzled, layout.bytes_per_pixel, layout.width, layout.height,
+                         layout.depth, layout.block_height, layout.block_depth);
+
+        std::vector<u8> expected(linear.size());
+        for (u32 z = 0; z < layout.depth; ++z) {
+            for (u32 y = 0; y < layout.height; ++y) {
+                for (u32 x = 0; x < pitch; ++x) {
+                    expected[(z * layout.height + y) * pitch + x] =
+                        swizzled[ReferenceOffset(x, y, z, pitch, layout.height,
+                                                 layout.block_height, layout.block_depth)];
+                }
+            }
+        }
+        REQUIRE(linear == expected);
+    }
+}
+
+TEST_CASE("Texture Decoders: Swizzle matches reference", "[video_core]") {
+    for (const Layout& layout : LAYOUTS) {
+        const u32 pitch = layout.width * layout.bytes_per_pixel;
+        const std::vector<u8> linear = MakePattern(pitch * layout.height * layout.depth);
+        std::vector<u8> swizzled(SwizzledSize(layout));
+        SwizzleTexture(swizzled, linear, layout.bytes_per_pixel, layout.width, layout.height,
+                       layout.depth, layout.block_height, layout.block_depth);
+
+        std::vector<u8> expected(swizzled.size());
+        for (u32 z = 0; z < layout.depth; ++z) {
+            for (u32 y = 0; y < layout.height; ++y) {
+                for (u32 x = 0; x < pitch; ++x) {
+                    expected[ReferenceOffset(x, y, z, pitch, layout.height, layout.block_height,
+                                             layout.block_depth)] =
+                        linear[(z * layout.height + y) * pitch + x];
+                }
+            }
+        }
+        REQUIRE(swizzled == expected);
+
+        std::vector<u8> round_trip(linear.size());
+        UnswizzleTexture(round_trip, swizzled, layout.bytes_per_pixel, layout.width, layout.height,
+                         layout.depth, layout.block_height, layout.block_depth);
+        REQUIRE(round_trip == linear);
+    }
+}
+
+TEST_CASE("Texture Decoders: Subrect copies match reference", "[video_core]") {
+    for (const Layout& layout : LAYOUTS) {
+        if (layout.depth != 1) {
+            continue;
+        }
+        const u32 bpp = layout.bytes_per_pixel;
+        const u32 stride = Common::AlignUp(layout.width * bpp, GOB_SIZE_X);
+        const u32 origin_x = layout.width / 3;
+        const u32 origin_y = layout.height / 4;
+        const u32 extent_x = layout.width - origin_x - layout.width / 5;
+        const u32 extent_y = layout.height - origin_y;
+        const u32 pitch = extent_x * bpp + 3;
+
+        const std::vector<u8> linear = MakePattern(pitch * layout.height);
+        std::vector<u8> swizzled(SwizzledSize(layout));
+        SwizzleSubrect(swizzled, linear, bpp, layout.width, layout.height, 1, origin_x, origin_y,
+                       extent_x, extent_y, layout.block_height, layout.block_depth, pitch);
+
+        std::vector<u8> expected(swizzled.size());
+        for (u32 line = 0; line < extent_y; ++line) {
+            for (u32 x = 0; x < extent_x * bpp; ++x) {
+                expected[ReferenceOffset(origin_x * bpp + x, origin_y + line, 0, stride,
+                                         layout.height, layout.block_height, 0)] =
+                    linear[line * pitch + x];
+            }
+        }
+        REQUIRE(swizzled == expected);
+
+        std::vector<u8> round_trip(linear.size());
+        UnswizzleSubrect(round_trip, swizzled, bpp, layout.width, layout.height, 1, origin_x,
+                         origin_y, extent_x, extent_y, layout.block_height, layout.block_depth,
+                         pitch);
+        for (u32 line = 0; line < extent_y; ++line) {
+            for (u32 x = 0; x < extent_x * bpp; ++x) {
+                REQUIRE(round_trip[line * pitch + x] == linear[line * pitch + x]);
+            }
+        }
+    }
+}
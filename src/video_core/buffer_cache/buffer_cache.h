@@ -169,9 +169,64 @@ std::optional<VideoCore::RasterizerDownloadArea> BufferCache<P>::GetFlushArea(DA
 
 template <class P>
 void BufferCache<P>::DownloadMemory(DAddr device_addr, u64 size) {
-    ForEachBufferInRange(device_addr, size, [&](BufferId, Buffer& buffer) {
-        DownloadBufferMemory(buffer, device_addr, size);
+    if constexpr (!USE_MEMORY_MAPS) {
+        ForEachBufferInRange(device_addr, size, [&](BufferId, Buffer& buffer) {
+            DownloadBufferMemory(buffer, device_addr, size);
+        });
+        return;
+    }
+    // Record the downloads of every buffer in the range, so the GPU is only waited on once
+    boost::container::small_vector<std::pair<BufferCopy, BufferId>, 16> downloads;
+    u64 total_size_bytes = 0;
+    ForEachBufferInRange(device_addr, size, [&](BufferId buffer_id, Buffer& buffer) {
+        const DAddr buffer_addr = buffer.CpuAddr();
+        const DAddr new_start = std::max(buffer_addr, device_addr);
+        const DAddr new_end = std::min(buffer_addr + buffer.SizeBytes(), device_addr + size);
+        memory_tracker.ForEachDownloadRangeAndClear(
+            new_start, new_end - new_start, [&](u64 device_addr_out, u64 range_size) {
+                const auto add_download = [&](DAddr start, DAddr end) {
+                    const u64 new_size = end - start;
+                    downloads.push_back({
+                        BufferCopy{
+                            .src_offset = start - buffer_addr,
+                            .dst_offset = total_size_bytes,
+                            .size = new_size,
+                        },
+                        buffer_id,
+                    });
+                    // Align up to avoid cache conflicts
+                    constexpr u64 align = 64ULL;
+                    constexpr u64 mask = ~(align - 1ULL);
+                    total_size_bytes += (new_size + align - 1) & mask;
+                };
+
+                gpu_modified_ranges.ForEachInRange(device_addr_out, range_size, add_download);
+                ClearDownload(device_addr_out, range_size);
+                gpu_modified_ranges.Subtract(device_addr_out, range_size);
+            });
     });
+    if (total_size_bytes == 0) {
+        return;
+    }
+    MICROPROFILE_SCOPE(GPU_DownloadMemory);
+
+    auto download_staging = runtime.DownloadStagingBuffer(total_size_bytes);
+    runtime.PreCopyBarrier();
+    for (auto& [copy, buffer_id] : downloads) {
+        copy.dst_offset += download_staging.offset;
+        Buffer& buffer = slot_buffers[buffer_id];
+        buffer.MarkUsage(copy.src_offset, copy.size);
+        const std::array copies{copy};
+        runtime.CopyBuffer(download_staging.buffer, buffer, copies, false);
+    }
+    runtime.PostCopyBarrier();
+    runtime.Finish();
+    const u8* const mapped_memory = download_staging.mapped_span.data();
+    for (const auto& [copy, buffer_id] : downloads) {
+        const DAddr copy_device_addr = slot_buffers[buffer_id].CpuAddr() + copy.src_offset;
+        const u64 dst_offset = copy.dst_offset - download_staging.offset;
+        device_memory.WriteBlockUnsafe(copy_device_addr, mapped_memory + dst_offset, copy.size);
+    }
 }
 
 template <class P>
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <deque>
 #include <limits>
@@ -13,6 +14,7 @@
 
 #include "common/alignment.h"
 #include "common/common_types.h"
+#include "common/div_ceil.h"
 #include "video_core/buffer_cache/word_manager.h"
 
 namespace VideoCommon {
@@ -27,6 +29,8 @@ class MemoryTrackerBase {
     static constexpr size_t MANAGER_POOL_SIZE = 32;
     static constexpr size_t WORDS_STACK_NEEDED = HIGHER_PAGE_SIZE / BYTES_PER_WORD;
     using Manager = WordManager<DeviceTracker, WORDS_STACK_NEEDED>;
+    static constexpr size_t SUMMARY_BITS = 64;
+    static constexpr size_t SUMMARY_WORDS = NUM_HIGH_PAGES / SUMMARY_BITS;
 
 public:
     MemoryTrackerBase(DeviceTracker& device_tracker_) : device_tracker{&device_tracker_} {}
@@ -35,7 +39,7 @@ public:
     /// Returns the inclusive CPU modified range in a begin end pair
     [[nodiscard]] std::pair<u64, u64> ModifiedCpuRegion(VAddr query_cpu_addr,
                                                         u64 query_size) noexcept {
-        return IteratePairs<true>(
+        return IteratePairs<Type::CPU, true>(
             query_cpu_addr, query_size, [](Manager* manager, u64 offset, size_t size) {
                 return manager->template ModifiedRegion<Type::CPU>(offset, size);
             });
@@ -44,7 +48,7 @@ public:
     /// Returns the inclusive GPU modified range in a begin end pair
     [[nodiscard]] std::pair<u64, u64> ModifiedGpuRegion(VAddr query_cpu_addr,
                                                         u64 query_size) noexcept {
-        return IteratePairs<false>(
+        return IteratePairs<Type::GPU, false>(
             query_cpu_addr, query_size, [](Manager* manager, u64 offset, size_t size) {
                 return manager->template ModifiedRegion<Type::GPU>(offset, size);
             });
@@ -52,7 +56,7 @@ public:
 
     /// Returns true if a region has been modified from the CPU
     [[nodiscard]] bool IsRegionCpuModified(VAddr query_cpu_addr, u64 query_size) noexcept {
-        return IteratePages<true>(
+        return IterateModifiedPages<Type::CPU, true>(
             query_cpu_addr, query_size, [](Manager* manager, u64 offset, size_t size) {
                 return manager->template IsRegionModified<Type::CPU>(offset, size);
             });
@@ -60,7 +64,7 @@ public:
 
     /// Returns true if a region has been modified from the GPU
     [[nodiscard]] bool IsRegionGpuModified(VAddr query_cpu_addr, u64 query_size) noexcept {
-        return IteratePages<false>(
+        return IterateModifiedPages<Type::GPU, false>(
             query_cpu_addr, query_size, [](Manager* manager, u64 offset, size_t size) {
                 return manager->template IsRegionModified<Type::GPU>(offset, size);
             });
@@ -77,27 +81,30 @@ public:
     /// Mark region as CPU modified, notifying the device_tracker about this change
     void MarkRegionAsCpuModified(VAddr dirty_cpu_addr, u64 query_size) {
         IteratePages<true>(dirty_cpu_addr, query_size,
-                           [](Manager* manager, u64 offset, size_t size) {
+                           [this](Manager* manager, u64 offset, size_t size) {
                                manager->template ChangeRegionState<Type::CPU, true>(
                                    manager->GetCpuAddr() + offset, size);
+                               SetSummary<Type::CPU>(manager);
                            });
     }
 
     /// Unmark region as CPU modified, notifying the device_tracker about this change
     void UnmarkRegionAsCpuModified(VAddr dirty_cpu_addr, u64 query_size) {
         IteratePages<true>(dirty_cpu_addr, query_size,
-                           [](Manager* manager, u64 offset, size_t size) {
+                           [this](Manager* manager, u64 offset, size_t size) {
                                manager->template ChangeRegionState<Type::CPU, false>(
                                    manager->GetCpuAddr() + offset, size);
+                               RefreshSummary<Type::CPU>(manager);
                            });
     }
 
     /// Mark region as modified from the host GPU
     void MarkRegionAsGpuModified(VAddr dirty_cpu_addr, u64 query_size) noexcept {
         IteratePages<true>(dirty_cpu_addr, query_size,
-                           [](Manager* manager, u64 offset, size_t size) {
+                           [this](Manager* manager, u64 offset, size_t size) {
                                manager->template ChangeRegionState<Type::GPU, true>(
                                    manager->GetCpuAddr() + offset, size);
+                               SetSummary<Type::GPU>(manager);
                            });
     }
 
@@ -113,9 +120,10 @@ public:
     /// Unmark region as modified from the host GPU
     void UnmarkRegionAsGpuModified(VAddr dirty_cpu_addr, u64 query_size) noexcept {
         IteratePages<true>(dirty_cpu_addr, query_size,
-                           [](Manager* manager, u64 offset, size_t size) {
+                           [this](Manager* manager, u64 offset, size_t size) {
                                manager->template ChangeRegionState<Type::GPU, false>(
                                    manager->GetCpuAddr() + offset, size);
+                               RefreshSummary<Type::GPU>(manager);
                            });
     }
 
@@ -136,19 +144,25 @@ public:
                 const VAddr cpu_address = manager->GetCpuAddr() + offset;
                 manager->template ChangeRegionState<Type::CachedCPU, true>(cpu_address, size);
                 cached_pages.insert(static_cast<u32>(cpu_address >> HIGHER_PAGE_BITS));
+                // Cached writes stop tracking the pages, which uploads have to restore
+                SetSummary<Type::CPU>(manager);
             });
     }
 
     /// Flushes cached CPU writes, and notify the device_tracker about the deltas
     void FlushCachedWrites(VAddr query_cpu_addr, u64 query_size) noexcept {
         IteratePages<false>(query_cpu_addr, query_size,
-                            [](Manager* manager, [[maybe_unused]] u64 offset,
-                               [[maybe_unused]] size_t size) { manager->FlushCachedWrites(); });
+                            [this](Manager* manager, [[maybe_unused]] u64 offset,
+                                   [[maybe_unused]] size_t size) {
+                                manager->FlushCachedWrites();
+                                RefreshSummary<Type::CPU>(manager);
+                            });
     }
 
     void FlushCachedWrites() noexcept {
         for (auto id : cached_pages) {
             top_tier[id]->FlushCachedWrites();
+            RefreshSummary<Type::CPU>(top_tier[id]);
         }
         cached_pages.clear();
     }
@@ -156,35 +170,35 @@ public:
     /// Call 'func' for each CPU modified range and unmark those pages as CPU modified
     template <typename Func>
     void ForEachUploadRange(VAddr query_cpu_range, u64 query_size, Func&& func) {
-        IteratePages<true>(query_cpu_range, query_size,
-                           [&func](Manager* manager, u64 offset, size_t size) {
-                               manager->template ForEachModifiedRange<Type::CPU, true>(
-                                   manager->GetCpuAddr() + offset, size, func);
-                           });
+        IterateModifiedPages<Type::CPU, true>(
+            query_cpu_range, query_size, [&func](Manager* manager, u64 offset, size_t size) {
+                manager->template ForEachModifiedRange<Type::CPU, true>(
+                    manager->GetCpuAddr() + offset, size, func);
+            });
     }
 
     /// Call 'func' for each GPU modified range and unmark those pages as GPU modified
     template <typename Func>
     void ForEachDownloadRange(VAddr query_cpu_range, u64 query_size, bool clear, Func&& func) {
-        IteratePages<false>(query_cpu_range, query_size,
-                            [&func, clear](Manager* manager, u64 offset, size_t size) {
-                                if (clear) {
-                                    manager->template ForEachModifiedRange<Type::GPU, true>(
-                                        manager->GetCpuAddr() + offset, size, func);
-                                } else {
-                                    manager->template ForEachModifiedRange<Type::GPU, false>(
-                                        manager->GetCpuAddr() + offset, size, func);
-                                }
-                            });
+        IterateModifiedPages<Type::GPU, false>(
+            query_cpu_range, query_size, [&func, clear](Manager* manager, u64 offset, size_t size) {
+                if (clear) {
+                    manager->template ForEachModifiedRange<Type::GPU, true>(
+                        manager->GetCpuAddr() + offset, size, func);
+                } else {
+                    manager->template ForEachModifiedRange<Type::GPU, false>(
+                        manager->GetCpuAddr() + offset, size, func);
+                }
+            });
     }
 
     template <typename Func>
     void ForEachDownloadRangeAndClear(VAddr query_cpu_range, u64 query_size, Func&& func) {
-        IteratePages<false>(query_cpu_range, query_size,
-                            [&func](Manager* manager, u64 offset, size_t size) {
-                                manager->template ForEachModifiedRange<Type::GPU, true>(
-                                    manager->GetCpuAddr() + offset, size, func);
-                            });
+        IterateModifiedPages<Type::GPU, false>(
+            query_cpu_range, query_size, [&func](Manager* manager, u64 offset, size_t size) {
+                manager->template ForEachModifiedRange<Type::GPU, true>(
+                    manager->GetCpuAddr() + offset, size, func);
+            });
     }
 
 private:
@@ -225,36 +239,73 @@ private:
         return false;
     }
 
-    template <bool create_region_on_fail, typename Func>
-    std::pair<u64, u64> IteratePairs(VAddr cpu_address, size_t size, Func&& func) {
-        std::size_t remaining_size{size};
+    /**
+     * Calls func on the managers in the range that may have pages in the given state, found
+     * through the summary bitmaps, so clean regions of the range cost one bit each.
+     * The summary of each visited manager is refreshed after func returns.
+     */
+    template <Type type, bool create_region_on_fail, typename Func>
+    bool IterateModifiedPages(VAddr cpu_address, size_t size, Func&& func) {
+        using FuncReturn = typename std::invoke_result<Func, Manager*, u64, size_t>::type;
+        static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
+        if (size == 0) {
+            return false;
+        }
+        const auto& summary = Summary<type>();
+        const VAddr end_address = cpu_address + size;
+        const std::size_t end_page_index = Common::DivCeil(end_address, HIGHER_PAGE_SIZE);
         std::size_t page_index{cpu_address >> HIGHER_PAGE_BITS};
-        u64 page_offset{cpu_address & HIGHER_PAGE_MASK};
+        while (page_index < end_page_index) {
+            const std::size_t summary_index = page_index / SUMMARY_BITS;
+            u64 candidates = summary[summary_index];
+            if constexpr (create_region_on_fail) {
+                // Regions that don't exist yet are created as CPU modified
+                candidates |= ~created_regions[summary_index];
+            }
+            candidates >>= page_index % SUMMARY_BITS;
+            if (candidates == 0) {
+                page_index = (summary_index + 1) * SUMMARY_BITS;
+                continue;
+            }
+            page_index += std::countr_zero(candidates);
+            if (page_index >= end_page_index) {
+                break;
+            }
+            if (!top_tier[page_index]) {
+                CreateRegion(page_index);
+            }
+            Manager* const manager{top_tier[page_index]};
+            const VAddr region_address = page_index << HIGHER_PAGE_BITS;
+            const VAddr start = std::max(cpu_address, region_address);
+            const VAddr end = std::min(end_address, region_address + HIGHER_PAGE_SIZE);
+            if constexpr (BOOL_BREAK) {
+                const bool result = func(manager, start - region_address, end - start);
+                RefreshSummary<type>(manager);
+                if (result) {
+                    return true;
+                }
+            } else {
+                func(manager, start - region_address, end - start);
+                RefreshSummary<type>(manager);
+            }
+            ++page_index;
+        }
+        return false;
+    }
+
+    template <Type type, bool create_region_on_fail, typename Func>
+    std::pair<u64, u64> IteratePairs(VAddr cpu_address, size_t size, Func&& func) {
         u64 begin = std::numeric_limits<u64>::max();
         u64 end = 0;
-        while (remaining_size > 0) {
-            const std::size_t copy_amount{
-                std::min<std::size_t>(HIGHER_PAGE_SIZE - page_offset, remaining_size)};
-            auto* manager{top_tier[page_index]};
-            const auto execute = [&] {
-                auto [new_begin, new_end] = func(manager, page_offset, copy_amount);
+        IterateModifiedPages<type, create_region_on_fail>(
+            cpu_address, size, [&](Manager* manager, u64 offset, size_t copy_amount) {
+                auto [new_begin, new_end] = func(manager, offset, copy_amount);
                 if (new_begin != 0 || new_end != 0) {
-                    const u64 base_address = page_index << HIGHER_PAGE_BITS;
+                    const u64 base_address = manager->GetCpuAddr();
                     begin = std::min(new_begin + base_address, begin);
                     end = std::max(new_end + base_address, end);
                 }
-            };
-            if (manager) {
-                execute();
-            } else if constexpr (create_region_on_fail) {
-                CreateRegion(page_index);
-                manager = top_tier[page_index];
-                execute();
-            }
-            page_index++;
-            page_offset = 0;
-            remaining_size -= copy_amount;
-        }
+            });
         if (begin < end) {
             return std::make_pair(begin, end);
         } else {
@@ -262,9 +313,43 @@ private:
         }
     }
 
+    template <Type type>
+    std::array<u64, SUMMARY_WORDS>& Summary() noexcept {
+        static_assert(type == Type::CPU || type == Type::GPU);
+        if constexpr (type == Type::CPU) {
+            return cpu_summary;
+        } else {
+            return gpu_summary;
+        }
+    }
+
+    template <Type type>
+    void SetSummary(const Manager* manager) noexcept {
+        const std::size_t page_index = manager->GetCpuAddr() >> HIGHER_PAGE_BITS;
+        Summary<type>()[page_index / SUMMARY_BITS] |= 1ULL << (page_index % SUMMARY_BITS);
+    }
+
+    template <Type type>
+    void RefreshSummary(const Manager* manager) noexcept {
+        bool is_clean = manager->template IsClean<type>();
+        if constexpr (type == Type::CPU) {
+            // Untracked pages are restored by uploads, so they keep the manager visible
+            is_clean = is_clean && manager->template IsClean<Type::Untracked>();
+        }
+        if (!is_clean) {
+            SetSummary<type>(manager);
+            return;
+        }
+        const std::size_t page_index = manager->GetCpuAddr() >> HIGHER_PAGE_BITS;
+        Summary<type>()[page_index / SUMMARY_BITS] &= ~(1ULL << (page_index % SUMMARY_BITS));
+    }
+
     void CreateRegion(std::size_t page_index) {
         const VAddr base_cpu_addr = page_index << HIGHER_PAGE_BITS;
         top_tier[page_index] = GetNewManager(base_cpu_addr);
+        created_regions[page_index / SUMMARY_BITS] |= 1ULL << (page_index % SUMMARY_BITS);
+        // New regions start as CPU modified
+        SetSummary<Type::CPU>(top_tier[page_index]);
     }
 
     Manager* GetNewManager(VAddr base_cpu_address) {
@@ -291,6 +376,13 @@ private:
 
     std::array<Manager*, NUM_HIGH_PAGES> top_tier{};
 
+    /// One bit per region, set for regions that may have CPU modified or untracked pages
+    std::array<u64, SUMMARY_WORDS> cpu_summary{};
+    /// One bit per region, set for regions that may have GPU modified pages
+    std::array<u64, SUMMARY_WORDS> gpu_summary{};
+    /// One bit per region, set for regions with a manager
+    std::array<u64, SUMMARY_WORDS> created_regions{};
+
     std::unordered_set<u32> cached_pages;
 
     DeviceTracker* device_tracker = nullptr;
@@ -402,6 +402,13 @@ public:
         return begin < end ? std::make_pair(begin * BYTES_PER_PAGE, end * BYTES_PER_PAGE) : EMPTY;
     }
 
+    /// Returns true when no page of the manager is in the given state
+    template <Type type>
+    [[nodiscard]] bool IsClean() const noexcept {
+        const std::span<const u64> state_words = words.template Span<type>();
+        return std::ranges::all_of(state_words, [](u64 word) { return word == 0; });
+    }
+
     /// Returns the number of words of the manager
     [[nodiscard]] size_t NumWords() const noexcept {
         return words.NumWords();
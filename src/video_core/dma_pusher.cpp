@@ -8,6 +8,7 @@
 #include "video_core/dma_pusher.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_trace.h"
 #include "video_core/guest_memory.h"
 #include "video_core/memory_manager.h"
 
@@ -60,7 +61,7 @@ bool DmaPusher::Step() {
 
     if (command_list.prefetch_command_list.size()) {
         // Prefetched command list from nvdrv, used for things like synchronization
-        ProcessCommands(command_list.prefetch_command_list);
+        ProcessCommands(command_list.prefetch_command_list, 0);
         dma_pushbuffer.pop();
     } else {
         const CommandListHeader command_list_header{
@@ -89,14 +90,14 @@ bool DmaPusher::Step() {
                                           Tegra::Memory::GuestMemoryFlags::SafeRead>
                 headers(memory_manager, dma_state.dma_get, command_list_header.size,
                         &command_headers);
-            ProcessCommands(headers);
+            ProcessCommands(headers, dma_state.dma_get);
         };
         const auto unsafe_process = [&] {
             Tegra::Memory::GpuGuestMemory<Tegra::CommandHeader,
                                           Tegra::Memory::GuestMemoryFlags::UnsafeRead>
                 headers(memory_manager, dma_state.dma_get, command_list_header.size,
                         &command_headers);
-            ProcessCommands(headers);
+            ProcessCommands(headers, dma_state.dma_get);
         };
         if (Settings::IsGPULevelHigh()) {
             if (dma_state.method >= MacroRegistersStart) {
@@ -116,7 +117,11 @@ bool DmaPusher::Step() {
     return true;
 }
 
-void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
+void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands, GPUVAddr address) {
+    if (trace_recorder) [[unlikely]] {
+        trace_recorder->RecordCommands(trace_channel_id, address, commands);
+    }
+    const bool batch_registers = !Settings::values.disable_register_batching.GetValue();
     for (std::size_t index = 0; index < commands.size();) {
         const CommandHeader& command_header = commands[index];
 
@@ -132,6 +137,18 @@ void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
                 index += max_write;
                 continue;
             } else {
+                if (batch_registers && !dma_increment_once) {
+                    const u32 max_write = static_cast<u32>(
+                        std::min<std::size_t>(dma_state.method_count, commands.size() - index));
+                    const u32 num_writes = CountRegisterRange(max_write);
+                    if (num_writes > 1) {
+                        CallRegisterRange(&command_header.argument, num_writes);
+                        dma_state.method += num_writes;
+                        dma_state.method_count -= num_writes;
+                        index += num_writes;
+                        continue;
+                    }
+                }
                 dma_state.is_last_call = dma_state.method_count <= 1;
                 CallMethod(command_header.argument);
             }
@@ -219,6 +236,23 @@ void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
     }
 }
 
+u32 DmaPusher::CountRegisterRange(u32 max_methods) const {
+    if (dma_state.method < non_puller_methods) {
+        return 0;
+    }
+    const auto& execution_mask = subchannels[dma_state.subchannel]->execution_mask;
+    u32 num_methods = 0;
+    while (num_methods < max_methods && !execution_mask[dma_state.method + num_methods]) {
+        ++num_methods;
+    }
+    return num_methods;
+}
+
+void DmaPusher::CallRegisterRange(const u32* base_start, u32 num_methods) const {
+    subchannels[dma_state.subchannel]->CallRegisterRange(dma_state.method, base_start,
+                                                         num_methods);
+}
+
 void DmaPusher::BindRasterizer(VideoCore::RasterizerInterface* rasterizer) {
     puller.BindRasterizer(rasterizer);
 }
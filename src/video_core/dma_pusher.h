@@ -26,6 +26,7 @@ struct ChannelState;
 }
 
 class GPU;
+class GpuTraceRecorder;
 class MemoryManager;
 
 enum class SubmissionMode : u32 {
@@ -138,17 +139,29 @@ public:
 
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Record the command words processed by this pusher as the given channel
+    void BindTraceRecorder(GpuTraceRecorder* recorder, s32 channel_id) {
+        trace_recorder = recorder;
+        trace_channel_id = channel_id;
+    }
+
 private:
     static constexpr u32 non_puller_methods = 0x40;
     static constexpr u32 max_subchannels = 8;
     bool Step();
-    void ProcessCommands(std::span<const CommandHeader> commands);
+    /// Process command words fetched from address, or prefetched when address is zero
+    void ProcessCommands(std::span<const CommandHeader> commands, GPUVAddr address);
 
     void SetState(const CommandHeader& command_header);
 
     void CallMethod(u32 argument) const;
     void CallMultiMethod(const u32* base_start, u32 num_methods) const;
 
+    /// Counts the methods from the current one, up to max_methods, without side effects
+    u32 CountRegisterRange(u32 max_methods) const;
+    /// Writes a run of consecutive registers counted by CountRegisterRange
+    void CallRegisterRange(const u32* base_start, u32 num_methods) const;
+
     Common::ScratchBuffer<CommandHeader>
         command_headers; ///< Buffer for list of commands fetched at once
 
@@ -171,6 +184,9 @@ private:
 
     const bool ib_enable{true}; ///< IB mode enabled
 
+    GpuTraceRecorder* trace_recorder{};
+    s32 trace_channel_id{};
+
     std::array<Engines::EngineInterface*, max_subchannels> subchannels{};
     std::array<Engines::EngineTypes, max_subchannels> subchannel_type;
 
@@ -231,6 +231,7 @@ void DrawManager::DrawTexture() {
         draw_texture_state.src_y0;
     draw_texture_state.src_sampler = regs.draw_texture.src_sampler;
     draw_texture_state.src_texture = regs.draw_texture.src_texture;
+    ++num_draws;
     maxwell3d->rasterizer->DrawTexture();
 }
 
@@ -267,6 +268,7 @@ void DrawManager::ProcessDraw(bool draw_indexed, u32 instance_count) {
     UpdateTopology();
 
     if (maxwell3d->ShouldExecute()) {
+        ++num_draws;
         maxwell3d->rasterizer->Draw(draw_indexed, instance_count);
     }
 }
@@ -281,6 +283,7 @@ void DrawManager::ProcessDrawIndirect() {
     UpdateTopology();
 
     if (maxwell3d->ShouldExecute()) {
+        ++num_draws;
         maxwell3d->rasterizer->DrawIndirect();
     }
 }
@@ -92,6 +92,11 @@ public:
         return indirect_state;
     }
 
+    /// Number of draws sent to the rasterizer, including draws issued by macros
+    u64 GetNumDraws() const {
+        return num_draws;
+    }
+
 private:
     void SetInlineIndexBuffer(u32 index);
 
@@ -113,5 +118,6 @@ private:
     State draw_state{};
     DrawTextureState draw_texture_state{};
     IndirectParams indirect_state{};
+    u64 num_draws{};
 };
 } // namespace Tegra::Engines
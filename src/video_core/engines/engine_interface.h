@@ -30,6 +30,14 @@ public:
     virtual void CallMultiMethod(u32 method, const u32* base_start, u32 amount,
                                  u32 methods_pending) = 0;
 
+    /// Write values to consecutive registers starting at method. None of the registers may be
+    /// marked in the execution mask.
+    virtual void CallRegisterRange(u32 method, const u32* base_start, u32 amount) {
+        for (u32 i = 0; i < amount; i++) {
+            method_sink.emplace_back(method + i, base_start[i]);
+        }
+    }
+
     void ConsumeSink() {
         if (method_sink.empty()) {
             return;
@@ -465,6 +465,11 @@ void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
         return;
     }
     default:
+        if (!execution_mask[method]) {
+            // Only the last write to a register without side effects is observable
+            CallRegisterRange(method, base_start + amount - 1, 1);
+            break;
+        }
         for (u32 i = 0; i < amount; i++) {
             CallMethod(method, base_start[i], methods_pending - i <= 1);
         }
@@ -472,6 +477,34 @@ void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
     }
 }
 
+void Maxwell3D::CallRegisterRange(u32 method, const u32* base_start, u32 amount) {
+    ASSERT(method + amount <= Regs::NUM_REGS);
+    ConsumeSink();
+
+    const u32* values = base_start;
+    const auto control = shadow_state.shadow_ram_control;
+    if (control == Regs::ShadowRamControl::Track ||
+        control == Regs::ShadowRamControl::TrackWithFilter) {
+        std::memcpy(&shadow_state.reg_array[method], base_start, amount * sizeof(u32));
+    } else if (control == Regs::ShadowRamControl::Replay) {
+        values = &shadow_state.reg_array[method];
+    }
+
+    u32* const registers = &regs.reg_array[method];
+    if (std::memcmp(registers, values, amount * sizeof(u32)) == 0) {
+        return;
+    }
+    for (u32 i = 0; i < amount; i++) {
+        if (registers[i] == values[i]) {
+            continue;
+        }
+        for (const auto& table : dirty.tables) {
+            dirty.flags[table[method + i]] = true;
+        }
+    }
+    std::memcpy(registers, values, amount * sizeof(u32));
+}
+
 void Maxwell3D::ProcessMacroUpload(u32 data) {
     macro_engine->AddCode(regs.load_mme.instruction_ptr++, data);
 }
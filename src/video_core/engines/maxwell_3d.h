@@ -3078,6 +3078,9 @@ public:
     void CallMultiMethod(u32 method, const u32* base_start, u32 amount,
                          u32 methods_pending) override;
 
+    /// Write consecutive registers without side effects with a single copy.
+    void CallRegisterRange(u32 method, const u32* base_start, u32 amount) override;
+
     bool ShouldExecute() const {
         return execute_on;
     }
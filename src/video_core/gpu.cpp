@@ -9,6 +9,8 @@
 #include <memory>
 
 #include "common/assert.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
 #include "core/core.h"
@@ -28,6 +30,7 @@
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_thread.h"
+#include "video_core/gpu_trace.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/host1x/syncpoint_manager.h"
 #include "video_core/memory_manager.h"
@@ -71,6 +74,24 @@ struct GPU::Impl {
         to_init.Init(system, gpu, program_id);
         to_init.BindRasterizer(rasterizer);
         rasterizer->InitializeChannel(to_init);
+        if (Settings::values.record_gpu_trace) {
+            BindTraceRecorder(to_init);
+        }
+    }
+
+    void BindTraceRecorder(Control::ChannelState& channel) {
+        if (!trace_recorder) {
+            const auto dump_dir{Common::FS::GetYuzuPath(Common::FS::YuzuPath::DumpDir)};
+            if (!Common::FS::CreateDir(dump_dir)) {
+                LOG_ERROR(Common_Filesystem, "Failed to create dump directory");
+                return;
+            }
+            trace_recorder = std::make_unique<GpuTraceRecorder>(
+                dump_dir / fmt::format("gpu_trace_{:016x}.bin", channel.program_id));
+        }
+        channel.memory_manager->BindTraceRecorder(trace_recorder.get());
+        trace_recorder->RecordChannel(channel.bind_id, channel.memory_manager->GetID());
+        channel.dma_pusher->BindTraceRecorder(trace_recorder.get(), channel.bind_id);
     }
 
     void InitAddressSpace(Tegra::MemoryManager& memory_manager) {
@@ -289,8 +310,10 @@ struct GPU::Impl {
             rasterizer->FlushRegion(raster_area.start_address,
                                     raster_area.end_address - raster_area.start_address);
         });
+        const auto stall_start = std::chrono::steady_clock::now();
         gpu_thread.TickGPU();
         WaitForSyncOperation(fence);
+        system.GetPerfStats().AddReadbackStall(std::chrono::steady_clock::now() - stall_start);
         return raster_area;
     }
 
@@ -390,6 +413,9 @@ struct GPU::Impl {
 
     const bool is_async;
 
+    /// Declared before the GPU thread, so it is destroyed after the thread stops recording
+    std::unique_ptr<GpuTraceRecorder> trace_recorder;
+
     VideoCommon::GPUThread::ThreadManager gpu_thread;
     std::unique_ptr<Core::Frontend::GraphicsContext> cpu_context;
 
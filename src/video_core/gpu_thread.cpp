@@ -2,12 +2,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "common/thread.h"
 #include "core/core.h"
 #include "core/frontend/graphics_context.h"
+#include "core/perf_stats.h"
 #include "video_core/control/scheduler.h"
 #include "video_core/dma_pusher.h"
 #include "video_core/gpu.h"
@@ -16,6 +18,8 @@
 
 namespace VideoCommon::GPUThread {
 
+MICROPROFILE_DEFINE(GPU_wait, "GPU", "Wait for GPU thread", MP_RGB(128, 128, 192));
+
 /// Runs the GPU thread
 static void RunThread(std::stop_token stop_token, Core::System& system,
                       VideoCore::RendererBase& renderer, Core::Frontend::GraphicsContext& context,
@@ -34,15 +38,19 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
     VideoCore::RasterizerInterface* const rasterizer = renderer.ReadRasterizer();
 
     CommandDataContainer next;
+    u64 fence{};
 
     while (!stop_token.stop_requested()) {
         state.queue.PopWait(next, stop_token);
         if (stop_token.stop_requested()) {
             break;
         }
+        ++fence;
         if (auto* submit_list = std::get_if<SubmitListCommand>(&next.data)) {
             scheduler.Push(submit_list->channel, std::move(submit_list->entries));
         } else if (std::holds_alternative<GPUTickCommand>(next.data)) {
+            // Requests made after this point need a new tick, earlier ones are handled here
+            state.tick_pending.exchange(false, std::memory_order_acq_rel);
             system.GPU().TickWork();
         } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next.data)) {
             rasterizer->FlushRegion(flush->addr, flush->size);
@@ -51,12 +59,14 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
         } else {
             ASSERT(false);
         }
-        state.signaled_fence.store(next.fence);
+        state.signaled_fence.store(fence, std::memory_order_release);
         if (next.block) {
-            // We have to lock the write_lock to ensure that the condition_variable wait not get a
-            // race between the check and the lock itself.
+            // Waiters register and check the fence under write_lock, so checking for them under
+            // the lock can't miss one that read the previous fence
             std::scoped_lock lk{state.write_lock};
-            state.cv.notify_all();
+            if (state.num_waiters != 0) {
+                state.cv.notify_all();
+            }
         }
     }
 }
@@ -64,7 +74,15 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
 ThreadManager::ThreadManager(Core::System& system_, bool is_async_)
     : system{system_}, is_async{is_async_} {}
 
-ThreadManager::~ThreadManager() = default;
+ThreadManager::~ThreadManager() {
+    const QueueStatistics stats{GetStatistics()};
+    if (stats.num_commands == 0) {
+        return;
+    }
+    LOG_INFO(HW_GPU, "GPU thread executed {} commands, max queue depth {}, {} waits for {} ms",
+             stats.num_commands, stats.max_depth, stats.num_waits,
+             std::chrono::duration_cast<std::chrono::milliseconds>(stats.wait_time).count());
+}
 
 void ThreadManager::StartThread(VideoCore::RendererBase& renderer,
                                 Core::Frontend::GraphicsContext& context,
@@ -89,11 +107,17 @@ void ThreadManager::FlushRegion(DAddr addr, u64 size) {
     }
     auto& gpu = system.GPU();
     u64 fence = gpu.RequestFlush(addr, size);
+    const auto stall_start = std::chrono::steady_clock::now();
     TickGPU();
     gpu.WaitForSyncOperation(fence);
+    system.GetPerfStats().AddReadbackStall(std::chrono::steady_clock::now() - stall_start);
 }
 
 void ThreadManager::TickGPU() {
+    // A queued tick handles every sync request made before the GPU thread starts executing it
+    if (state.tick_pending.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
     PushCommand(GPUTickCommand());
 }
 
@@ -112,17 +136,41 @@ u64 ThreadManager::PushCommand(CommandData&& command_data, bool block) {
         block = true;
     }
 
-    std::unique_lock lk(state.write_lock);
-    const u64 fence{++state.last_fence};
-    state.queue.EmplaceWait(std::move(command_data), fence, block);
+    const u64 fence{state.queue.EmplaceWait(std::move(command_data), block) + 1};
+    const u64 depth{fence - state.signaled_fence.load(std::memory_order_relaxed)};
+    u64 max_depth{state.max_depth.load(std::memory_order_relaxed)};
+    while (depth > max_depth &&
+           !state.max_depth.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+    }
 
     if (block) {
-        Common::CondvarWait(state.cv, lk, thread.get_stop_token(), [this, fence] {
-            return fence <= state.signaled_fence.load(std::memory_order_relaxed);
-        });
+        MICROPROFILE_SCOPE(GPU_wait);
+        const auto wait_start{std::chrono::steady_clock::now()};
+        {
+            std::unique_lock lk(state.write_lock);
+            ++state.num_waiters;
+            Common::CondvarWait(state.cv, lk, thread.get_stop_token(), [this, fence] {
+                return fence <= state.signaled_fence.load(std::memory_order_acquire);
+            });
+            --state.num_waiters;
+        }
+        const auto wait_time{std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - wait_start)};
+        state.num_waits.fetch_add(1, std::memory_order_relaxed);
+        state.wait_time_ns.fetch_add(static_cast<u64>(wait_time.count()),
+                                     std::memory_order_relaxed);
     }
 
     return fence;
 }
 
+QueueStatistics ThreadManager::GetStatistics() const {
+    return {
+        .num_commands = state.signaled_fence.load(std::memory_order_relaxed),
+        .max_depth = state.max_depth.load(std::memory_order_relaxed),
+        .num_waits = state.num_waits.load(std::memory_order_relaxed),
+        .wait_time = std::chrono::nanoseconds{state.wait_time_ns.load(std::memory_order_relaxed)},
+    };
+}
+
 } // namespace VideoCommon::GPUThread
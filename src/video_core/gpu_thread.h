@@ -4,6 +4,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <optional>
@@ -79,22 +80,41 @@ using CommandData =
 struct CommandDataContainer {
     CommandDataContainer() = default;
 
-    explicit CommandDataContainer(CommandData&& data_, u64 next_fence_, bool block_)
-        : data{std::move(data_)}, fence{next_fence_}, block(block_) {}
+    explicit CommandDataContainer(CommandData&& data_, bool block_)
+        : data{std::move(data_)}, block(block_) {}
 
     CommandData data;
-    u64 fence{};
     bool block{};
 };
 
+/// Statistics of the commands pushed to the GPU thread
+struct QueueStatistics {
+    u64 num_commands{};
+    /// Largest number of commands pending execution seen when pushing a command
+    u64 max_depth{};
+    /// Number of pushes that blocked until the GPU thread executed them
+    u64 num_waits{};
+    std::chrono::nanoseconds wait_time{};
+};
+
 /// Struct used to synchronize the GPU thread
 struct SynchState final {
-    using CommandQueue = Common::MPSCQueue<CommandDataContainer>;
+    /// Commands are executed in the order of their queue position, the fence of a command is its
+    /// position plus one
+    using CommandQueue = Common::LockFreeMPSCQueue<CommandDataContainer>;
     std::mutex write_lock;
     CommandQueue queue;
-    u64 last_fence{};
     std::atomic<u64> signaled_fence{};
+    /// Callers blocked on the condition variable, guarded by write_lock
+    u64 num_waiters{};
     std::condition_variable_any cv;
+
+    /// A tick command is queued and has not started, so later ticks can be skipped
+    std::atomic_bool tick_pending{};
+
+    std::atomic<u64> max_depth{};
+    std::atomic<u64> num_waits{};
+    std::atomic<u64> wait_time_ns{};
 };
 
 /// Class used to manage the GPU thread
@@ -121,6 +141,9 @@ public:
 
     void TickGPU();
 
+    /// Returns statistics of the commands pushed since the thread started
+    [[nodiscard]] QueueStatistics GetStatistics() const;
+
 private:
     /// Pushes a command to be executed by the GPU thread
     u64 PushCommand(CommandData&& command_data, bool block = false);
@@ -0,0 +1,430 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "core/device_memory_manager.h"
+#include "video_core/gpu_trace.h"
+
+namespace Tegra {
+
+namespace {
+using namespace Common::Literals;
+
+constexpr u32 TRACE_MAGIC = Common::MakeMagic('Y', 'G', 'P', 'T');
+constexpr u32 TRACE_VERSION = 2;
+
+/// Uncompressed size at which pending entries are written out
+constexpr size_t CHUNK_SIZE = 4_MiB;
+
+/// Upper bound of a chunk, used to reject corrupted chunks
+constexpr u32 MAX_CHUNK_SIZE = 64_MiB;
+
+enum class EntryType : u32 {
+    Commands,
+    AddressSpace,
+    Channel,
+    Map,
+    Unmap,
+    Memory,
+};
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct ChunkHeader {
+    u32 compressed_size;
+    u32 uncompressed_size;
+};
+
+struct EntryHeader {
+    EntryType type;
+    u32 size;
+};
+
+struct CommandsEntry {
+    s32 channel;
+    u32 num_commands;
+    u64 address;
+};
+
+struct AddressSpaceEntry {
+    u64 id;
+    u64 address_space_bits;
+    u64 split_address;
+    u64 big_page_bits;
+    u64 page_bits;
+};
+
+struct ChannelEntry {
+    s32 channel;
+    u32 padding;
+    u64 address_space;
+};
+
+struct MapEntry {
+    u64 address_space;
+    u64 gpu_addr;
+    u64 device_addr;
+    u64 size;
+    u32 kind;
+    u32 flags;
+};
+
+struct UnmapEntry {
+    u64 address_space;
+    u64 gpu_addr;
+    u64 size;
+};
+
+struct MemoryEntry {
+    u64 device_addr;
+};
+
+enum MapFlags : u32 {
+    MAP_BIG_PAGES = 1 << 0,
+    MAP_SPARSE = 1 << 1,
+};
+
+template <typename T>
+void Append(std::vector<u8>& buffer, const T* data, size_t count) {
+    const size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(T) * count);
+    std::memcpy(buffer.data() + offset, data, sizeof(T) * count);
+}
+
+/// Append an entry made of a fixed header and an optional array of trailing elements
+template <typename T, typename U = u8>
+void AppendEntry(std::vector<u8>& buffer, EntryType type, const T& entry,
+                 std::span<const U> trailing = {}) {
+    const EntryHeader header{
+        .type = type,
+        .size = static_cast<u32>(sizeof(T) + trailing.size_bytes()),
+    };
+    Append(buffer, &header, 1);
+    Append(buffer, &entry, 1);
+    if (!trailing.empty()) {
+        Append(buffer, trailing.data(), trailing.size());
+    }
+}
+
+/// Parse an entry from its payload
+std::optional<GpuTraceEntry> ParseEntry(EntryType type, std::span<const u8> payload) {
+    const auto read{[&payload]<typename T>(T& value) {
+        if (payload.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, payload.data(), sizeof(T));
+        payload = payload.subspan(sizeof(T));
+        return true;
+    }};
+    switch (type) {
+    case EntryType::Commands: {
+        CommandsEntry entry;
+        if (!read(entry) || payload.size() != size_t{entry.num_commands} * sizeof(CommandHeader)) {
+            return std::nullopt;
+        }
+        GpuTraceCommands commands{
+            .channel = entry.channel,
+            .address = entry.address,
+            .commands = std::vector<CommandHeader>(entry.num_commands),
+        };
+        std::memcpy(commands.commands.data(), payload.data(), payload.size());
+        return commands;
+    }
+    case EntryType::AddressSpace: {
+        AddressSpaceEntry entry;
+        if (!read(entry)) {
+            return std::nullopt;
+        }
+        return GpuTraceAddressSpace{
+            .id = entry.id,
+            .address_space_bits = entry.address_space_bits,
+            .split_address = entry.split_address,
+            .big_page_bits = entry.big_page_bits,
+            .page_bits = entry.page_bits,
+        };
+    }
+    case EntryType::Channel: {
+        ChannelEntry entry;
+        if (!read(entry)) {
+            return std::nullopt;
+        }
+        return GpuTraceChannel{
+            .channel = entry.channel,
+            .address_space = entry.address_space,
+        };
+    }
+    case EntryType::Map: {
+        MapEntry entry;
+        if (!read(entry)) {
+            return std::nullopt;
+        }
+        return GpuTraceMap{
+            .address_space = entry.address_space,
+            .gpu_addr = entry.gpu_addr,
+            .device_addr = entry.device_addr,
+            .size = entry.size,
+            .kind = static_cast<PTEKind>(entry.kind),
+            .big_pages = (entry.flags & MAP_BIG_PAGES) != 0,
+            .sparse = (entry.flags & MAP_SPARSE) != 0,
+        };
+    }
+    case EntryType::Unmap: {
+        UnmapEntry entry;
+        if (!read(entry)) {
+            return std::nullopt;
+        }
+        return GpuTraceUnmap{
+            .address_space = entry.address_space,
+            .gpu_addr = entry.gpu_addr,
+            .size = entry.size,
+        };
+    }
+    case EntryType::Memory: {
+        MemoryEntry entry;
+        if (!read(entry) || payload.size() != Core::DEVICE_PAGESIZE) {
+            return std::nullopt;
+        }
+        return GpuTraceMemory{
+            .device_addr = entry.device_addr,
+            .data = std::vector<u8>(payload.begin(), payload.end()),
+        };
+    }
+    }
+    return std::nullopt;
+}
+
+/// Parse the entries of a decompressed chunk
+bool ParseChunk(std::span<const u8> chunk, std::vector<GpuTraceEntry>& entries) {
+    size_t offset = 0;
+    while (offset < chunk.size()) {
+        EntryHeader header;
+        if (chunk.size() - offset < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, chunk.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (chunk.size() - offset < header.size) {
+            return false;
+        }
+        std::optional<GpuTraceEntry> entry =
+            ParseEntry(header.type, chunk.subspan(offset, header.size));
+        if (!entry) {
+            return false;
+        }
+        entries.push_back(std::move(*entry));
+        offset += header.size;
+    }
+    return true;
+}
+} // Anonymous namespace
+
+GpuTraceRecorder::GpuTraceRecorder(const std::filesystem::path& path)
+    : file{path, Common::FS::FileAccessMode::Write, Common::FS::FileType::BinaryFile} {
+    if (!file.IsOpen() || !file.WriteObject(FileHeader{TRACE_MAGIC, TRACE_VERSION})) {
+        LOG_ERROR(HW_GPU, "Failed to create GPU trace file {}", Common::FS::PathToUTF8String(path));
+        file.Close();
+        return;
+    }
+    pending.reserve(CHUNK_SIZE);
+    LOG_INFO(HW_GPU, "Recording GPU trace to {}", Common::FS::PathToUTF8String(path));
+}
+
+GpuTraceRecorder::~GpuTraceRecorder() {
+    WritePendingCommands();
+    Flush();
+}
+
+void GpuTraceRecorder::RecordAddressSpace(const GpuTraceAddressSpace& address_space) {
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    WritePendingCommands();
+    const AddressSpaceEntry entry{
+        .id = address_space.id,
+        .address_space_bits = address_space.address_space_bits,
+        .split_address = address_space.split_address,
+        .big_page_bits = address_space.big_page_bits,
+        .page_bits = address_space.page_bits,
+    };
+    AppendEntry(pending, EntryType::AddressSpace, entry);
+}
+
+void GpuTraceRecorder::RecordChannel(s32 channel, u64 address_space) {
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    WritePendingCommands();
+    const ChannelEntry entry{
+        .channel = channel,
+        .padding = 0,
+        .address_space = address_space,
+    };
+    AppendEntry(pending, EntryType::Channel, entry);
+}
+
+void GpuTraceRecorder::RecordMap(const GpuTraceMap& map) {
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    WritePendingCommands();
+    const MapEntry entry{
+        .address_space = map.address_space,
+        .gpu_addr = map.gpu_addr,
+        .device_addr = map.device_addr,
+        .size = map.size,
+        .kind = static_cast<u32>(map.kind),
+        .flags = (map.big_pages ? MAP_BIG_PAGES : 0U) | (map.sparse ? MAP_SPARSE : 0U),
+    };
+    AppendEntry(pending, EntryType::Map, entry);
+}
+
+void GpuTraceRecorder::RecordUnmap(const GpuTraceUnmap& unmap) {
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    WritePendingCommands();
+    const UnmapEntry entry{
+        .address_space = unmap.address_space,
+        .gpu_addr = unmap.gpu_addr,
+        .size = unmap.size,
+    };
+    AppendEntry(pending, EntryType::Unmap, entry);
+}
+
+void GpuTraceRecorder::RecordCommands(s32 channel, GPUVAddr address,
+                                      std::span<const CommandHeader> commands) {
+    if (commands.empty()) {
+        return;
+    }
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    WritePendingCommands();
+    pending_commands = GpuTraceCommands{
+        .channel = channel,
+        .address = address,
+        .commands = std::vector<CommandHeader>(commands.begin(), commands.end()),
+    };
+    accessed_pages.clear();
+}
+
+void GpuTraceRecorder::RecordMemoryAccess(const MaxwellDeviceMemoryManager& memory,
+                                          DAddr address, size_t size) {
+    std::scoped_lock lock{mutex};
+    if (!file.IsOpen()) {
+        return;
+    }
+    const DAddr end = address + std::max<size_t>(size, 1);
+    for (DAddr page = address & ~Core::DEVICE_PAGEMASK; page < end;
+         page += Core::DEVICE_PAGESIZE) {
+        if (!accessed_pages.insert(page).second) {
+            continue;
+        }
+        const u8* const pointer = memory.GetPointer<u8>(page);
+        if (!pointer) {
+            continue;
+        }
+        const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(pointer),
+                                            Core::DEVICE_PAGESIZE);
+        const auto [it, is_new] = page_hashes.try_emplace(page, hash);
+        if (!is_new) {
+            if (it->second == hash) {
+                continue;
+            }
+            it->second = hash;
+        }
+        AppendEntry(pending, EntryType::Memory, MemoryEntry{page},
+                    std::span<const u8>(pointer, Core::DEVICE_PAGESIZE));
+    }
+    if (pending.size() >= CHUNK_SIZE) {
+        Flush();
+    }
+}
+
+void GpuTraceRecorder::WritePendingCommands() {
+    if (!pending_commands) {
+        return;
+    }
+    const CommandsEntry entry{
+        .channel = pending_commands->channel,
+        .num_commands = static_cast<u32>(pending_commands->commands.size()),
+        .address = pending_commands->address,
+    };
+    AppendEntry(pending, EntryType::Commands, entry,
+                std::span<const CommandHeader>(pending_commands->commands));
+    pending_commands.reset();
+    if (pending.size() >= CHUNK_SIZE) {
+        Flush();
+    }
+}
+
+void GpuTraceRecorder::Flush() {
+    if (!file.IsOpen() || pending.empty()) {
+        return;
+    }
+    const std::vector<u8> compressed =
+        Common::Compression::CompressDataZSTDDefault(pending.data(), pending.size());
+    const ChunkHeader header{
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .uncompressed_size = static_cast<u32>(pending.size()),
+    };
+    if (!file.WriteObject(header) || file.WriteSpan(std::span(compressed)) != compressed.size()) {
+        LOG_ERROR(HW_GPU, "Failed to write to the GPU trace file, stopping the recording");
+        file.Close();
+    }
+    pending.clear();
+}
+
+bool ReadGpuTrace(const std::filesystem::path& path, std::vector<GpuTraceEntry>& entries) {
+    Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read,
+                            Common::FS::FileType::BinaryFile};
+    FileHeader file_header{};
+    if (!file.IsOpen() || !file.ReadObject(file_header) || file_header.magic != TRACE_MAGIC) {
+        LOG_ERROR(HW_GPU, "{} is not a GPU trace file", Common::FS::PathToUTF8String(path));
+        return false;
+    }
+    if (file_header.version != TRACE_VERSION) {
+        LOG_ERROR(HW_GPU, "GPU trace {} has version {}, expected {}",
+                  Common::FS::PathToUTF8String(path), file_header.version, TRACE_VERSION);
+        return false;
+    }
+    const u64 file_size = file.GetSize();
+    std::vector<u8> compressed;
+    while (static_cast<u64>(file.Tell()) < file_size) {
+        ChunkHeader header;
+        if (!file.ReadObject(header) || header.compressed_size > MAX_CHUNK_SIZE ||
+            header.uncompressed_size > MAX_CHUNK_SIZE) {
+            LOG_WARNING(HW_GPU, "GPU trace is truncated");
+            break;
+        }
+        compressed.resize(header.compressed_size);
+        if (file.ReadSpan(std::span(compressed)) != compressed.size()) {
+            LOG_WARNING(HW_GPU, "GPU trace is truncated");
+            break;
+        }
+        const std::vector<u8> chunk = Common::Compression::DecompressDataZSTD(compressed);
+        if (chunk.size() != header.uncompressed_size || !ParseChunk(chunk, entries)) {
+            LOG_WARNING(HW_GPU, "GPU trace is corrupted");
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace Tegra
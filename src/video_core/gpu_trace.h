@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/pte_kind.h"
+
+namespace Tegra {
+
+/// Command words processed by the DMA pusher of a channel, in submission order
+struct GpuTraceCommands {
+    s32 channel;
+    /// GPU address the words were fetched from, zero for prefetched command lists
+    GPUVAddr address;
+    std::vector<CommandHeader> commands;
+};
+
+/// Layout of a GPU address space, recorded before any of its mappings
+struct GpuTraceAddressSpace {
+    u64 id;
+    u64 address_space_bits;
+    GPUVAddr split_address;
+    u64 big_page_bits;
+    u64 page_bits;
+};
+
+/// Channel that submits commands through an address space
+struct GpuTraceChannel {
+    s32 channel;
+    u64 address_space;
+};
+
+/// Range of an address space mapped to device memory, or reserved when it is sparse
+struct GpuTraceMap {
+    u64 address_space;
+    GPUVAddr gpu_addr;
+    DAddr device_addr;
+    u64 size;
+    PTEKind kind;
+    bool big_pages;
+    bool sparse;
+};
+
+/// Range of an address space that was unmapped
+struct GpuTraceUnmap {
+    u64 address_space;
+    GPUVAddr gpu_addr;
+    u64 size;
+};
+
+/// Contents of a device memory page before the GPU accessed it
+struct GpuTraceMemory {
+    DAddr device_addr;
+    std::vector<u8> data;
+};
+
+using GpuTraceEntry = std::variant<GpuTraceCommands, GpuTraceAddressSpace, GpuTraceChannel,
+                                   GpuTraceMap, GpuTraceUnmap, GpuTraceMemory>;
+
+/**
+ * Records the command stream processed by the DMA pushers into a trace file, so GPU frontend
+ * performance can be measured offline by replaying it.
+ *
+ * Besides the command words, the trace holds the layout and mappings of every address space the
+ * channels use, and the device memory pages the GPU accesses through them. A page is recorded the
+ * first time it is accessed by a command list, and again only when its contents changed since it
+ * was last recorded. Pages are written ahead of the command list being processed, so a replay can
+ * restore them before pushing it.
+ *
+ * Entries are buffered and appended to the file as zstd compressed chunks.
+ */
+class GpuTraceRecorder {
+public:
+    explicit GpuTraceRecorder(const std::filesystem::path& path);
+    ~GpuTraceRecorder();
+
+    GpuTraceRecorder(const GpuTraceRecorder&) = delete;
+    GpuTraceRecorder& operator=(const GpuTraceRecorder&) = delete;
+
+    /// Record the layout of an address space
+    void RecordAddressSpace(const GpuTraceAddressSpace& address_space);
+
+    /// Record the address space a channel submits commands through
+    void RecordChannel(s32 channel, u64 address_space);
+
+    /// Record a mapping of an address space
+    void RecordMap(const GpuTraceMap& map);
+
+    /// Record an unmapping of an address space
+    void RecordUnmap(const GpuTraceUnmap& unmap);
+
+    /// Record the command words a channel is about to process
+    void RecordCommands(s32 channel, GPUVAddr address, std::span<const CommandHeader> commands);
+
+    /// Record the device memory pages in a range the GPU is about to access
+    void RecordMemoryAccess(const MaxwellDeviceMemoryManager& memory, DAddr address, size_t size);
+
+private:
+    void WritePendingCommands();
+
+    void Flush();
+
+    Common::FS::IOFile file;
+    std::vector<u8> pending;
+
+    /// Command list being processed, written after the memory it accesses
+    std::optional<GpuTraceCommands> pending_commands;
+    /// Pages accessed by the command list being processed
+    std::unordered_set<DAddr> accessed_pages;
+    /// Hash of the last recorded contents of each page
+    std::unordered_map<DAddr, u64> page_hashes;
+
+    std::mutex mutex;
+};
+
+/// Read the entries of a trace file, stopping at the first truncated or corrupted chunk
+/// @retval False when the file could not be opened or is not a trace file
+[[nodiscard]] bool ReadGpuTrace(const std::filesystem::path& path,
+                                std::vector<GpuTraceEntry>& entries);
+
+} // namespace Tegra
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <optional>
@@ -18,6 +20,7 @@
 #include "video_core/macro/macro.h"
 #include "video_core/macro/macro_hle.h"
 #include "video_core/macro/macro_interpreter.h"
+#include "video_core/macro/macro_threaded_interpreter.h"
 
 #ifdef ARCHITECTURE_x86_64
 #include "video_core/macro/macro_jit_x64.h"
@@ -57,7 +60,9 @@ static void Dump(u64 hash, std::span<const u32> code, bool decompiled = false) {
 MacroEngine::MacroEngine(Engines::Maxwell3D& maxwell3d_)
     : hle_macros{std::make_unique<Tegra::HLEMacro>(maxwell3d_)}, maxwell3d{maxwell3d_} {}
 
-MacroEngine::~MacroEngine() = default;
+MacroEngine::~MacroEngine() {
+    LogStatistics();
+}
 
 void MacroEngine::AddCode(u32 method, u32 data) {
     uploaded_macro_code[method].push_back(data);
@@ -71,13 +76,12 @@ void MacroEngine::ClearCode(u32 method) {
 void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
     auto compiled_macro = macro_cache.find(method);
     if (compiled_macro != macro_cache.end()) {
-        const auto& cache_info = compiled_macro->second;
+        auto& cache_info = compiled_macro->second;
         if (cache_info.has_hle_program) {
             MICROPROFILE_SCOPE(MacroHLE);
             cache_info.hle_program->Execute(parameters, method);
         } else {
-            maxwell3d.RefreshParameters();
-            cache_info.lle_program->Execute(parameters, method);
+            ExecuteLLE(cache_info, parameters, method);
         }
     } else {
         // Macro not compiled, check if it's uploaded and if so, compile it
@@ -96,25 +100,27 @@ void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
             }
         }
         auto& cache_info = macro_cache[method];
+        std::span<const u32> code;
 
         if (!mid_method.has_value()) {
+            code = macro_code->second;
             cache_info.lle_program = Compile(macro_code->second);
             cache_info.hash = Common::HashValue(macro_code->second);
         } else {
             const auto& macro_cached = uploaded_macro_code[mid_method.value()];
             const auto rebased_method = method - mid_method.value();
-            auto& code = uploaded_macro_code[method];
-            code.resize(macro_cached.size() - rebased_method);
-            std::memcpy(code.data(), macro_cached.data() + rebased_method,
-                        code.size() * sizeof(u32));
-            cache_info.hash = Common::HashValue(code);
-            cache_info.lle_program = Compile(code);
+            auto& rebased_code = uploaded_macro_code[method];
+            rebased_code.resize(macro_cached.size() - rebased_method);
+            std::memcpy(rebased_code.data(), macro_cached.data() + rebased_method,
+                        rebased_code.size() * sizeof(u32));
+            code = rebased_code;
+            cache_info.hash = Common::HashValue(rebased_code);
+            cache_info.lle_program = Compile(rebased_code);
         }
 
-        auto hle_program = hle_macros->GetHLEProgram(cache_info.hash);
+        auto hle_program = hle_macros->GetHLEProgram(cache_info.hash, code);
         if (!hle_program || Settings::values.disable_macro_hle) {
-            maxwell3d.RefreshParameters();
-            cache_info.lle_program->Execute(parameters, method);
+            ExecuteLLE(cache_info, parameters, method);
         } else {
             cache_info.has_hle_program = true;
             cache_info.hle_program = std::move(hle_program);
@@ -123,20 +129,54 @@ void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
         }
 
         if (Settings::values.dump_macros) {
-            Dump(cache_info.hash, macro_code->second, cache_info.has_hle_program);
+            Dump(cache_info.hash, code, cache_info.has_hle_program);
         }
     }
 }
 
-std::unique_ptr<MacroEngine> GetMacroEngine(Engines::Maxwell3D& maxwell3d) {
-    if (Settings::values.disable_macro_jit) {
-        return std::make_unique<MacroInterpreter>(maxwell3d);
+void MacroEngine::ExecuteLLE(CacheInfo& cache_info, const std::vector<u32>& parameters,
+                             u32 method) {
+    maxwell3d.RefreshParameters();
+    const auto start{std::chrono::steady_clock::now()};
+    cache_info.lle_program->Execute(parameters, method);
+    cache_info.lle_time += std::chrono::steady_clock::now() - start;
+    ++cache_info.num_lle_calls;
+}
+
+void MacroEngine::LogStatistics() const {
+    std::vector<const CacheInfo*> lle_macros;
+    std::chrono::nanoseconds total_time{};
+    for (const auto& [method, cache_info] : macro_cache) {
+        if (cache_info.num_lle_calls != 0) {
+            lle_macros.push_back(&cache_info);
+            total_time += cache_info.lle_time;
+        }
+    }
+    if (lle_macros.empty()) {
+        return;
     }
+    std::ranges::sort(lle_macros, std::ranges::greater{}, &CacheInfo::lle_time);
+    const auto to_ms{[](std::chrono::nanoseconds time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }};
+    LOG_INFO(HW_GPU, "{} macros were executed without HLE, taking {:.3f} ms", lle_macros.size(),
+             to_ms(total_time));
+    for (const CacheInfo* const cache_info : lle_macros) {
+        LOG_INFO(HW_GPU, "Macro {:016x}: {} calls, {:.3f} ms", cache_info->hash,
+                 cache_info->num_lle_calls, to_ms(cache_info->lle_time));
+    }
+}
+
+std::unique_ptr<MacroEngine> GetMacroEngine(Engines::Maxwell3D& maxwell3d) {
 #ifdef ARCHITECTURE_x86_64
-    return std::make_unique<MacroJITx64>(maxwell3d);
-#else
-    return std::make_unique<MacroInterpreter>(maxwell3d);
+    if (!Settings::values.disable_macro_jit) {
+        return std::make_unique<MacroJITx64>(maxwell3d);
+    }
 #endif
+    if (Settings::values.disable_macro_optimizer) {
+        return std::make_unique<MacroInterpreter>(maxwell3d);
+    }
+    return std::make_unique<MacroThreadedInterpreter>(maxwell3d);
 }
 
 } // namespace Tegra
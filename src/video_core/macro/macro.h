@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -132,8 +133,16 @@ private:
         std::unique_ptr<CachedMacro> hle_program{};
         u64 hash{};
         bool has_hle_program{};
+        // Statistics of macros without HLE
+        u64 num_lle_calls{};
+        std::chrono::nanoseconds lle_time{};
     };
 
+    void ExecuteLLE(CacheInfo& cache_info, const std::vector<u32>& parameters, u32 method);
+
+    // Logs which macros ran without HLE and how long they took, slowest first
+    void LogStatistics() const;
+
     std::unordered_map<u32, CacheInfo> macro_cache;
     std::unordered_map<u32, std::vector<u32>> uploaded_macro_code;
     std::unique_ptr<HLEMacro> hle_macros;
@@ -1,15 +1,18 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include "common/assert.h"
+#include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "video_core/dirty_flags.h"
 #include "video_core/engines/draw_manager.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/macro/macro.h"
 #include "video_core/macro/macro_hle.h"
+#include "video_core/macro/macro_optimizer.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 
@@ -509,6 +512,82 @@ public:
     }
 };
 
+/// Generic replacement for macros that always write the same registers, see MatchRegisterWrites
+class HLE_RegisterWrites final : public HLEMacroImpl {
+public:
+    explicit HLE_RegisterWrites(Maxwell3D& maxwell3d_, Macro::RegisterWriteProgram program_)
+        : HLEMacroImpl(maxwell3d_), program{std::move(program_)} {}
+
+    void Execute(const std::vector<u32>& parameters, [[maybe_unused]] u32 method) override {
+        maxwell3d.RefreshParameters();
+        ASSERT_OR_EXECUTE(parameters.size() >= program.num_parameters, { return; });
+        for (const Macro::MacroWrite& write : program.writes) {
+            const u32 value = write.is_parameter ? parameters[write.value] : write.value;
+            maxwell3d.CallMethod(write.method, value, true);
+        }
+    }
+
+private:
+    Macro::RegisterWriteProgram program;
+};
+
+/// Generic replacement for macros that repeat writes over a count, see MatchRegisterWriteLoop
+class HLE_RegisterWriteLoop final : public HLEMacroImpl {
+public:
+    explicit HLE_RegisterWriteLoop(Maxwell3D& maxwell3d_,
+                                   Macro::RegisterWriteLoopProgram program_)
+        : HLEMacroImpl(maxwell3d_), program{std::move(program_)} {
+        // Parameters streamed to a const buffer data method are passed as a batch, like the DMA
+        // pusher does for non-incrementing methods. Other methods may run a macro or consume
+        // buffered data on each call, so they are kept as separate calls.
+        if (program.iteration.size() == 1) {
+            const Macro::LoopWrite& write = program.iteration[0];
+            is_batched = write.write.is_parameter && write.method_step == 0 &&
+                         write.value_step == 1 &&
+                         Macro::IsConstBufferDataMethod(write.write.method);
+        }
+    }
+
+    void Execute(const std::vector<u32>& parameters, [[maybe_unused]] u32 method) override {
+        maxwell3d.RefreshParameters();
+        ASSERT_OR_EXECUTE(parameters.size() > program.count_parameter, { return; });
+        const u32 count = parameters[program.count_parameter];
+        // The macro would loop until it runs out of parameters
+        ASSERT_OR_EXECUTE(count >= program.min_count, { return; });
+        const u32 num_iterations = count + static_cast<u32>(program.count_bias);
+        const u64 num_parameters =
+            program.num_parameters + u64{program.parameter_step} * num_iterations;
+        ASSERT_OR_EXECUTE(parameters.size() >= num_parameters, { return; });
+
+        for (const Macro::MacroWrite& write : program.prologue) {
+            Write(parameters, write);
+        }
+        if (is_batched && num_iterations > 0) {
+            const Macro::MacroWrite& write = program.iteration[0].write;
+            maxwell3d.CallMultiMethod(write.method, parameters.data() + write.value,
+                                      num_iterations, num_iterations);
+        } else {
+            for (u32 iteration = 0; iteration < num_iterations; ++iteration) {
+                for (const Macro::LoopWrite& write : program.iteration) {
+                    Write(parameters, write.Advance(iteration));
+                }
+            }
+        }
+        for (const Macro::LoopWrite& write : program.epilogue) {
+            Write(parameters, write.Advance(num_iterations));
+        }
+    }
+
+private:
+    void Write(const std::vector<u32>& parameters, const Macro::MacroWrite& write) {
+        const u32 value = write.is_parameter ? parameters[write.value] : write.value;
+        maxwell3d.CallMethod(write.method, value, true);
+    }
+
+    Macro::RegisterWriteLoopProgram program;
+    bool is_batched{};
+};
+
 } // Anonymous namespace
 
 HLEMacro::HLEMacro(Maxwell3D& maxwell3d_) : maxwell3d{maxwell3d_} {
@@ -592,12 +671,27 @@ HLEMacro::HLEMacro(Maxwell3D& maxwell3d_) : maxwell3d{maxwell3d_} {
 
 HLEMacro::~HLEMacro() = default;
 
-std::unique_ptr<CachedMacro> HLEMacro::GetHLEProgram(u64 hash) const {
+std::unique_ptr<CachedMacro> HLEMacro::GetHLEProgram(u64 hash, std::span<const u32> code) const {
     const auto it = builders.find(hash);
-    if (it == builders.end()) {
-        return nullptr;
+    if (it != builders.end()) {
+        return it->second(maxwell3d);
+    }
+    // Unknown macros are classified by structure
+    if (auto program = Macro::MatchRegisterWrites(code)) {
+        LOG_DEBUG(HW_GPU, "Macro {:016x} matched as {} register writes", hash,
+                  program->writes.size());
+        return std::make_unique<HLE_RegisterWrites>(maxwell3d, std::move(*program));
+    }
+    if (auto program = Macro::MatchRegisterWriteLoop(code)) {
+        const bool is_draw = std::ranges::any_of(program->iteration, [](const auto& write) {
+            return Macro::IsDrawMethod(write.write.method);
+        });
+        LOG_DEBUG(HW_GPU, "Macro {:016x} matched as a {} loop of {} writes over parameter {}",
+                  hash, is_draw ? "draw" : "register write", program->iteration.size(),
+                  program->count_parameter);
+        return std::make_unique<HLE_RegisterWriteLoop>(maxwell3d, std::move(*program));
     }
-    return it->second(maxwell3d);
+    return nullptr;
 }
 
 } // namespace Tegra
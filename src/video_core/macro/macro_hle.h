@@ -5,6 +5,7 @@
 
 #include <functional>
 #include <memory>
+#include <span>
 #include <unordered_map>
 
 #include "common/common_types.h"
@@ -20,9 +21,10 @@ public:
     explicit HLEMacro(Engines::Maxwell3D& maxwell3d_);
     ~HLEMacro();
 
-    // Allocates and returns a cached macro if the hash matches a known function.
-    // Returns nullptr otherwise.
-    [[nodiscard]] std::unique_ptr<CachedMacro> GetHLEProgram(u64 hash) const;
+    // Allocates and returns a cached macro if the hash matches a known function, or if the code
+    // has the structure of a generic replacement. Returns nullptr otherwise.
+    [[nodiscard]] std::unique_ptr<CachedMacro> GetHLEProgram(u64 hash,
+                                                             std::span<const u32> code) const;
 
 private:
     Engines::Maxwell3D& maxwell3d;
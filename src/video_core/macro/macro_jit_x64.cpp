@@ -11,11 +11,13 @@
 #include "common/bit_field.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/settings.h"
 #include "common/x64/xbyak_abi.h"
 #include "common/x64/xbyak_util.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/macro/macro_interpreter.h"
 #include "video_core/macro/macro_jit_x64.h"
+#include "video_core/macro/macro_optimizer.h"
 
 MICROPROFILE_DEFINE(MacroJitCompile, "GPU", "Compile macro JIT", MP_RGB(173, 255, 47));
 MICROPROFILE_DEFINE(MacroJitExecute, "GPU", "Execute macro JIT", MP_RGB(255, 255, 0));
@@ -63,9 +65,10 @@ public:
     void Compile_Branch(Macro::Opcode opcode);
 
 private:
-    void Optimizer_ScanFlags();
+    void Optimizer_Analyze();
 
     void Compile();
+    void Compile_Operation(Macro::Opcode opcode);
     bool Compile_NextInstruction();
 
     Xbyak::Reg32 Compile_FetchParameter();
@@ -93,6 +96,7 @@ private:
         bool enable_asserts{};
     };
     OptimizerState optimizer{};
+    Macro::MacroAnalysis analysis{};
 
     std::optional<Macro::Opcode> next_opcode{};
     ProgramType program{nullptr};
@@ -424,27 +428,17 @@ void MacroJITx64Impl::Compile_Branch(Macro::Opcode opcode) {
     L(end);
 }
 
-void MacroJITx64Impl::Optimizer_ScanFlags() {
-    optimizer.can_skip_carry = true;
-    optimizer.has_delayed_pc = false;
-    for (auto raw_op : code) {
-        Macro::Opcode op{};
-        op.raw = raw_op;
-
-        if (op.operation == Macro::Operation::ALU) {
-            // Scan for any ALU operations which actually use the carry flag, if they don't exist in
-            // our current code we can skip emitting the carry flag handling operations
-            if (op.alu_operation == Macro::ALUOperation::AddWithCarry ||
-                op.alu_operation == Macro::ALUOperation::SubtractWithBorrow) {
-                optimizer.can_skip_carry = false;
-            }
-        }
+void MacroJITx64Impl::Optimizer_Analyze() {
+    analysis = Macro::AnalyzeMacro(code);
 
-        if (op.operation == Macro::Operation::Branch) {
-            if (!op.branch_annul) {
-                optimizer.has_delayed_pc = true;
-            }
-        }
+    // If no ALU operation actually uses the carry flag, we can skip emitting the carry flag
+    // handling operations
+    optimizer.can_skip_carry = !analysis.uses_carry;
+    optimizer.has_delayed_pc = analysis.has_delayed_branch;
+
+    if (Settings::values.disable_macro_optimizer) {
+        // Forget what was proven about each instruction, emitting them as they are
+        analysis.instructions.assign(code.size(), {});
     }
 }
 
@@ -477,8 +471,9 @@ void MacroJITx64Impl::Compile() {
     // Enable run-time assertions in JITted code
     optimizer.enable_asserts = false;
 
-    // Check to see if we can skip emitting certain instructions
-    Optimizer_ScanFlags();
+    // Check to see if we can skip emitting certain instructions, find constant results and
+    // register writes that are never read
+    Optimizer_Analyze();
 
     const u32 op_count = static_cast<u32>(code.size());
     for (u32 i = 0; i < op_count; i++) {
@@ -500,14 +495,7 @@ void MacroJITx64Impl::Compile() {
     program = getCode<ProgramType>();
 }
 
-bool MacroJITx64Impl::Compile_NextInstruction() {
-    const auto opcode = GetOpCode();
-    if (labels[pc].getAddress()) {
-        return false;
-    }
-
-    L(labels[pc]);
-
+void MacroJITx64Impl::Compile_Operation(Macro::Opcode opcode) {
     switch (opcode.operation) {
     case Macro::Operation::ALU:
         Compile_ALU(opcode);
@@ -534,6 +522,30 @@ bool MacroJITx64Impl::Compile_NextInstruction() {
         UNIMPLEMENTED_MSG("Unimplemented opcode {}", opcode.operation.Value());
         break;
     }
+}
+
+bool MacroJITx64Impl::Compile_NextInstruction() {
+    const auto opcode = GetOpCode();
+    if (labels[pc].getAddress()) {
+        return false;
+    }
+
+    L(labels[pc]);
+
+    const Macro::InstructionInfo& info{analysis.instructions[pc]};
+    const bool is_branch{opcode.operation == Macro::Operation::Branch};
+    if (!is_branch && info.is_nop) {
+        // The instruction has no observable effect, nothing to emit
+    } else if (!is_branch && info.constant) {
+        if (*info.constant == 0) {
+            xor_(RESULT, RESULT);
+        } else {
+            mov(RESULT, *info.constant);
+        }
+        Compile_ProcessResult(opcode.result_operation, opcode.dst);
+    } else {
+        Compile_Operation(opcode);
+    }
 
     if (optimizer.has_delayed_pc) {
         if (opcode.is_exit) {
@@ -606,6 +618,10 @@ void MacroJITx64Impl::Compile_ProcessResult(Macro::ResultOperation operation, u3
         if (reg_index == 0) {
             return;
         }
+        // Skip stores to registers that are never read again
+        if (analysis.instructions[pc].dead_store) {
+            return;
+        }
         mov(dword[STATE + offsetof(JITState, registers) + reg_index * sizeof(u32)], result);
     };
     const auto SetMethodAddress = [this](const Xbyak::Reg32& reg32) { mov(METHOD_ADDRESS, reg32); };
@@ -0,0 +1,1012 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <boost/container/static_vector.hpp>
+
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro/macro.h"
+#include "video_core/macro/macro_optimizer.h"
+
+namespace Tegra::Macro {
+namespace {
+using Engines::Maxwell3D;
+
+constexpr u32 CB_DATA_METHOD = MAXWELL3D_REG_INDEX(const_buffer.buffer);
+constexpr u32 NUM_CB_DATA_METHODS = 16;
+
+/// Method addresses wrap around at 12 bits
+constexpr u32 METHOD_MASK = 0xFFF;
+
+/// Parameters tried as the count of a write loop
+constexpr u32 MAX_COUNT_PARAMETER = 4;
+/// Counts a write loop is executed with to fit its program, ascending. RunSymbolic proves that
+/// the other counts behave the same way.
+constexpr std::array<u32, 12> SAMPLE_COUNTS{0, 1, 2, 3, 4, 5, 6, 7, 9, 12, 17, 24};
+constexpr size_t MIN_SAMPLES = 8;
+constexpr size_t MAX_ITERATION_WRITES = 32;
+/// Bounds symbolic execution, loops over a sampled count take a few steps per instruction
+constexpr size_t MAX_STEPS_PER_INSTRUCTION = 64;
+
+/// Element of the constant propagation lattice
+struct LatticeValue {
+    enum class Kind : u8 {
+        Undefined,
+        Constant,
+        Varying,
+    };
+
+    [[nodiscard]] static LatticeValue MakeConstant(u32 value) {
+        return {.kind = Kind::Constant, .value = value};
+    }
+
+    [[nodiscard]] static LatticeValue MakeVarying() {
+        return {.kind = Kind::Varying};
+    }
+
+    [[nodiscard]] bool IsConstant() const {
+        return kind == Kind::Constant;
+    }
+
+    /// Merges a value flowing from another path, returns true when the value changed
+    bool Meet(const LatticeValue& other) {
+        if (other.kind == Kind::Undefined || kind == Kind::Varying) {
+            return false;
+        }
+        if (kind == Kind::Undefined) {
+            *this = other;
+            return true;
+        }
+        if (other.kind == Kind::Constant && other.value == value) {
+            return false;
+        }
+        *this = MakeVarying();
+        return true;
+    }
+
+    Kind kind{Kind::Undefined};
+    u32 value{};
+};
+
+struct State {
+    /// Merges the state of a predecessor, returns true when the state changed
+    bool Meet(const State& other) {
+        if (!reached) {
+            *this = other;
+            return true;
+        }
+        bool changed{method_address.Meet(other.method_address)};
+        for (size_t index = 0; index < registers.size(); ++index) {
+            changed |= registers[index].Meet(other.registers[index]);
+        }
+        return changed;
+    }
+
+    std::array<LatticeValue, NUM_MACRO_REGISTERS> registers{};
+    LatticeValue method_address;
+    bool reached{};
+};
+
+bool IsCarryOperation(ALUOperation operation) {
+    switch (operation) {
+    case ALUOperation::Add:
+    case ALUOperation::AddWithCarry:
+    case ALUOperation::Subtract:
+    case ALUOperation::SubtractWithBorrow:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Returns true when the operation part of an instruction has effects besides its result
+bool HasSideEffects(Opcode opcode, bool uses_carry) {
+    switch (opcode.operation) {
+    case Operation::ALU:
+        return uses_carry && IsCarryOperation(opcode.alu_operation);
+    case Operation::AddImmediate:
+    case Operation::ExtractInsert:
+    case Operation::ExtractShiftLeftImmediate:
+    case Operation::ExtractShiftLeftRegister:
+    case Operation::Read:
+        return false;
+    default:
+        return true;
+    }
+}
+
+u8 RegisterMask(u32 reg) {
+    // Register 0 is hardwired to zero, it never carries a value between instructions
+    return reg == 0 ? 0 : static_cast<u8>(1U << reg);
+}
+
+u8 ReadRegisters(Opcode opcode) {
+    switch (opcode.operation) {
+    case Operation::ALU:
+    case Operation::ExtractInsert:
+    case Operation::ExtractShiftLeftImmediate:
+    case Operation::ExtractShiftLeftRegister:
+        return RegisterMask(opcode.src_a) | RegisterMask(opcode.src_b);
+    case Operation::AddImmediate:
+    case Operation::Read:
+    case Operation::Branch:
+        return RegisterMask(opcode.src_a);
+    default:
+        return 0;
+    }
+}
+
+bool WritesRegister(Opcode opcode) {
+    return opcode.operation != Operation::Branch && opcode.operation != Operation::Unused &&
+           opcode.dst != 0;
+}
+
+std::vector<std::vector<u32>> BuildSuccessors(std::span<const u32> code) {
+    const size_t size{code.size()};
+    std::vector<std::vector<u32>> successors(size);
+    const auto branch_target{[&](size_t index) -> std::optional<u32> {
+        const Opcode opcode{code[index]};
+        const s64 target{static_cast<s64>(index) + opcode.immediate};
+        if (target < 0 || target >= static_cast<s64>(size)) {
+            return std::nullopt;
+        }
+        return static_cast<u32>(target);
+    }};
+    for (size_t index = 0; index < size; ++index) {
+        const Opcode opcode{code[index]};
+        auto& list{successors[index]};
+        // Fall through, taken delay slots and the delay slot of exits are also the next
+        // instruction. Treating exit delay slots as falling through is conservative.
+        if (index + 1 < size) {
+            list.push_back(static_cast<u32>(index + 1));
+        }
+        if (opcode.operation == Operation::Branch) {
+            if (opcode.branch_annul) {
+                if (const auto target{branch_target(index)}) {
+                    list.push_back(*target);
+                }
+            }
+            continue;
+        }
+        if (index > 0) {
+            const Opcode previous{code[index - 1]};
+            if (previous.operation == Operation::Branch && !previous.branch_annul) {
+                // The delay slot of a taken branch continues at the branch target
+                if (const auto target{branch_target(index - 1)}) {
+                    list.push_back(*target);
+                }
+            }
+        }
+    }
+    return successors;
+}
+
+LatticeValue EvaluateResult(Opcode opcode, const State& state, bool uses_carry) {
+    const LatticeValue& src_a{state.registers[opcode.src_a]};
+    const LatticeValue& src_b{state.registers[opcode.src_b]};
+    bool is_foldable{};
+    switch (opcode.operation) {
+    case Operation::ALU:
+        is_foldable = src_a.IsConstant() && src_b.IsConstant() &&
+                      !(uses_carry && IsCarryOperation(opcode.alu_operation));
+        break;
+    case Operation::AddImmediate:
+        is_foldable = src_a.IsConstant();
+        break;
+    case Operation::ExtractInsert:
+    case Operation::ExtractShiftLeftImmediate:
+    case Operation::ExtractShiftLeftRegister:
+        is_foldable = src_a.IsConstant() && src_b.IsConstant();
+        break;
+    default:
+        break;
+    }
+    if (is_foldable) {
+        if (const auto result{EvaluateOperation(opcode.raw, src_a.value, src_b.value)}) {
+            return LatticeValue::MakeConstant(*result);
+        }
+    }
+    return LatticeValue::MakeVarying();
+}
+
+void Send(State& state, InstructionInfo* info) {
+    if (!state.method_address.IsConstant()) {
+        return;
+    }
+    MethodAddress method_address{.raw = state.method_address.value};
+    if (info) {
+        const u32 method{method_address.address};
+        info->batchable_send = method_address.increment == 0 && IsConstBufferDataMethod(method);
+    }
+    method_address.address.Assign(method_address.address.Value() +
+                                   method_address.increment.Value());
+    state.method_address = LatticeValue::MakeConstant(method_address.raw);
+}
+
+/// Applies the effects of an instruction to the state, optionally recording facts about it
+void Transfer(Opcode opcode, State& state, bool uses_carry, InstructionInfo* info) {
+    if (opcode.operation == Operation::Branch || opcode.operation == Operation::Unused) {
+        return;
+    }
+    const LatticeValue result{EvaluateResult(opcode, state, uses_carry)};
+    const LatticeValue fetched{LatticeValue::MakeVarying()};
+    LatticeValue& dst{state.registers[opcode.dst]};
+    switch (opcode.result_operation) {
+    case ResultOperation::IgnoreAndFetch:
+        dst = fetched;
+        break;
+    case ResultOperation::Move:
+        dst = result;
+        break;
+    case ResultOperation::MoveAndSetMethod:
+        dst = result;
+        state.method_address = result;
+        break;
+    case ResultOperation::FetchAndSend:
+        dst = fetched;
+        Send(state, info);
+        break;
+    case ResultOperation::MoveAndSend:
+        dst = result;
+        Send(state, info);
+        break;
+    case ResultOperation::FetchAndSetMethod:
+        dst = fetched;
+        state.method_address = result;
+        break;
+    case ResultOperation::MoveAndSetMethodFetchAndSend:
+    case ResultOperation::MoveAndSetMethodSend:
+        dst = result;
+        state.method_address = result;
+        Send(state, info);
+        break;
+    }
+    // Register 0 always reads as zero
+    state.registers[0] = LatticeValue::MakeConstant(0);
+}
+
+/// Value of a register while matching register writes
+struct SymbolicValue {
+    enum class Kind : u8 {
+        Constant,
+        Parameter,
+        Unknown,
+    };
+
+    [[nodiscard]] bool IsInvariantZero() const {
+        return kind == Kind::Constant && value == 0 && count_factor == 0 && !is_varying;
+    }
+
+    Kind kind{Kind::Constant};
+    /// Constant value or parameter index
+    u32 value{};
+    /// Multiple of the concrete parameter added to the constant, see RunSymbolic
+    u32 count_factor{};
+    /// Constant computed from a register that changes between loop iterations
+    bool is_varying{};
+};
+
+SymbolicValue EvaluateSymbolic(Opcode opcode,
+                               const std::array<SymbolicValue, NUM_MACRO_REGISTERS>& registers) {
+    using Kind = SymbolicValue::Kind;
+    const SymbolicValue& src_a{registers[opcode.src_a]};
+    const SymbolicValue& src_b{registers[opcode.src_b]};
+    const bool is_a_zero{src_a.IsInvariantZero()};
+    const bool is_b_zero{src_b.IsInvariantZero()};
+    switch (opcode.operation) {
+    case Operation::ALU:
+    case Operation::ExtractInsert:
+    case Operation::ExtractShiftLeftImmediate:
+    case Operation::ExtractShiftLeftRegister:
+        if (src_a.kind == Kind::Constant && src_b.kind == Kind::Constant) {
+            const bool is_count_derived{src_a.count_factor != 0 || src_b.count_factor != 0};
+            const bool is_varying{src_a.is_varying || src_b.is_varying};
+            const bool is_add{opcode.operation == Operation::ALU &&
+                              opcode.alu_operation == ALUOperation::Add};
+            const bool is_subtract{opcode.operation == Operation::ALU &&
+                                   opcode.alu_operation == ALUOperation::Subtract};
+            // Masks and shifts of the count or of a loop variable would only match the sampled
+            // counts and iterations
+            if ((is_count_derived || is_varying) && !is_add && !is_subtract) {
+                return {.kind = Kind::Unknown};
+            }
+            if (const auto result{EvaluateOperation(opcode.raw, src_a.value, src_b.value)}) {
+                return {
+                    .kind = Kind::Constant,
+                    .value = *result,
+                    .count_factor = is_subtract ? src_a.count_factor - src_b.count_factor
+                                                : src_a.count_factor + src_b.count_factor,
+                    .is_varying = is_varying,
+                };
+            }
+            return {.kind = Kind::Unknown};
+        }
+        if (opcode.operation != Operation::ALU) {
+            return {.kind = Kind::Unknown};
+        }
+        // Copies of a parameter through an operation with zero
+        switch (opcode.alu_operation) {
+        case ALUOperation::Add:
+        case ALUOperation::Or:
+        case ALUOperation::Xor:
+            if (src_a.kind == Kind::Parameter && is_b_zero) {
+                return src_a;
+            }
+            if (src_b.kind == Kind::Parameter && is_a_zero) {
+                return src_b;
+            }
+            return {.kind = Kind::Unknown};
+        case ALUOperation::Subtract:
+            if (src_a.kind == Kind::Parameter && is_b_zero) {
+                return src_a;
+            }
+            return {.kind = Kind::Unknown};
+        default:
+            return {.kind = Kind::Unknown};
+        }
+    case Operation::AddImmediate:
+        if (src_a.kind == Kind::Constant) {
+            return {
+                .kind = Kind::Constant,
+                .value = src_a.value + static_cast<u32>(opcode.immediate.Value()),
+                .count_factor = src_a.count_factor,
+                .is_varying = src_a.is_varying,
+            };
+        }
+        if (src_a.kind == Kind::Parameter && opcode.immediate == 0) {
+            return src_a;
+        }
+        return {.kind = Kind::Unknown};
+    default:
+        return {.kind = Kind::Unknown};
+    }
+}
+
+/// Parameter given a concrete value while executing a macro symbolically
+struct ConcreteParameter {
+    u32 index;
+    u32 value;
+};
+
+/// Writes of a macro executed with symbolic parameters
+struct SymbolicRun {
+    std::vector<MacroWrite> writes;
+    u32 num_parameters{};
+    /// Branch that exits the loop, the only one testing the concrete parameter
+    std::optional<size_t> loop_test_pc;
+    /// Value the first loop exit test compares against zero, minus the concrete parameter
+    u32 loop_test_offset{};
+};
+
+/// Symbolic state when the loop exit test is evaluated
+struct LoopTestState {
+    std::array<SymbolicValue, NUM_MACRO_REGISTERS> registers;
+    MethodAddress method_address;
+    bool is_method_known;
+    u32 num_parameters;
+};
+
+/// Returns true when a, b and c advance by the same amount, wrapping around at the mask
+bool IsLinear(u32 a, u32 b, u32 c, u32 mask = 0xFFFFFFFF) {
+    return ((b - a) & mask) == ((c - b) & mask);
+}
+
+/// Returns true when the state advances by the same amount between the three loop tests, so the
+/// loop body applies the same linear update on every iteration
+bool IsLinear(const LoopTestState& a, const LoopTestState& b, const LoopTestState& c) {
+    using Kind = SymbolicValue::Kind;
+    for (size_t index = 0; index < NUM_MACRO_REGISTERS; ++index) {
+        const SymbolicValue& value_a{a.registers[index]};
+        const SymbolicValue& value_b{b.registers[index]};
+        const SymbolicValue& value_c{c.registers[index]};
+        if (value_a.kind == Kind::Unknown || value_b.kind == Kind::Unknown ||
+            value_c.kind == Kind::Unknown) {
+            // Any use of an unknown value is rejected
+            continue;
+        }
+        if (value_a.kind != value_b.kind || value_b.kind != value_c.kind ||
+            value_a.count_factor != value_b.count_factor ||
+            value_b.count_factor != value_c.count_factor ||
+            !IsLinear(value_a.value, value_b.value, value_c.value)) {
+            return false;
+        }
+    }
+    if (a.is_method_known != b.is_method_known || b.is_method_known != c.is_method_known) {
+        return false;
+    }
+    if (a.is_method_known &&
+        (a.method_address.increment != b.method_address.increment ||
+         b.method_address.increment != c.method_address.increment ||
+         !IsLinear(a.method_address.address, b.method_address.address,
+                   c.method_address.address, METHOD_MASK))) {
+        return false;
+    }
+    return IsLinear(a.num_parameters, b.num_parameters, c.num_parameters);
+}
+
+enum class RunResult {
+    Exited,
+    /// The macro reads engine state, branches on a symbolic value or runs out of its code
+    Unsupported,
+    /// The macro did not exit within the step limit
+    StepLimit,
+};
+
+/**
+ * Executes a macro with symbolic parameters, following the branches that only depend on constants
+ * or on the concrete parameter. The concrete parameter may only be added to or subtracted from.
+ *
+ * With a concrete parameter, the run is rejected unless it proves that the macro behaves the same
+ * way for every value of the parameter that exits, besides the number of loop iterations:
+ * - A single branch, the loop exit test, tests a value derived from the parameter. That value is
+ *   the parameter plus a constant, it decreases by one between tests and the last test sees zero.
+ * - Registers, the method address and the fetched parameters advance by the same amount between
+ *   every two loop tests after the first, so the loop body applies the same linear update on
+ *   every iteration.
+ * - Registers that change between loop tests are only added to or subtracted from, and branches
+ *   never test them.
+ * Together, these make the control flow of every iteration the same and the writes advance
+ * linearly, so a loop program fitted to a few counts holds for all of them.
+ */
+RunResult RunSymbolic(std::span<const u32> code, std::optional<ConcreteParameter> concrete,
+                      SymbolicRun& run) {
+    using Kind = SymbolicValue::Kind;
+    const auto make_parameter{[&](u32 index) {
+        if (concrete && concrete->index == index) {
+            return SymbolicValue{
+                .kind = Kind::Constant,
+                .value = concrete->value,
+                .count_factor = 1,
+            };
+        }
+        return SymbolicValue{.kind = Kind::Parameter, .value = index};
+    }};
+    run.num_parameters = 1;
+    std::array<SymbolicValue, NUM_MACRO_REGISTERS> registers{};
+    registers[1] = make_parameter(0);
+    MethodAddress method_address{.raw = 0};
+    bool is_method_known{true};
+
+    const auto fetch{[&] { return make_parameter(run.num_parameters++); }};
+    const auto send{[&](const SymbolicValue& value) {
+        if (!is_method_known || value.kind == Kind::Unknown) {
+            return false;
+        }
+        run.writes.push_back({
+            .method = method_address.address,
+            .value = value.value,
+            .is_parameter = value.kind == Kind::Parameter,
+        });
+        method_address.address.Assign(method_address.address.Value() +
+                                      method_address.increment.Value());
+        return true;
+    }};
+    const auto execute{[&](Opcode opcode) {
+        switch (opcode.operation) {
+        case Operation::ALU:
+            if (opcode.alu_operation == ALUOperation::AddWithCarry ||
+                opcode.alu_operation == ALUOperation::SubtractWithBorrow) {
+                return false;
+            }
+            break;
+        case Operation::AddImmediate:
+        case Operation::ExtractInsert:
+        case Operation::ExtractShiftLeftImmediate:
+        case Operation::ExtractShiftLeftRegister:
+            break;
+        default:
+            // Reads depend on engine state, branches are handled by the caller
+            return false;
+        }
+        const SymbolicValue result{EvaluateSymbolic(opcode, registers)};
+        // Increments are bits of the value, so the method may only be set to invariant values
+        const bool is_invariant{result.kind == Kind::Constant && result.count_factor == 0 &&
+                                !result.is_varying};
+        const auto set_method{[&] {
+            is_method_known = is_invariant;
+            method_address.raw = result.value;
+        }};
+        SymbolicValue& dst{registers[opcode.dst]};
+        bool is_valid{true};
+        switch (opcode.result_operation) {
+        case ResultOperation::IgnoreAndFetch:
+            dst = fetch();
+            break;
+        case ResultOperation::Move:
+            dst = result;
+            break;
+        case ResultOperation::MoveAndSetMethod:
+            dst = result;
+            set_method();
+            break;
+        case ResultOperation::FetchAndSend:
+            dst = fetch();
+            is_valid = send(result);
+            break;
+        case ResultOperation::MoveAndSend:
+            dst = result;
+            is_valid = send(result);
+            break;
+        case ResultOperation::FetchAndSetMethod:
+            dst = fetch();
+            set_method();
+            break;
+        case ResultOperation::MoveAndSetMethodFetchAndSend:
+            dst = result;
+            set_method();
+            is_valid = send(fetch());
+            break;
+        case ResultOperation::MoveAndSetMethodSend:
+            dst = result;
+            set_method();
+            is_valid = is_invariant &&
+                       send({.kind = Kind::Constant, .value = (result.value >> 12) & 0b111111});
+            break;
+        }
+        // Register 0 always reads as zero
+        registers[0] = {};
+        return is_valid;
+    }};
+    // Delay slots can't branch, an exit flag in them is ignored
+    const auto execute_delay_slot{[&](size_t pc) {
+        return pc < code.size() && Opcode{code[pc]}.operation != Operation::Branch &&
+               execute(Opcode{code[pc]});
+    }};
+
+    // The last three loop tests, the newest one at the back
+    boost::container::static_vector<LoopTestState, 3> loop_tests;
+    size_t num_loop_tests{};
+    u32 loop_test_value{};
+    const auto test_loop{[&](size_t pc, const SymbolicValue& value) {
+        if (run.loop_test_pc && *run.loop_test_pc != pc) {
+            return false;
+        }
+        if (value.count_factor != 1) {
+            return false;
+        }
+        if (!run.loop_test_pc) {
+            run.loop_test_pc = pc;
+            run.loop_test_offset = value.value - concrete->value;
+        } else if (value.value != loop_test_value - 1) {
+            return false;
+        }
+        loop_test_value = value.value;
+        if (loop_tests.size() == loop_tests.capacity()) {
+            loop_tests.erase(loop_tests.begin());
+        }
+        loop_tests.push_back({
+            .registers = registers,
+            .method_address = method_address,
+            .is_method_known = is_method_known,
+            .num_parameters = run.num_parameters,
+        });
+        // The first iteration starts from the registers set before the loop, so it is excluded
+        if (++num_loop_tests > 3 && !IsLinear(loop_tests[0], loop_tests[1], loop_tests[2])) {
+            return false;
+        }
+        if (loop_tests.size() >= 2) {
+            // Registers changed by the loop body must not reach masks, shifts or branches
+            const LoopTestState& previous{loop_tests[loop_tests.size() - 2]};
+            for (size_t index = 0; index < NUM_MACRO_REGISTERS; ++index) {
+                SymbolicValue& reg{registers[index]};
+                if (reg.kind != previous.registers[index].kind ||
+                    reg.value != previous.registers[index].value) {
+                    reg.is_varying = true;
+                }
+            }
+        }
+        return true;
+    }};
+
+    const size_t max_steps{(code.size() + 1) * MAX_STEPS_PER_INSTRUCTION};
+    size_t pc{};
+    for (size_t step = 0; step < max_steps; ++step) {
+        if (pc >= code.size()) {
+            return RunResult::Unsupported;
+        }
+        const Opcode opcode{code[pc]};
+        if (opcode.operation == Operation::Branch) {
+            const SymbolicValue& value{registers[opcode.src_a]};
+            if (value.kind != Kind::Constant) {
+                return RunResult::Unsupported;
+            }
+            if (value.count_factor != 0) {
+                if (!test_loop(pc, value)) {
+                    return RunResult::Unsupported;
+                }
+            } else if (value.is_varying) {
+                return RunResult::Unsupported;
+            }
+            const bool is_zero{value.value == 0};
+            const bool taken{opcode.branch_condition == BranchCondition::Zero ? is_zero
+                                                                              : !is_zero};
+            if (taken) {
+                const s64 target{static_cast<s64>(pc) + opcode.immediate};
+                if (target < 0 || target >= static_cast<s64>(code.size())) {
+                    return RunResult::Unsupported;
+                }
+                if (!opcode.branch_annul && !execute_delay_slot(pc + 1)) {
+                    return RunResult::Unsupported;
+                }
+                pc = static_cast<size_t>(target);
+                continue;
+            }
+        } else if (!execute(opcode)) {
+            return RunResult::Unsupported;
+        }
+        if (opcode.is_exit) {
+            // Exit has a delay slot, execute the next instruction
+            if (!execute_delay_slot(pc + 1)) {
+                return RunResult::Unsupported;
+            }
+            // The loop exits when the test sees zero, other values may never exit
+            if (run.loop_test_pc && loop_test_value != 0) {
+                return RunResult::Unsupported;
+            }
+            return RunResult::Exited;
+        }
+        ++pc;
+    }
+    return RunResult::StepLimit;
+}
+
+/// Writes of a macro executed with the count parameter set to a concrete value
+struct CountSample {
+    u32 count;
+    SymbolicRun run;
+};
+
+/// Writes a loop program makes for a number of iterations, with the parameter count it uses
+std::pair<std::vector<MacroWrite>, u32> ExpandWriteLoop(const RegisterWriteLoopProgram& program,
+                                                        u32 num_iterations) {
+    std::vector<MacroWrite> writes{program.prologue};
+    for (u32 iteration = 0; iteration < num_iterations; ++iteration) {
+        for (const LoopWrite& write : program.iteration) {
+            writes.push_back(write.Advance(iteration));
+        }
+    }
+    for (const LoopWrite& write : program.epilogue) {
+        writes.push_back(write.Advance(num_iterations));
+    }
+    return {std::move(writes), program.num_parameters + program.parameter_step * num_iterations};
+}
+
+/// Finds how a write advances between two points of a loop, nullopt when it doesn't advance
+/// linearly or changes between a constant and a parameter
+std::optional<LoopWrite> FitLoopWrite(const MacroWrite& write, u32 position,
+                                      const MacroWrite& next, u32 next_position) {
+    if (write.is_parameter != next.is_parameter) {
+        return std::nullopt;
+    }
+    const s64 distance{static_cast<s64>(next_position) - static_cast<s64>(position)};
+    const s64 method_delta{static_cast<s64>(next.method) - static_cast<s64>(write.method)};
+    const s64 value_delta{static_cast<s64>(next.value) - static_cast<s64>(write.value)};
+    if (method_delta % distance != 0 || value_delta % distance != 0) {
+        return std::nullopt;
+    }
+    const u32 method_step{static_cast<u32>(method_delta / distance)};
+    const u32 value_step{static_cast<u32>(value_delta / distance)};
+    return LoopWrite{
+        .write{
+            .method = (write.method - method_step * position) & METHOD_MASK,
+            .value = write.value - value_step * position,
+            .is_parameter = write.is_parameter,
+        },
+        .method_step = method_step,
+        .value_step = value_step,
+    };
+}
+
+/**
+ * Finds a loop program that makes the same writes as every sample. Samples are sorted by count,
+ * the number of iterations is the count plus a constant bias.
+ */
+std::optional<RegisterWriteLoopProgram> FitWriteLoop(std::span<const CountSample> samples) {
+    const CountSample& first{samples.front()};
+    const CountSample& last{samples.back()};
+    const u32 count_span{last.count - first.count};
+    const size_t writes_span{last.run.writes.size() - first.run.writes.size()};
+    const u32 parameters_span{last.run.num_parameters - first.run.num_parameters};
+    if (last.run.writes.size() <= first.run.writes.size() || writes_span % count_span != 0 ||
+        last.run.num_parameters < first.run.num_parameters ||
+        parameters_span % count_span != 0) {
+        return std::nullopt;
+    }
+    const size_t num_writes{writes_span / count_span};
+    const u32 parameter_step{parameters_span / count_span};
+    if (num_writes > MAX_ITERATION_WRITES) {
+        return std::nullopt;
+    }
+    // Writes and parameters besides the iterations when the count is zero
+    const s64 base_writes{static_cast<s64>(first.run.writes.size()) -
+                          static_cast<s64>(num_writes * first.count)};
+    const s64 base_parameters{static_cast<s64>(first.run.num_parameters) -
+                              static_cast<s64>(parameter_step * first.count)};
+
+    // Prefer more iterations over writes outside of the loop
+    const s64 max_bias{base_writes / static_cast<s64>(num_writes)};
+    for (s64 bias = max_bias; bias >= -static_cast<s64>(first.count); --bias) {
+        const s64 fixed_writes{base_writes - bias * static_cast<s64>(num_writes)};
+        const s64 fixed_parameters{base_parameters - bias * parameter_step};
+        if (last.count + bias < 2 || fixed_writes < 0 || fixed_parameters < 1) {
+            // Two iterations are needed to tell how writes advance
+            continue;
+        }
+        const u32 first_iterations{static_cast<u32>(first.count + bias)};
+        const u32 last_iterations{static_cast<u32>(last.count + bias)};
+        const auto& writes{last.run.writes};
+        for (size_t prologue_size = 0; prologue_size <= static_cast<size_t>(fixed_writes);
+             ++prologue_size) {
+            RegisterWriteLoopProgram program{
+                .prologue{writes.begin(), writes.begin() + prologue_size},
+                .num_parameters = static_cast<u32>(fixed_parameters),
+                .parameter_step = parameter_step,
+                .count_bias = static_cast<s32>(bias),
+            };
+            bool is_valid{true};
+            for (size_t index = 0; index < num_writes && is_valid; ++index) {
+                const size_t offset{prologue_size + index};
+                const auto write{FitLoopWrite(writes[offset], 0, writes[offset + num_writes], 1)};
+                is_valid = write.has_value();
+                if (write) {
+                    program.iteration.push_back(*write);
+                }
+            }
+            // Epilogue writes advance by the number of iterations, compare the first sample
+            const size_t epilogue_size{static_cast<size_t>(fixed_writes) - prologue_size};
+            const size_t first_epilogue{first.run.writes.size() - epilogue_size};
+            const size_t last_epilogue{writes.size() - epilogue_size};
+            for (size_t index = 0; index < epilogue_size && is_valid; ++index) {
+                const auto write{FitLoopWrite(first.run.writes[first_epilogue + index],
+                                              first_iterations, writes[last_epilogue + index],
+                                              last_iterations)};
+                is_valid = write.has_value();
+                if (write) {
+                    program.epilogue.push_back(*write);
+                }
+            }
+            if (!is_valid) {
+                continue;
+            }
+            const bool matches{std::ranges::all_of(samples, [&](const CountSample& sample) {
+                const auto [expected_writes, expected_parameters] =
+                    ExpandWriteLoop(program, static_cast<u32>(sample.count + bias));
+                return expected_parameters == sample.run.num_parameters &&
+                       std::ranges::equal(expected_writes, sample.run.writes);
+            })};
+            if (matches) {
+                return program;
+            }
+        }
+    }
+    return std::nullopt;
+}
+} // Anonymous namespace
+
+std::optional<u32> EvaluateOperation(u32 raw_opcode, u32 src_a, u32 src_b) {
+    const Opcode opcode{raw_opcode};
+    switch (opcode.operation) {
+    case Operation::ALU:
+        switch (opcode.alu_operation) {
+        case ALUOperation::Add:
+            return src_a + src_b;
+        case ALUOperation::Subtract:
+            return src_a - src_b;
+        case ALUOperation::Xor:
+            return src_a ^ src_b;
+        case ALUOperation::Or:
+            return src_a | src_b;
+        case ALUOperation::And:
+            return src_a & src_b;
+        case ALUOperation::AndNot:
+            return src_a & ~src_b;
+        case ALUOperation::Nand:
+            return ~(src_a & src_b);
+        default:
+            return std::nullopt;
+        }
+    case Operation::AddImmediate:
+        return src_a + static_cast<u32>(opcode.immediate.Value());
+    case Operation::ExtractInsert: {
+        const u32 mask{opcode.GetBitfieldMask()};
+        const u32 src{(src_b >> opcode.bf_src_bit) & mask};
+        return (src_a & ~(mask << opcode.bf_dst_bit)) | (src << opcode.bf_dst_bit);
+    }
+    case Operation::ExtractShiftLeftImmediate:
+        if (src_a >= 32) {
+            return std::nullopt;
+        }
+        return ((src_b >> src_a) & opcode.GetBitfieldMask()) << opcode.bf_dst_bit;
+    case Operation::ExtractShiftLeftRegister:
+        if (src_a >= 32) {
+            return std::nullopt;
+        }
+        return ((src_b >> opcode.bf_src_bit) & opcode.GetBitfieldMask()) << src_a;
+    default:
+        return std::nullopt;
+    }
+}
+
+bool IsDrawMethod(u32 method) {
+    switch (method) {
+    case MAXWELL3D_REG_INDEX(draw.end):
+    case MAXWELL3D_REG_INDEX(index_buffer32_first):
+    case MAXWELL3D_REG_INDEX(index_buffer16_first):
+    case MAXWELL3D_REG_INDEX(index_buffer8_first):
+    case MAXWELL3D_REG_INDEX(index_buffer32_subsequent):
+    case MAXWELL3D_REG_INDEX(index_buffer16_subsequent):
+    case MAXWELL3D_REG_INDEX(index_buffer8_subsequent):
+    case MAXWELL3D_REG_INDEX(vertex_array_instance_first):
+    case MAXWELL3D_REG_INDEX(vertex_array_instance_subsequent):
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool IsConstBufferDataMethod(u32 method) {
+    return method >= CB_DATA_METHOD && method < CB_DATA_METHOD + NUM_CB_DATA_METHODS;
+}
+
+std::optional<RegisterWriteProgram> MatchRegisterWrites(std::span<const u32> code) {
+    SymbolicRun run;
+    if (RunSymbolic(code, std::nullopt, run) != RunResult::Exited || run.writes.empty()) {
+        return std::nullopt;
+    }
+    return RegisterWriteProgram{
+        .writes = std::move(run.writes),
+        .num_parameters = run.num_parameters,
+    };
+}
+
+std::optional<RegisterWriteLoopProgram> MatchRegisterWriteLoop(std::span<const u32> code) {
+    const bool has_branch{std::ranges::any_of(
+        code, [](u32 raw) { return Opcode{raw}.operation == Operation::Branch; })};
+    if (!has_branch) {
+        return std::nullopt;
+    }
+    for (u32 parameter = 0; parameter < MAX_COUNT_PARAMETER; ++parameter) {
+        std::vector<CountSample> samples;
+        bool is_valid{true};
+        for (const u32 count : SAMPLE_COUNTS) {
+            SymbolicRun run;
+            const RunResult result{RunSymbolic(code, ConcreteParameter{parameter, count}, run)};
+            if (result == RunResult::Exited) {
+                samples.push_back({.count = count, .run = std::move(run)});
+                continue;
+            }
+            // Small counts may wrap around a loop counter and never exit, the macro is only
+            // valid for the counts above them
+            if (result == RunResult::Unsupported || !samples.empty()) {
+                is_valid = false;
+                break;
+            }
+        }
+        if (!is_valid || samples.size() < MIN_SAMPLES) {
+            continue;
+        }
+        const SymbolicRun& first_run{samples.front().run};
+        const bool has_loop_test{std::ranges::all_of(samples, [&](const CountSample& sample) {
+            return sample.run.loop_test_pc && sample.run.loop_test_pc == first_run.loop_test_pc &&
+                   sample.run.loop_test_offset == first_run.loop_test_offset;
+        })};
+        if (!has_loop_test) {
+            continue;
+        }
+        if (auto program = FitWriteLoop(samples)) {
+            // The loop test counts down from the count plus the offset, smaller counts wrap
+            // around and never exit
+            const s32 offset{static_cast<s32>(first_run.loop_test_offset)};
+            program->count_parameter = parameter;
+            program->min_count = offset < 0 ? static_cast<u32>(-offset) : 0;
+            return program;
+        }
+    }
+    return std::nullopt;
+}
+
+MacroAnalysis AnalyzeMacro(std::span<const u32> code) {
+    MacroAnalysis analysis;
+    analysis.instructions.resize(code.size());
+    if (code.empty()) {
+        return analysis;
+    }
+    for (const u32 raw : code) {
+        const Opcode opcode{raw};
+        if (opcode.operation == Operation::ALU &&
+            (opcode.alu_operation == ALUOperation::AddWithCarry ||
+             opcode.alu_operation == ALUOperation::SubtractWithBorrow)) {
+            analysis.uses_carry = true;
+        }
+        if (opcode.operation == Operation::Branch && !opcode.branch_annul) {
+            analysis.has_delayed_branch = true;
+        }
+    }
+    const std::vector<std::vector<u32>> successors{BuildSuccessors(code)};
+
+    // Forward constant propagation, registers start zeroed except for the first parameter
+    std::vector<State> states(code.size());
+    State& entry{states[0]};
+    entry.registers.fill(LatticeValue::MakeConstant(0));
+    entry.registers[1] = LatticeValue::MakeVarying();
+    entry.method_address = LatticeValue::MakeConstant(0);
+    entry.reached = true;
+    std::vector<u32> worklist{0};
+    while (!worklist.empty()) {
+        const u32 index{worklist.back()};
+        worklist.pop_back();
+        State state{states[index]};
+        Transfer(Opcode{code[index]}, state, analysis.uses_carry, nullptr);
+        for (const u32 successor : successors[index]) {
+            if (states[successor].Meet(state)) {
+                worklist.push_back(successor);
+            }
+        }
+    }
+
+    // Backward register liveness, nothing is live after the macro exits
+    std::vector<u8> live_out(code.size());
+    std::vector<u8> live_in(code.size());
+    bool changed{true};
+    while (changed) {
+        changed = false;
+        for (size_t index = code.size(); index-- > 0;) {
+            const Opcode opcode{code[index]};
+            u8 out{};
+            for (const u32 successor : successors[index]) {
+                out |= live_in[successor];
+            }
+            const u8 kill{WritesRegister(opcode) ? RegisterMask(opcode.dst) : u8{}};
+            const u8 in{static_cast<u8>(ReadRegisters(opcode) | (out & ~kill))};
+            if (out != live_out[index] || in != live_in[index]) {
+                live_out[index] = out;
+                live_in[index] = in;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t index = 0; index < code.size(); ++index) {
+        if (!states[index].reached) {
+            continue;
+        }
+        const Opcode opcode{code[index]};
+        InstructionInfo& info{analysis.instructions[index]};
+        if (opcode.operation == Operation::Branch) {
+            const LatticeValue& value{states[index].registers[opcode.src_a]};
+            if (value.IsConstant()) {
+                info.constant = value.value;
+                ++analysis.num_folded;
+            }
+            continue;
+        }
+        const LatticeValue result{EvaluateResult(opcode, states[index], analysis.uses_carry)};
+        if (result.IsConstant() && opcode.result_operation != ResultOperation::IgnoreAndFetch) {
+            info.constant = result.value;
+            ++analysis.num_folded;
+        }
+        State state{states[index]};
+        Transfer(opcode, state, analysis.uses_carry, &info);
+        if (info.batchable_send) {
+            ++analysis.num_batchable_sends;
+        }
+        if (WritesRegister(opcode) && (live_out[index] & RegisterMask(opcode.dst)) == 0) {
+            info.dead_store = true;
+            ++analysis.num_dead_stores;
+        }
+        if (opcode.result_operation == ResultOperation::Move &&
+            (opcode.dst == 0 || info.dead_store) &&
+            !HasSideEffects(opcode, analysis.uses_carry)) {
+            info.is_nop = true;
+            ++analysis.num_nops;
+        }
+    }
+    return analysis;
+}
+
+} // namespace Tegra::Macro
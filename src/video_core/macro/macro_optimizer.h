@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Tegra::Macro {
+
+/// Facts proven about a single macro instruction
+struct InstructionInfo {
+    /// Value of the instruction result when it does not depend on parameters or engine state.
+    /// For branches, this is the value of the tested register.
+    std::optional<u32> constant;
+    /// The register written by the instruction is never read before being overwritten or exiting
+    bool dead_store{};
+    /// The instruction has no observable effect and can be skipped
+    bool is_nop{};
+    /// The instruction sends to a method that can be batched with CallMultiMethod
+    bool batchable_send{};
+};
+
+struct MacroAnalysis {
+    std::vector<InstructionInfo> instructions;
+    /// Some instruction reads the carry flag, so instructions writing it have side effects
+    bool uses_carry{};
+    /// Some branch executes a delay slot when taken
+    bool has_delayed_branch{};
+
+    u32 num_folded{};
+    u32 num_dead_stores{};
+    u32 num_nops{};
+    u32 num_batchable_sends{};
+};
+
+/// Method call made by a macro that only writes registers
+struct MacroWrite {
+    u32 method{};
+    /// Written value, or the index of the written parameter when is_parameter is set
+    u32 value{};
+    bool is_parameter{};
+
+    bool operator==(const MacroWrite&) const = default;
+};
+
+struct RegisterWriteProgram {
+    std::vector<MacroWrite> writes;
+    u32 num_parameters{};
+};
+
+/// Write of a loop that advances linearly with the iteration index
+struct LoopWrite {
+    /// Write made by the first iteration
+    MacroWrite write;
+    u32 method_step{};
+    /// Added to the value, or to the parameter index, on each iteration
+    u32 value_step{};
+
+    [[nodiscard]] MacroWrite Advance(u32 iteration) const {
+        return {
+            .method = (write.method + method_step * iteration) & 0xFFF,
+            .value = write.value + value_step * iteration,
+            .is_parameter = write.is_parameter,
+        };
+    }
+};
+
+/// Macro that repeats a group of writes as many times as one of its parameters says
+struct RegisterWriteLoopProgram {
+    std::vector<MacroWrite> prologue;
+    /// Writes of each iteration, advanced by the iteration index
+    std::vector<LoopWrite> iteration;
+    /// Writes after the loop, advanced by the number of iterations
+    std::vector<LoopWrite> epilogue;
+    /// Parameters used with zero iterations and parameters fetched by each iteration
+    u32 num_parameters{};
+    u32 parameter_step{};
+    /// Index of the parameter with the count, the number of iterations is the count plus the bias
+    u32 count_parameter{};
+    s32 count_bias{};
+    /// Smaller counts never exit the macro
+    u32 min_count{};
+};
+
+/**
+ * Runs constant propagation and register liveness over the macro control flow graph.
+ * Registers are zero at the start of a macro, except for the first parameter in $r1.
+ *
+ * @param code Macro code to analyze
+ * @returns Facts about each instruction of the macro
+ */
+[[nodiscard]] MacroAnalysis AnalyzeMacro(std::span<const u32> code);
+
+/**
+ * Matches macros without reads or branches depending on parameters, whose method addresses are
+ * constant and whose sent values are constants or copies of parameters. These are equivalent to a
+ * fixed list of writes.
+ *
+ * @param code Macro code to match
+ * @returns The writes of the macro in order, or nullopt when the macro does not match
+ */
+[[nodiscard]] std::optional<RegisterWriteProgram> MatchRegisterWrites(std::span<const u32> code);
+
+/**
+ * Matches macros that loop over a count parameter, like uploads of N consecutive registers or
+ * draws of N inline indirect commands. The macro is executed symbolically with several counts and
+ * matches when a single loop program makes the same writes for all of them, and the runs prove
+ * that only the loop exit test depends on the count.
+ *
+ * @param code Macro code to match
+ * @returns The loop program, or nullopt when the macro does not match
+ */
+[[nodiscard]] std::optional<RegisterWriteLoopProgram> MatchRegisterWriteLoop(
+    std::span<const u32> code);
+
+/// Returns true when writing to the method issues a draw
+[[nodiscard]] bool IsDrawMethod(u32 method);
+
+/// Returns true when the method uploads data to the bound const buffer
+[[nodiscard]] bool IsConstBufferDataMethod(u32 method);
+
+/// Calculates the result of a bitfield or ALU operation that does not read or write the carry
+[[nodiscard]] std::optional<u32> EvaluateOperation(u32 raw_opcode, u32 src_a, u32 src_b);
+
+} // namespace Tegra::Macro
@@ -0,0 +1,398 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <span>
+
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/macro/macro_optimizer.h"
+#include "video_core/macro/macro_threaded_interpreter.h"
+
+MICROPROFILE_DEFINE(MacroThreaded, "GPU", "Execute macro threaded interpreter",
+                    MP_RGB(128, 160, 192));
+
+namespace Tegra {
+namespace {
+/**
+ * Macros are decoded once into an array of instructions holding pointers to the handlers of
+ * their operation and result. Execution calls through those pointers instead of decoding and
+ * switching on every instruction, and skips work the macro analysis proved to be unnecessary.
+ */
+class MacroThreadedImpl final : public CachedMacro {
+public:
+    explicit MacroThreadedImpl(Engines::Maxwell3D& maxwell3d_, std::span<const u32> code);
+
+    void Execute(const std::vector<u32>& params, u32 method) override;
+
+private:
+    struct Instruction;
+    using OperationHandler = u32 (*)(MacroThreadedImpl&, const Instruction&);
+    using ResultHandler = void (*)(MacroThreadedImpl&, const Instruction&, u32);
+
+    enum class Branch : u8 {
+        None,
+        Zero,
+        NotZero,
+        Always,
+    };
+
+    struct Instruction {
+        /// Calculates the result, null when the instruction has no effect
+        OperationHandler operation{};
+        /// Stores, sends or uses the result as method address
+        ResultHandler result{};
+        /// Immediate operand, or the result of the instruction when it has been folded
+        u32 immediate{};
+        u32 bitfield_mask{};
+        u32 branch_target{};
+        u8 dst{};
+        u8 src_a{};
+        u8 src_b{};
+        u8 bf_src_bit{};
+        u8 bf_dst_bit{};
+        Branch branch{};
+        bool branch_annul{};
+        bool is_exit{};
+        bool batchable_send{};
+    };
+
+    static OperationHandler GetOperation(Macro::Opcode opcode);
+
+    template <bool store>
+    static ResultHandler GetResult(Macro::ResultOperation operation);
+
+    static u32 Constant(MacroThreadedImpl&, const Instruction& inst) {
+        return inst.immediate;
+    }
+
+    static u32 Zero(MacroThreadedImpl&, const Instruction&) {
+        return 0;
+    }
+
+    template <Macro::ALUOperation operation>
+    static u32 ALU(MacroThreadedImpl& self, const Instruction& inst) {
+        const u32 src_a{self.registers[inst.src_a]};
+        const u32 src_b{self.registers[inst.src_b]};
+        if constexpr (operation == Macro::ALUOperation::Add) {
+            const u64 result{static_cast<u64>(src_a) + src_b};
+            self.carry_flag = result > 0xffffffff;
+            return static_cast<u32>(result);
+        } else if constexpr (operation == Macro::ALUOperation::AddWithCarry) {
+            const u64 result{static_cast<u64>(src_a) + src_b + (self.carry_flag ? 1ULL : 0ULL)};
+            self.carry_flag = result > 0xffffffff;
+            return static_cast<u32>(result);
+        } else if constexpr (operation == Macro::ALUOperation::Subtract) {
+            const u64 result{static_cast<u64>(src_a) - src_b};
+            self.carry_flag = result < 0x100000000;
+            return static_cast<u32>(result);
+        } else if constexpr (operation == Macro::ALUOperation::SubtractWithBorrow) {
+            const u64 result{static_cast<u64>(src_a) - src_b - (self.carry_flag ? 0ULL : 1ULL)};
+            self.carry_flag = result < 0x100000000;
+            return static_cast<u32>(result);
+        } else if constexpr (operation == Macro::ALUOperation::Xor) {
+            return src_a ^ src_b;
+        } else if constexpr (operation == Macro::ALUOperation::Or) {
+            return src_a | src_b;
+        } else if constexpr (operation == Macro::ALUOperation::And) {
+            return src_a & src_b;
+        } else if constexpr (operation == Macro::ALUOperation::AndNot) {
+            return src_a & ~src_b;
+        } else {
+            return ~(src_a & src_b);
+        }
+    }
+
+    static u32 AddImmediate(MacroThreadedImpl& self, const Instruction& inst) {
+        return self.registers[inst.src_a] + inst.immediate;
+    }
+
+    static u32 ExtractInsert(MacroThreadedImpl& self, const Instruction& inst) {
+        const u32 src{(self.registers[inst.src_b] >> inst.bf_src_bit) & inst.bitfield_mask};
+        const u32 dst{self.registers[inst.src_a] & ~(inst.bitfield_mask << inst.bf_dst_bit)};
+        return dst | (src << inst.bf_dst_bit);
+    }
+
+    static u32 ExtractShiftLeftImmediate(MacroThreadedImpl& self, const Instruction& inst) {
+        const u32 shift{self.registers[inst.src_a]};
+        const u32 src{self.registers[inst.src_b]};
+        return ((src >> shift) & inst.bitfield_mask) << inst.bf_dst_bit;
+    }
+
+    static u32 ExtractShiftLeftRegister(MacroThreadedImpl& self, const Instruction& inst) {
+        const u32 shift{self.registers[inst.src_a]};
+        const u32 src{self.registers[inst.src_b]};
+        return ((src >> inst.bf_src_bit) & inst.bitfield_mask) << shift;
+    }
+
+    static u32 Read(MacroThreadedImpl& self, const Instruction& inst) {
+        // Batched sends may change the register being read
+        self.FlushSends();
+        return self.maxwell3d.GetRegisterValue(self.registers[inst.src_a] + inst.immediate);
+    }
+
+    template <Macro::ResultOperation operation, bool store>
+    static void ProcessResult(MacroThreadedImpl& self, const Instruction& inst, u32 result) {
+        using Macro::ResultOperation;
+        constexpr bool fetch{operation == ResultOperation::IgnoreAndFetch ||
+                             operation == ResultOperation::FetchAndSend ||
+                             operation == ResultOperation::FetchAndSetMethod};
+        if constexpr (fetch) {
+            const u32 parameter{self.FetchParameter()};
+            if constexpr (store) {
+                self.registers[inst.dst] = parameter;
+            }
+        } else if constexpr (store) {
+            self.registers[inst.dst] = result;
+        }
+        if constexpr (operation == ResultOperation::MoveAndSetMethod ||
+                      operation == ResultOperation::FetchAndSetMethod ||
+                      operation == ResultOperation::MoveAndSetMethodFetchAndSend ||
+                      operation == ResultOperation::MoveAndSetMethodSend) {
+            self.method_address.raw = result;
+        }
+        if constexpr (operation == ResultOperation::FetchAndSend ||
+                      operation == ResultOperation::MoveAndSend) {
+            self.Send(result, inst.batchable_send);
+        } else if constexpr (operation == ResultOperation::MoveAndSetMethodFetchAndSend) {
+            self.Send(self.FetchParameter(), inst.batchable_send);
+        } else if constexpr (operation == ResultOperation::MoveAndSetMethodSend) {
+            self.Send((result >> 12) & 0b111111, inst.batchable_send);
+        }
+    }
+
+    /// Executes instructions until the macro exits
+    void Run();
+
+    /// Executes the instruction in the delay slot of a branch or exit
+    void ExecuteDelaySlot(size_t pc) {
+        ASSERT_OR_EXECUTE_MSG(pc < program.size(), { return; },
+                              "Delay slot is out of the macro code");
+        const Instruction& inst{program[pc]};
+        ASSERT_MSG(inst.branch == Branch::None, "Executing a branch in a delay slot is not valid");
+        if (inst.operation) {
+            inst.result(*this, inst, inst.operation(*this, inst));
+        }
+    }
+
+    u32 FetchParameter() {
+        ASSERT(next_parameter_index < num_parameters);
+        return parameters[next_parameter_index++];
+    }
+
+    void Send(u32 value, bool batchable) {
+        const u32 method{method_address.address};
+        if (batchable) {
+            if (!pending_sends.empty() && pending_method != method) {
+                FlushSends();
+            }
+            pending_method = method;
+            pending_sends.push_back(value);
+        } else {
+            FlushSends();
+            maxwell3d.CallMethod(method, value, true);
+        }
+        method_address.address.Assign(method_address.address.Value() +
+                                      method_address.increment.Value());
+    }
+
+    void FlushSends() {
+        if (pending_sends.empty()) {
+            return;
+        }
+        const u32 amount{static_cast<u32>(pending_sends.size())};
+        maxwell3d.CallMultiMethod(pending_method, pending_sends.data(), amount, amount);
+        pending_sends.clear();
+    }
+
+    Engines::Maxwell3D& maxwell3d;
+    std::vector<Instruction> program;
+
+    std::array<u32, Macro::NUM_MACRO_REGISTERS> registers{};
+    Macro::MethodAddress method_address{};
+    bool carry_flag{};
+
+    const u32* parameters{};
+    size_t num_parameters{};
+    size_t next_parameter_index{};
+
+    /// Consecutive sends to the same method, submitted together with CallMultiMethod
+    std::vector<u32> pending_sends;
+    u32 pending_method{};
+};
+
+MacroThreadedImpl::OperationHandler MacroThreadedImpl::GetOperation(Macro::Opcode opcode) {
+    switch (opcode.operation) {
+    case Macro::Operation::ALU:
+        switch (opcode.alu_operation) {
+        case Macro::ALUOperation::Add:
+            return &ALU<Macro::ALUOperation::Add>;
+        case Macro::ALUOperation::AddWithCarry:
+            return &ALU<Macro::ALUOperation::AddWithCarry>;
+        case Macro::ALUOperation::Subtract:
+            return &ALU<Macro::ALUOperation::Subtract>;
+        case Macro::ALUOperation::SubtractWithBorrow:
+            return &ALU<Macro::ALUOperation::SubtractWithBorrow>;
+        case Macro::ALUOperation::Xor:
+            return &ALU<Macro::ALUOperation::Xor>;
+        case Macro::ALUOperation::Or:
+            return &ALU<Macro::ALUOperation::Or>;
+        case Macro::ALUOperation::And:
+            return &ALU<Macro::ALUOperation::And>;
+        case Macro::ALUOperation::AndNot:
+            return &ALU<Macro::ALUOperation::AndNot>;
+        case Macro::ALUOperation::Nand:
+            return &ALU<Macro::ALUOperation::Nand>;
+        default:
+            UNIMPLEMENTED_MSG("Unimplemented ALU operation {}", opcode.alu_operation.Value());
+            return &Zero;
+        }
+    case Macro::Operation::AddImmediate:
+        return &AddImmediate;
+    case Macro::Operation::ExtractInsert:
+        return &ExtractInsert;
+    case Macro::Operation::ExtractShiftLeftImmediate:
+        return &ExtractShiftLeftImmediate;
+    case Macro::Operation::ExtractShiftLeftRegister:
+        return &ExtractShiftLeftRegister;
+    case Macro::Operation::Read:
+        return &Read;
+    default:
+        UNIMPLEMENTED_MSG("Unimplemented macro operation {}", opcode.operation.Value());
+        return nullptr;
+    }
+}
+
+template <bool store>
+MacroThreadedImpl::ResultHandler MacroThreadedImpl::GetResult(Macro::ResultOperation operation) {
+    using Macro::ResultOperation;
+    switch (operation) {
+    case ResultOperation::IgnoreAndFetch:
+        return &ProcessResult<ResultOperation::IgnoreAndFetch, store>;
+    case ResultOperation::Move:
+        return &ProcessResult<ResultOperation::Move, store>;
+    case ResultOperation::MoveAndSetMethod:
+        return &ProcessResult<ResultOperation::MoveAndSetMethod, store>;
+    case ResultOperation::FetchAndSend:
+        return &ProcessResult<ResultOperation::FetchAndSend, store>;
+    case ResultOperation::MoveAndSend:
+        return &ProcessResult<ResultOperation::MoveAndSend, store>;
+    case ResultOperation::FetchAndSetMethod:
+        return &ProcessResult<ResultOperation::FetchAndSetMethod, store>;
+    case ResultOperation::MoveAndSetMethodFetchAndSend:
+        return &ProcessResult<ResultOperation::MoveAndSetMethodFetchAndSend, store>;
+    case ResultOperation::MoveAndSetMethodSend:
+        return &ProcessResult<ResultOperation::MoveAndSetMethodSend, store>;
+    }
+    UNREACHABLE();
+}
+
+MacroThreadedImpl::MacroThreadedImpl(Engines::Maxwell3D& maxwell3d_, std::span<const u32> code)
+    : maxwell3d{maxwell3d_} {
+    const Macro::MacroAnalysis analysis{Macro::AnalyzeMacro(code)};
+    LOG_DEBUG(HW_GPU,
+              "Macro of {} instructions: {} folded, {} dead stores, {} nops, {} batchable sends",
+              code.size(), analysis.num_folded, analysis.num_dead_stores, analysis.num_nops,
+              analysis.num_batchable_sends);
+
+    program.resize(code.size());
+    for (size_t index = 0; index < code.size(); ++index) {
+        const Macro::Opcode opcode{code[index]};
+        const Macro::InstructionInfo& info{analysis.instructions[index]};
+        Instruction& inst{program[index]};
+        inst.is_exit = opcode.is_exit != 0;
+        if (opcode.operation == Macro::Operation::Branch) {
+            const s64 target{static_cast<s64>(index) + opcode.immediate.Value()};
+            // Out of range targets trip the bounds check of the execution loop
+            const bool is_valid{target >= 0 && target < static_cast<s64>(code.size())};
+            inst.branch_target = static_cast<u32>(is_valid ? target : code.size());
+            inst.branch_annul = opcode.branch_annul != 0;
+            inst.src_a = static_cast<u8>(opcode.src_a.Value());
+            const bool on_zero{opcode.branch_condition == Macro::BranchCondition::Zero};
+            if (info.constant) {
+                const bool taken{(*info.constant == 0) == on_zero};
+                inst.branch = taken ? Branch::Always : Branch::None;
+            } else {
+                inst.branch = on_zero ? Branch::Zero : Branch::NotZero;
+            }
+            continue;
+        }
+        if (info.is_nop) {
+            continue;
+        }
+        inst.operation = info.constant ? &Constant : GetOperation(opcode);
+        if (!inst.operation) {
+            continue;
+        }
+        const bool store{opcode.dst != 0 && !info.dead_store};
+        inst.result = store ? GetResult<true>(opcode.result_operation)
+                            : GetResult<false>(opcode.result_operation);
+        inst.immediate = info.constant.value_or(static_cast<u32>(opcode.immediate.Value()));
+        inst.bitfield_mask = opcode.GetBitfieldMask();
+        inst.dst = static_cast<u8>(opcode.dst.Value());
+        inst.src_a = static_cast<u8>(opcode.src_a.Value());
+        inst.src_b = static_cast<u8>(opcode.src_b.Value());
+        inst.bf_src_bit = static_cast<u8>(opcode.bf_src_bit.Value());
+        inst.bf_dst_bit = static_cast<u8>(opcode.bf_dst_bit.Value());
+        inst.batchable_send = info.batchable_send;
+    }
+}
+
+void MacroThreadedImpl::Run() {
+    size_t pc{};
+    while (true) {
+        ASSERT_OR_EXECUTE_MSG(pc < program.size(), { return; },
+                              "Macro execution went out of the macro code");
+        const Instruction& inst{program[pc]};
+        if (inst.branch != Branch::None) {
+            const u32 value{registers[inst.src_a]};
+            const bool taken{inst.branch == Branch::Always ||
+                             (inst.branch == Branch::Zero) == (value == 0)};
+            if (taken) {
+                if (!inst.branch_annul) {
+                    ExecuteDelaySlot(pc + 1);
+                }
+                pc = inst.branch_target;
+                continue;
+            }
+        } else if (inst.operation) {
+            inst.result(*this, inst, inst.operation(*this, inst));
+        }
+        if (inst.is_exit) {
+            // Exit has a delay slot, execute the next instruction
+            ExecuteDelaySlot(pc + 1);
+            return;
+        }
+        ++pc;
+    }
+}
+
+void MacroThreadedImpl::Execute(const std::vector<u32>& params, u32 method) {
+    MICROPROFILE_SCOPE(MacroThreaded);
+    registers = {};
+    registers[1] = params[0];
+    method_address.raw = 0;
+    carry_flag = false;
+    parameters = params.data();
+    num_parameters = params.size();
+    // $r1 already holds the first parameter
+    next_parameter_index = 1;
+
+    Run();
+    FlushSends();
+
+    // Assert that the macro used all the input parameters
+    ASSERT(next_parameter_index == num_parameters);
+}
+} // Anonymous namespace
+
+MacroThreadedInterpreter::MacroThreadedInterpreter(Engines::Maxwell3D& maxwell3d_)
+    : MacroEngine{maxwell3d_}, maxwell3d{maxwell3d_} {}
+
+std::unique_ptr<CachedMacro> MacroThreadedInterpreter::Compile(const std::vector<u32>& code) {
+    return std::make_unique<MacroThreadedImpl>(maxwell3d, code);
+}
+
+} // namespace Tegra
@@ -5,10 +5,15 @@
 
 #include "common/alignment.h"
 #include "common/assert.h"
+#include "common/div_ceil.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/core.h"
+#include "core/device_memory.h"
 #include "core/hle/kernel/k_page_table.h"
 #include "core/hle/kernel/k_process.h"
+#include "video_core/gpu_trace.h"
 #include "video_core/guest_memory.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/invalidation_accumulator.h"
@@ -47,6 +52,18 @@ MemoryManager::MemoryManager(Core::System& system_, MaxwellDeviceMemoryManager&
     big_page_table_dev.resize(big_page_table_size);
     big_page_continuous.resize(big_page_table_size / continuous_bits, 0);
     entries.resize(page_table_size / 32, 0);
+
+    if (Settings::values.use_gpu_fastmem.GetValue()) {
+        fastmem_arena =
+            std::make_unique<Common::HostMemory>(system.DeviceMemory().buffer, address_space_size);
+        fastmem_base = fastmem_arena->VirtualBasePointer();
+        if (fastmem_base) {
+            fastmem_pages.resize(Common::DivCeil(address_space_size >> cpu_page_bits, 64ULL));
+        } else {
+            LOG_WARNING(HW_GPU, "GPU fastmem is unavailable, falling back to the page tables");
+            fastmem_arena.reset();
+        }
+    }
 }
 
 MemoryManager::MemoryManager(Core::System& system_, u64 address_space_bits_,
@@ -54,7 +71,13 @@ MemoryManager::MemoryManager(Core::System& system_, u64 address_space_bits_,
     : MemoryManager(system_, system_.Host1x().MemoryManager(), address_space_bits_, split_address_,
                     big_page_bits_, page_bits_) {}
 
-MemoryManager::~MemoryManager() = default;
+MemoryManager::~MemoryManager() {
+    const MemoryTranslationStatistics stats = GetTranslationStatistics();
+    if (stats.num_direct_translations + stats.num_page_walks != 0) {
+        LOG_INFO(HW_GPU, "Address space {}: {} direct translations, {} page table walks",
+                 unique_identifier, stats.num_direct_translations, stats.num_page_walks);
+    }
+}
 
 template <bool is_big_page>
 MemoryManager::EntryType MemoryManager::GetEntry(size_t position) const {
@@ -179,25 +202,139 @@ void MemoryManager::BindRasterizer(VideoCore::RasterizerInterface* rasterizer_)
     rasterizer = rasterizer_;
 }
 
+void MemoryManager::BindTraceRecorder(GpuTraceRecorder* recorder) {
+    if (trace_recorder == recorder) {
+        return;
+    }
+    trace_recorder = recorder;
+    trace_recorder->RecordAddressSpace({
+        .id = unique_identifier,
+        .address_space_bits = address_space_bits,
+        .split_address = split_address,
+        .big_page_bits = big_page_bits,
+        .page_bits = page_bits,
+    });
+    TraceMappings<true>();
+    TraceMappings<false>();
+}
+
+template <bool is_big_page>
+void MemoryManager::TraceMappings() const {
+    const std::vector<u64>& page_entries = is_big_page ? big_entries : entries;
+    const u64 used_page_bits = is_big_page ? big_page_bits : page_bits;
+    const u64 used_page_size = 1ULL << used_page_bits;
+    std::optional<GpuTraceMap> run;
+    const auto flush_run = [&] {
+        if (run) {
+            trace_recorder->RecordMap(*run);
+            run.reset();
+        }
+    };
+    for (size_t word = 0; word < page_entries.size(); ++word) {
+        if (page_entries[word] == 0) {
+            flush_run();
+            continue;
+        }
+        for (size_t sub_index = 0; sub_index < 32; ++sub_index) {
+            const auto entry =
+                static_cast<EntryType>((page_entries[word] >> (2 * sub_index)) & 0x03ULL);
+            if (entry == EntryType::Free) {
+                flush_run();
+                continue;
+            }
+            const GPUVAddr gpu_addr = static_cast<GPUVAddr>(word * 32 + sub_index)
+                                      << used_page_bits;
+            const bool sparse = entry == EntryType::Reserved;
+            DAddr dev_addr = 0;
+            if (!sparse) {
+                const size_t index = PageEntryIndex<is_big_page>(gpu_addr);
+                const u32 sub_value = is_big_page ? big_page_table_dev[index] : page_table[index];
+                dev_addr = static_cast<DAddr>(sub_value) << cpu_page_bits;
+            }
+            const PTEKind kind = sparse ? PTEKind::INVALID : GetPageKind(gpu_addr);
+            if (run && run->sparse == sparse && run->kind == kind &&
+                run->gpu_addr + run->size == gpu_addr &&
+                (sparse || run->device_addr + run->size == dev_addr)) {
+                run->size += used_page_size;
+                continue;
+            }
+            flush_run();
+            run = GpuTraceMap{
+                .address_space = unique_identifier,
+                .gpu_addr = gpu_addr,
+                .device_addr = dev_addr,
+                .size = used_page_size,
+                .kind = kind,
+                .big_pages = is_big_page,
+                .sparse = sparse,
+            };
+        }
+    }
+    flush_run();
+}
+
+void MemoryManager::TraceAccess(GPUVAddr gpu_addr, std::size_t size) const {
+    boost::container::small_vector<std::pair<DAddr, std::size_t>, 32> ranges;
+    GetSubmappedRangeImpl<false>(gpu_addr, std::max<std::size_t>(size, 1), ranges);
+    for (const auto& [dev_addr, range_size] : ranges) {
+        trace_recorder->RecordMemoryAccess(memory, dev_addr, range_size);
+    }
+}
+
 GPUVAddr MemoryManager::Map(GPUVAddr gpu_addr, DAddr dev_addr, std::size_t size, PTEKind kind,
                             bool is_big_pages) {
+    if (trace_recorder) [[unlikely]] {
+        trace_recorder->RecordMap({
+            .address_space = unique_identifier,
+            .gpu_addr = gpu_addr,
+            .device_addr = dev_addr,
+            .size = size,
+            .kind = kind,
+            .big_pages = is_big_pages,
+            .sparse = false,
+        });
+    }
     if (is_big_pages) [[likely]] {
-        return BigPageTableOp<EntryType::Mapped>(gpu_addr, dev_addr, size, kind);
+        BigPageTableOp<EntryType::Mapped>(gpu_addr, dev_addr, size, kind);
+    } else {
+        PageTableOp<EntryType::Mapped>(gpu_addr, dev_addr, size, kind);
     }
-    return PageTableOp<EntryType::Mapped>(gpu_addr, dev_addr, size, kind);
+    UpdateFastmem(gpu_addr, size);
+    return gpu_addr;
 }
 
 GPUVAddr MemoryManager::MapSparse(GPUVAddr gpu_addr, std::size_t size, bool is_big_pages) {
+    if (trace_recorder) [[unlikely]] {
+        trace_recorder->RecordMap({
+            .address_space = unique_identifier,
+            .gpu_addr = gpu_addr,
+            .device_addr = 0,
+            .size = size,
+            .kind = PTEKind::INVALID,
+            .big_pages = is_big_pages,
+            .sparse = true,
+        });
+    }
     if (is_big_pages) [[likely]] {
-        return BigPageTableOp<EntryType::Reserved>(gpu_addr, 0, size, PTEKind::INVALID);
+        BigPageTableOp<EntryType::Reserved>(gpu_addr, 0, size, PTEKind::INVALID);
+    } else {
+        PageTableOp<EntryType::Reserved>(gpu_addr, 0, size, PTEKind::INVALID);
     }
-    return PageTableOp<EntryType::Reserved>(gpu_addr, 0, size, PTEKind::INVALID);
+    UpdateFastmem(gpu_addr, size);
+    return gpu_addr;
 }
 
 void MemoryManager::Unmap(GPUVAddr gpu_addr, std::size_t size) {
     if (size == 0) {
         return;
     }
+    if (trace_recorder) [[unlikely]] {
+        trace_recorder->RecordUnmap({
+            .address_space = unique_identifier,
+            .gpu_addr = gpu_addr,
+            .size = size,
+        });
+    }
     GetSubmappedRangeImpl<false>(gpu_addr, size, page_stash);
 
     for (const auto& [map_addr, map_size] : page_stash) {
@@ -207,6 +344,7 @@ void MemoryManager::Unmap(GPUVAddr gpu_addr, std::size_t size) {
 
     BigPageTableOp<EntryType::Free>(gpu_addr, 0, size, PTEKind::INVALID);
     PageTableOp<EntryType::Free>(gpu_addr, 0, size, PTEKind::INVALID);
+    UpdateFastmem(gpu_addr, size);
 }
 
 std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) const {
@@ -243,7 +381,7 @@ std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr, std::size_t s
 
 template <typename T>
 T MemoryManager::Read(GPUVAddr addr) const {
-    if (auto page_pointer{GetPointer(addr)}; page_pointer) {
+    if (auto page_pointer{TranslatePointer(addr, sizeof(T))}; page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         T value;
         std::memcpy(&value, page_pointer, sizeof(T));
@@ -257,7 +395,7 @@ T MemoryManager::Read(GPUVAddr addr) const {
 
 template <typename T>
 void MemoryManager::Write(GPUVAddr addr, T data) {
-    if (auto page_pointer{GetPointer(addr)}; page_pointer) {
+    if (auto page_pointer{TranslatePointer(addr, sizeof(T))}; page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         std::memcpy(page_pointer, &data, sizeof(T));
         return;
@@ -275,7 +413,15 @@ template void MemoryManager::Write<u16>(GPUVAddr addr, u16 data);
 template void MemoryManager::Write<u32>(GPUVAddr addr, u32 data);
 template void MemoryManager::Write<u64>(GPUVAddr addr, u64 data);
 
-u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) {
+u8* MemoryManager::TranslatePointer(GPUVAddr gpu_addr, std::size_t size) const {
+    if (trace_recorder) [[unlikely]] {
+        TraceAccess(gpu_addr, size);
+    }
+    if (u8* const pointer = GetFastmemPointer(gpu_addr, size)) {
+        CountTranslation(num_direct_translations);
+        return pointer;
+    }
+    CountTranslation(num_page_walks);
     const auto address{GpuToCpuAddress(gpu_addr)};
     if (!address) {
         return {};
@@ -284,13 +430,12 @@ u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) {
     return memory.GetPointer<u8>(*address);
 }
 
-const u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) const {
-    const auto address{GpuToCpuAddress(gpu_addr)};
-    if (!address) {
-        return {};
-    }
+u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) {
+    return TranslatePointer(gpu_addr, 1);
+}
 
-    return memory.GetPointer<u8>(*address);
+const u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) const {
+    return TranslatePointer(gpu_addr, 1);
 }
 
 #ifdef _MSC_VER // no need for gcc / clang but msvc's compiler is more conservative with inlining.
@@ -402,6 +547,18 @@ void MemoryManager::ReadBlockImpl(GPUVAddr gpu_src_addr, void* dest_buffer, std:
         GPUVAddr base = (page_index << big_page_bits) + offset;
         MemoryOperation<false>(base, copy_amount, mapped_normal, set_to_zero, set_to_zero);
     };
+    if (trace_recorder) [[unlikely]] {
+        TraceAccess(gpu_src_addr, size);
+    }
+    if constexpr (!is_safe) {
+        // Safe reads flush the device ranges beneath, so they have to walk the page tables
+        if (const u8* const pointer = GetFastmemPointer(gpu_src_addr, size)) {
+            CountTranslation(num_direct_translations);
+            std::memcpy(dest_buffer, pointer, size);
+            return;
+        }
+    }
+    CountTranslation(num_page_walks);
     MemoryOperation<true>(gpu_src_addr, size, mapped_big, set_to_zero, read_short_pages);
 }
 
@@ -451,6 +608,18 @@ void MemoryManager::WriteBlockImpl(GPUVAddr gpu_dest_addr, const void* src_buffe
         GPUVAddr base = (page_index << big_page_bits) + offset;
         MemoryOperation<false>(base, copy_amount, mapped_normal, just_advance, just_advance);
     };
+    if (trace_recorder) [[unlikely]] {
+        TraceAccess(gpu_dest_addr, size);
+    }
+    if constexpr (!is_safe) {
+        // Safe writes invalidate the device ranges beneath, so they have to walk the page tables
+        if (u8* const pointer = GetFastmemPointer(gpu_dest_addr, size)) {
+            CountTranslation(num_direct_translations);
+            std::memcpy(pointer, src_buffer, size);
+            return;
+        }
+    }
+    CountTranslation(num_page_walks);
     MemoryOperation<true>(gpu_dest_addr, size, mapped_big, just_advance, write_short_pages);
 }
 
@@ -762,7 +931,124 @@ void MemoryManager::FlushCaching() {
     accumulator->Clear();
 }
 
+std::optional<DAddr> MemoryManager::GetBigPageSpanAddress(GPUVAddr gpu_addr,
+                                                          std::size_t size) const {
+    if (!IsWithinGPUAddressRange(gpu_addr) || GetEntry<true>(gpu_addr) != EntryType::Mapped) {
+        return std::nullopt;
+    }
+    // Big pages are mapped to contiguous device memory, the host pointer is resolved on access
+    const u64 offset = gpu_addr & big_page_mask;
+    if (offset + size > big_page_size) {
+        return std::nullopt;
+    }
+    const DAddr dev_addr_base =
+        static_cast<DAddr>(big_page_table_dev[PageEntryIndex<true>(gpu_addr)]) << cpu_page_bits;
+    return dev_addr_base + offset;
+}
+
+u8* MemoryManager::GetFastmemPointer(GPUVAddr gpu_addr, std::size_t size) const {
+    if (!fastmem_base) {
+        return nullptr;
+    }
+    const GPUVAddr end_addr = gpu_addr + std::max<std::size_t>(size, 1);
+    if (end_addr > address_space_size || end_addr <= gpu_addr) [[unlikely]] {
+        return nullptr;
+    }
+    // Pages that are not mapped in the arena fault on access, check them before handing out
+    // the pointer and let the caller walk the page tables instead
+    const u64 last_page = (end_addr - 1) >> cpu_page_bits;
+    for (u64 page = gpu_addr >> cpu_page_bits; page <= last_page;) {
+        const u64 bit = page % 64;
+        const u64 num_bits = std::min<u64>(64 - bit, last_page - page + 1);
+        const u64 mask = (num_bits == 64 ? ~0ULL : (1ULL << num_bits) - 1) << bit;
+        if ((fastmem_pages[page / 64] & mask) != mask) {
+            return nullptr;
+        }
+        page += num_bits;
+    }
+    return fastmem_base + gpu_addr;
+}
+
+void MemoryManager::UpdateFastmem(GPUVAddr gpu_addr, std::size_t size) {
+    if (!fastmem_base) {
+        return;
+    }
+    const GPUVAddr start = Common::AlignDown(gpu_addr, Core::DEVICE_PAGESIZE);
+    const GPUVAddr end =
+        std::min(Common::AlignUp(gpu_addr + size, Core::DEVICE_PAGESIZE), address_space_size);
+
+    // Drop the previous mappings of the range, it is mapped again from the page tables
+    for (GPUVAddr run_start = start; run_start < end;) {
+        if (!IsFastmemPage(run_start)) {
+            run_start += Core::DEVICE_PAGESIZE;
+            continue;
+        }
+        GPUVAddr run_end = run_start + Core::DEVICE_PAGESIZE;
+        while (run_end < end && IsFastmemPage(run_end)) {
+            run_end += Core::DEVICE_PAGESIZE;
+        }
+        // Clear the pages first, so no new accesses are directed to the range being unmapped
+        SetFastmemPages(run_start, run_end - run_start, false);
+        fastmem_arena->Unmap(run_start, run_end - run_start, false);
+        run_start = run_end;
+    }
+
+    // Map the pages backed by device memory, in runs that are contiguous in physical memory
+    std::optional<std::pair<GPUVAddr, PAddr>> run;
+    const auto flush_run = [&](GPUVAddr run_end) {
+        if (run) {
+            const auto [run_start, physical_addr] = *run;
+            fastmem_arena->Map(run_start, physical_addr, run_end - run_start,
+                               Common::MemoryPermission::ReadWrite, false);
+            SetFastmemPages(run_start, run_end - run_start, true);
+            run.reset();
+        }
+    };
+    for (GPUVAddr page = start; page < end; page += Core::DEVICE_PAGESIZE) {
+        const auto dev_addr = GpuToCpuAddress(page);
+        const PAddr physical_addr = dev_addr ? memory.GetPhysicalRawAddressFromDAddr(*dev_addr) : 0;
+        if (physical_addr == 0) {
+            // Pages without backing memory are left to the page table walk
+            flush_run(page);
+            continue;
+        }
+        if (run && run->second + (page - run->first) == physical_addr) {
+            continue;
+        }
+        flush_run(page);
+        run.emplace(page, physical_addr);
+    }
+    flush_run(end);
+}
+
+void MemoryManager::SetFastmemPages(GPUVAddr gpu_addr, std::size_t size, bool is_mapped) {
+    const u64 last_page = (gpu_addr + size - 1) >> cpu_page_bits;
+    for (u64 page = gpu_addr >> cpu_page_bits; page <= last_page; ++page) {
+        const u64 bit = 1ULL << (page % 64);
+        fastmem_pages[page / 64] = is_mapped ? fastmem_pages[page / 64] | bit
+                                             : fastmem_pages[page / 64] & ~bit;
+    }
+}
+
+MemoryTranslationStatistics MemoryManager::GetTranslationStatistics() const noexcept {
+    return {
+        .num_direct_translations = num_direct_translations.load(std::memory_order_relaxed),
+        .num_page_walks = num_page_walks.load(std::memory_order_relaxed),
+    };
+}
+
 const u8* MemoryManager::GetSpan(const GPUVAddr src_addr, const std::size_t size) const {
+    if (trace_recorder) [[unlikely]] {
+        TraceAccess(src_addr, size);
+    }
+    if (u8* const pointer = GetFastmemPointer(src_addr, size)) {
+        CountTranslation(num_direct_translations);
+        return pointer;
+    }
+    CountTranslation(num_page_walks);
+    if (const auto dev_addr = GetBigPageSpanAddress(src_addr, size)) {
+        return memory.GetSpan(*dev_addr, size);
+    }
     if (!IsContinuousRange(src_addr, size)) {
         return nullptr;
     }
@@ -774,6 +1060,17 @@ const u8* MemoryManager::GetSpan(const GPUVAddr src_addr, const std::size_t size
 }
 
 u8* MemoryManager::GetSpan(const GPUVAddr src_addr, const std::size_t size) {
+    if (trace_recorder) [[unlikely]] {
+        TraceAccess(src_addr, size);
+    }
+    if (u8* const pointer = GetFastmemPointer(src_addr, size)) {
+        CountTranslation(num_direct_translations);
+        return pointer;
+    }
+    CountTranslation(num_page_walks);
+    if (const auto dev_addr = GetBigPageSpanAddress(src_addr, size)) {
+        return memory.GetSpan(*dev_addr, size);
+    }
     if (!IsContinuousRange(src_addr, size)) {
         return nullptr;
     }
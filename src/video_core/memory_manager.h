@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <vector>
@@ -31,8 +32,21 @@ namespace Core {
 class System;
 } // namespace Core
 
+namespace Common {
+class HostMemory;
+}
+
 namespace Tegra {
 
+class GpuTraceRecorder;
+
+struct MemoryTranslationStatistics {
+    /// Accesses translated through the fastmem arena
+    u64 num_direct_translations{};
+    /// Accesses translated by walking the GPU page tables
+    u64 num_page_walks{};
+};
+
 class MemoryManager final {
 public:
     explicit MemoryManager(Core::System& system_, u64 address_space_bits_ = 40,
@@ -50,6 +64,9 @@ public:
     /// Binds a renderer to the memory manager.
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Records the layout and mappings of the address space, and the memory accessed through it.
+    void BindTraceRecorder(GpuTraceRecorder* recorder);
+
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr) const;
 
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr, std::size_t size) const;
@@ -65,11 +82,7 @@ public:
 
     template <typename T>
     [[nodiscard]] T* GetPointer(GPUVAddr addr) {
-        const auto address{GpuToCpuAddress(addr)};
-        if (!address) {
-            return {};
-        }
-        return memory.GetPointer<T>(*address);
+        return reinterpret_cast<T*>(TranslatePointer(addr, sizeof(T)));
     }
 
     template <typename T>
@@ -157,7 +170,51 @@ public:
     const u8* GetSpan(const GPUVAddr src_addr, const std::size_t size) const;
     u8* GetSpan(const GPUVAddr src_addr, const std::size_t size);
 
+    /// Returns how many accesses were translated through the fastmem arena and how many walked
+    /// the page tables
+    [[nodiscard]] MemoryTranslationStatistics GetTranslationStatistics() const noexcept;
+
 private:
+    /// Returns the host pointer of the first byte of a GPU range, the range is used to check
+    /// whether it can be accessed through the fastmem arena
+    [[nodiscard]] u8* TranslatePointer(GPUVAddr gpu_addr, std::size_t size) const;
+
+    /**
+     * Returns the host pointer of a GPU range in the fastmem arena, or nullptr when the range is
+     * not entirely mapped in the arena and has to be translated through the page tables.
+     */
+    [[nodiscard]] u8* GetFastmemPointer(GPUVAddr gpu_addr, std::size_t size) const;
+
+    /// Mirrors the current translation of a GPU range in the fastmem arena
+    void UpdateFastmem(GPUVAddr gpu_addr, std::size_t size);
+
+    /// Marks the CPU pages of a GPU range as mapped or not mapped in the fastmem arena
+    void SetFastmemPages(GPUVAddr gpu_addr, std::size_t size, bool is_mapped);
+
+    [[nodiscard]] bool IsFastmemPage(GPUVAddr gpu_addr) const {
+        const u64 page = gpu_addr >> cpu_page_bits;
+        return ((fastmem_pages[page / 64] >> (page % 64)) & 1) != 0;
+    }
+
+    /// Counts a translation without atomic read-modify-writes, a lost update is acceptable
+    static void CountTranslation(std::atomic<u64>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the device address of a span that lies within a single mapped big page, or nullopt
+     * when the span has to be checked through the page tables.
+     */
+    [[nodiscard]] std::optional<DAddr> GetBigPageSpanAddress(GPUVAddr gpu_addr,
+                                                             std::size_t size) const;
+
+    /// Records the device memory pages of a GPU range before they are accessed
+    void TraceAccess(GPUVAddr gpu_addr, std::size_t size) const;
+
+    /// Records the mapped and reserved ranges of one of the page tables
+    template <bool is_big_page>
+    void TraceMappings() const;
+
     template <bool is_big_pages, typename FuncMapped, typename FuncReserved, typename FuncUnmapped>
     inline void MemoryOperation(GPUVAddr gpu_src_addr, std::size_t size, FuncMapped&& func_mapped,
                                 FuncReserved&& func_reserved, FuncUnmapped&& func_unmapped) const;
@@ -207,6 +264,7 @@ private:
     u64 big_page_table_mask;
 
     VideoCore::RasterizerInterface* rasterizer = nullptr;
+    GpuTraceRecorder* trace_recorder = nullptr;
 
     enum class EntryType : u64 {
         Free = 0,
@@ -236,6 +294,16 @@ private:
     Common::VirtualBuffer<u32> big_page_table_dev;
 
     std::vector<u64> big_page_continuous;
+
+    /// Host view of the address space over device memory, only created when GPU fastmem is on
+    std::unique_ptr<Common::HostMemory> fastmem_arena;
+    /// Host pointer of GPU address zero in the arena, null when GPU fastmem is off
+    u8* fastmem_base{};
+    /// One bit per CPU page of the address space, set when the page is mapped in the arena
+    Common::VirtualBuffer<u64> fastmem_pages;
+    mutable std::atomic<u64> num_direct_translations{};
+    mutable std::atomic<u64> num_page_walks{};
+
     boost::container::small_vector<std::pair<DAddr, std::size_t>, 32> page_stash{};
     boost::container::small_vector<std::pair<DAddr, std::size_t>, 32> page_stash2{};
 
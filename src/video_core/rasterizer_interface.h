@@ -31,6 +31,7 @@ enum class LoadCallbackStage {
     Prepare,
     Build,
     Complete,
+    HotSetReady, ///< The pipelines first used in previous sessions have been built
 };
 using DiskResourceLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
 
@@ -152,6 +152,10 @@ void RasterizerOpenGL::SyncVertexInstances() {
 
 void RasterizerOpenGL::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.LoadDiskResources(title_id);
+    }
     shader_cache.LoadDiskResources(title_id, stop_loading, callback);
 }
 
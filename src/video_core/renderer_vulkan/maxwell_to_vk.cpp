@@ -302,7 +302,8 @@ FormatInfo SurfaceFormat(const Device& device, FormatType format_type, bool with
         }
         break;
     }
-    return {device.GetSupportedFormat(tuple.format, usage, format_type), attachable, storage};
+    const VkFormat format = device.GetSupportedFormat(tuple.format, usage, format_type);
+    return {format, attachable, storage, format != tuple.format};
 }
 
 VkShaderStageFlagBits ShaderStage(Shader::Stage stage) {
@@ -32,6 +32,7 @@ struct FormatInfo {
     VkFormat format;
     bool attachable;
     bool storage;
+    bool is_alternative; ///< The host doesn't support the wanted format, format replaces it
 };
 
 /**
@@ -14,6 +14,7 @@
 #include "video_core/renderer_vulkan/vk_descriptor_pool.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/renderer_vulkan/vk_update_descriptor.h"
+#include "video_core/shader_environment.h"
 #include "video_core/vulkan_common/vulkan_wrapper.h"
 
 namespace VideoCore {
@@ -45,6 +46,11 @@ public:
     void Configure(Tegra::Engines::KeplerCompute& kepler_compute, Tegra::MemoryManager& gpu_memory,
                    Scheduler& scheduler, BufferCache& buffer_cache, TextureCache& texture_cache);
 
+    /// Usage statistics of the pipeline in this session, recorded by the pipeline cache
+    [[nodiscard]] VideoCommon::PipelineUsage& Usage() noexcept {
+        return usage;
+    }
+
 private:
     const Device& device;
     vk::PipelineCache& pipeline_cache;
@@ -63,6 +69,8 @@ private:
     std::condition_variable build_condvar;
     std::mutex build_mutex;
     std::atomic_bool is_built{false};
+
+    VideoCommon::PipelineUsage usage{};
 };
 
 } // namespace Vulkan
@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <exception>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -13,6 +15,7 @@
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
 #include "common/microprofile.h"
+#include "common/thread.h"
 #include "common/thread_worker.h"
 #include "core/core.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
@@ -54,6 +57,9 @@ using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
 
 constexpr u32 CACHE_VERSION = 11;
+/// Pipelines first used within this time after boot form the hot set, the boot only waits for them
+/// and the rest of the cache is built in the background
+constexpr u32 HOT_SET_WINDOW_MS = 30'000;
 constexpr std::array<char, 8> VULKAN_CACHE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'v', 'k', 'c', 'h'};
 
 template <typename Container>
@@ -312,7 +318,8 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
       use_vulkan_pipeline_cache{Settings::values.use_vulkan_driver_pipeline_cache.GetValue()},
       workers(device.HasBrokenParallelShaderCompiling() ? 1ULL : GetTotalPipelineWorkers(),
               "VkPipelineBuilder"),
-      serialization_thread(1, "VkPipelineSerialization") {
+      serialization_thread(1, "VkPipelineSerialization"),
+      emit_workers(Maxwell::MaxShaderStage - 1, "VkPipelineEmit") {
     const auto& float_control{device.FloatControlProperties()};
     const VkDriverId driver_id{device.GetDriverID()};
     profile = Shader::Profile{
@@ -412,6 +419,11 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
 }
 
 PipelineCache::~PipelineCache() {
+    if (background_thread.joinable()) {
+        background_thread.request_stop();
+        background_thread.join();
+    }
+    SavePipelineUsage();
     if (use_vulkan_pipeline_cache && !vulkan_pipeline_cache_filename.empty()) {
         SerializeVulkanPipelineCache(vulkan_pipeline_cache_filename, vulkan_pipeline_cache,
                                      CACHE_VERSION);
@@ -430,6 +442,9 @@ GraphicsPipeline* PipelineCache::CurrentGraphicsPipeline() {
     if (current_pipeline) {
         GraphicsPipeline* const next{current_pipeline->Next(graphics_key)};
         if (next) {
+            if (next != current_pipeline) {
+                RecordUsage(next->Usage());
+            }
             current_pipeline = next;
             return BuiltPipeline(current_pipeline);
         }
@@ -450,12 +465,18 @@ ComputePipeline* PipelineCache::CurrentComputePipeline() {
         .shared_memory_size = qmd.shared_alloc,
         .workgroup_size{qmd.block_dim_x, qmd.block_dim_y, qmd.block_dim_z},
     };
+    if (has_background_pipelines.load(std::memory_order_acquire)) {
+        TakeBackgroundPipelines();
+    }
     const auto [pair, is_new]{compute_cache.try_emplace(key)};
     auto& pipeline{pair->second};
-    if (!is_new) {
-        return pipeline.get();
+    if (is_new) {
+        MarkPipelineCreated(VideoCommon::PipelineKeyHash(key));
+        pipeline = CreateComputePipeline(key, shader);
+    }
+    if (pipeline) {
+        RecordUsage(pipeline->Usage());
     }
-    pipeline = CreateComputePipeline(key, shader);
     return pipeline.get();
 }
 
@@ -471,6 +492,8 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         return;
     }
     pipeline_cache_filename = base_dir / "vulkan.bin";
+    pipeline_usage_filename = base_dir / "vulkan_usage.bin";
+    pipeline_usage = VideoCommon::LoadPipelineUsage(pipeline_usage_filename);
 
     if (use_vulkan_pipeline_cache) {
         vulkan_pipeline_cache_filename = base_dir / "vulkan_pipelines.bin";
@@ -489,65 +512,78 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (device.IsKhrPipelineExecutablePropertiesEnabled()) {
         state.statistics = std::make_unique<PipelineStatistics>(device);
     }
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
-        ComputePipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
+    // Records are read and deserialized by the workers right before building their pipeline, so
+    // the environments of the whole cache are never held in memory at once
+    const Common::UniqueFunction<void, std::istream&, FileEnvironment> load_compute{
+        [&](std::istream& file, FileEnvironment env) {
+            ComputePipelineCacheKey key;
+            file.read(reinterpret_cast<char*>(&key), sizeof(key));
 
-        workers.QueueWork([this, key, env_ = std::move(env), &state, &callback]() mutable {
             ShaderPools pools;
-            auto pipeline{CreateComputePipeline(pools, key, env_, state.statistics.get(), false)};
+            auto pipeline{CreateComputePipeline(pools, key, env, state.statistics.get(), false)};
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 compute_cache.emplace(key, std::move(pipeline));
             }
-            ++state.built;
-            if (state.has_loaded) {
-                callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
+        }};
+    const Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>> load_graphics{
+        [&](std::istream& file, std::vector<FileEnvironment> envs) {
+            GraphicsPipelineCacheKey key;
+            file.read(reinterpret_cast<char*>(&key), sizeof(key));
+            if (!HasDynamicFeatures(key)) {
+                return;
             }
-        });
-        ++state.total;
-    }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
-        GraphicsPipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
-        if ((key.state.extended_dynamic_state != 0) !=
-                dynamic_features.has_extended_dynamic_state ||
-            (key.state.extended_dynamic_state_2 != 0) !=
-                dynamic_features.has_extended_dynamic_state_2 ||
-            (key.state.extended_dynamic_state_2_extra != 0) !=
-                dynamic_features.has_extended_dynamic_state_2_extra ||
-            (key.state.extended_dynamic_state_3_blend != 0) !=
-                dynamic_features.has_extended_dynamic_state_3_blend ||
-            (key.state.extended_dynamic_state_3_enables != 0) !=
-                dynamic_features.has_extended_dynamic_state_3_enables ||
-            (key.state.dynamic_vertex_input != 0) != dynamic_features.has_dynamic_vertex_input) {
-            return;
-        }
-        workers.QueueWork([this, key, envs_ = std::move(envs), &state, &callback]() mutable {
             ShaderPools pools;
             boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
+            for (auto& env : envs) {
                 env_ptrs.push_back(&env);
             }
             auto pipeline{CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs),
                                                  state.statistics.get(), false)};
-
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 graphics_cache.emplace(key, std::move(pipeline));
             }
+        }};
+
+    auto loader{std::make_unique<VideoCommon::PipelineCacheLoader>()};
+    const bool has_cache{loader->Open(stop_loading, pipeline_cache_filename, CACHE_VERSION,
+                                      pipeline_usage, sizeof(ComputePipelineCacheKey),
+                                      sizeof(GraphicsPipelineCacheKey))};
+    const size_t num_records{has_cache ? loader->NumRecords() : 0};
+
+    // Records are sorted by first use, the boot only waits for the pipelines first used early in
+    // previous sessions. Without usage statistics every pipeline is built before booting.
+    size_t num_hot{num_records};
+    if (!pipeline_usage.empty()) {
+        num_hot = 0;
+        while (num_hot < num_records) {
+            const auto usage_it{pipeline_usage.find(loader->KeyHash(num_hot))};
+            if (usage_it == pipeline_usage.end() ||
+                usage_it->second.first_use_ms > HOT_SET_WINDOW_MS) {
+                break;
+            }
+            ++num_hot;
+        }
+    }
+    state.total = num_hot;
+    for (size_t index = 0; index < num_hot; ++index) {
+        workers.QueueWork([index, &loader, &load_compute, &load_graphics, &state, &callback] {
+            try {
+                loader->Load(index, load_compute, load_graphics);
+            } catch (const std::ios_base::failure& e) {
+                LOG_ERROR(Render_Vulkan, "Failed to load cached pipeline: {}", e.what());
+            }
+            std::scoped_lock lock{state.mutex};
             ++state.built;
             if (state.has_loaded) {
                 callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
             }
         });
-        ++state.total;
-    }};
-    VideoCommon::LoadPipelines(stop_loading, pipeline_cache_filename, CACHE_VERSION, load_compute,
-                               load_graphics);
+    }
 
-    LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}", state.total);
+    LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}, Hot Pipeline Count: {}", num_records,
+             num_hot);
 
     std::unique_lock lock{state.mutex};
     callback(VideoCore::LoadCallbackStage::Build, 0, state.total);
@@ -555,6 +591,10 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     lock.unlock();
 
     workers.WaitForRequests(stop_loading);
+    if (stop_loading.stop_requested()) {
+        return;
+    }
+    usage_epoch = std::chrono::steady_clock::now();
 
     if (use_vulkan_pipeline_cache) {
         SerializeVulkanPipelineCache(vulkan_pipeline_cache_filename, vulkan_pipeline_cache,
@@ -564,12 +604,175 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (state.statistics) {
         state.statistics->Report();
     }
+
+    if (num_hot < num_records) {
+        LOG_INFO(Render_Vulkan, "Hot pipeline set ready, building {} pipelines in the background",
+                 num_records - num_hot);
+        callback(VideoCore::LoadCallbackStage::HotSetReady, num_hot, num_records);
+
+        is_building_background = true;
+        background_thread = std::jthread(
+            [this, loader = std::move(loader), num_hot](std::stop_token stop_token) mutable {
+                BuildColdPipelines(stop_token, std::move(loader), num_hot);
+            });
+    }
+}
+
+void PipelineCache::BuildColdPipelines(std::stop_token stop_token,
+                                       std::unique_ptr<VideoCommon::PipelineCacheLoader> loader,
+                                       size_t first_index) {
+    Common::SetCurrentThreadName("VkColdPipelines");
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::Low);
+
+    // Pipelines are handed to the render thread, which moves them into the caches on a miss
+    ShaderPools pools;
+    const Common::UniqueFunction<void, std::istream&, FileEnvironment> load_compute{
+        [&](std::istream& file, FileEnvironment env) {
+            ComputePipelineCacheKey key;
+            file.read(reinterpret_cast<char*>(&key), sizeof(key));
+
+            pools.ReleaseContents();
+            auto pipeline{CreateComputePipeline(pools, key, env, nullptr, false)};
+            if (!pipeline) {
+                return;
+            }
+            std::scoped_lock lock{background_mutex};
+            background_compute.emplace_back(key, std::move(pipeline));
+            has_background_pipelines.store(true, std::memory_order_release);
+        }};
+    const Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>> load_graphics{
+        [&](std::istream& file, std::vector<FileEnvironment> envs) {
+            GraphicsPipelineCacheKey key;
+            file.read(reinterpret_cast<char*>(&key), sizeof(key));
+            if (!HasDynamicFeatures(key)) {
+                return;
+            }
+            boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
+            for (auto& env : envs) {
+                env_ptrs.push_back(&env);
+            }
+            pools.ReleaseContents();
+            auto pipeline{
+                CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs), nullptr, false)};
+            if (!pipeline) {
+                return;
+            }
+            std::scoped_lock lock{background_mutex};
+            background_graphics.emplace_back(key, std::move(pipeline));
+            has_background_pipelines.store(true, std::memory_order_release);
+        }};
+
+    size_t num_built{};
+    for (size_t index = first_index; index < loader->NumRecords(); ++index) {
+        if (stop_token.stop_requested()) {
+            break;
+        }
+        {
+            std::scoped_lock lock{background_mutex};
+            if (created_key_hashes.contains(loader->KeyHash(index))) {
+                continue;
+            }
+        }
+        shader_notify.MarkShaderBuilding();
+        try {
+            loader->Load(index, load_compute, load_graphics);
+            ++num_built;
+        } catch (const std::ios_base::failure& e) {
+            LOG_ERROR(Render_Vulkan, "Failed to load cached pipeline: {}", e.what());
+        }
+        shader_notify.MarkShaderComplete();
+    }
+    LOG_INFO(Render_Vulkan, "Built {} cached pipelines in the background", num_built);
+
+    std::scoped_lock lock{background_mutex};
+    is_building_background = false;
+    created_key_hashes.clear();
+}
+
+void PipelineCache::TakeBackgroundPipelines() {
+    std::scoped_lock lock{background_mutex};
+    // Pipelines the rasterizer created in the meantime are kept, duplicates are dropped
+    for (auto& [key, pipeline] : background_graphics) {
+        graphics_cache.try_emplace(key, std::move(pipeline));
+    }
+    for (auto& [key, pipeline] : background_compute) {
+        compute_cache.try_emplace(key, std::move(pipeline));
+    }
+    background_graphics.clear();
+    background_compute.clear();
+    has_background_pipelines.store(false, std::memory_order_relaxed);
+}
+
+void PipelineCache::MarkPipelineCreated(u64 key_hash) {
+    if (!is_building_background.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::scoped_lock lock{background_mutex};
+    if (is_building_background) {
+        created_key_hashes.insert(key_hash);
+    }
+}
+
+bool PipelineCache::HasDynamicFeatures(const GraphicsPipelineCacheKey& key) const noexcept {
+    return (key.state.extended_dynamic_state != 0) ==
+               dynamic_features.has_extended_dynamic_state &&
+           (key.state.extended_dynamic_state_2 != 0) ==
+               dynamic_features.has_extended_dynamic_state_2 &&
+           (key.state.extended_dynamic_state_2_extra != 0) ==
+               dynamic_features.has_extended_dynamic_state_2_extra &&
+           (key.state.extended_dynamic_state_3_blend != 0) ==
+               dynamic_features.has_extended_dynamic_state_3_blend &&
+           (key.state.extended_dynamic_state_3_enables != 0) ==
+               dynamic_features.has_extended_dynamic_state_3_enables &&
+           (key.state.dynamic_vertex_input != 0) == dynamic_features.has_dynamic_vertex_input;
+}
+
+void PipelineCache::RecordUsage(VideoCommon::PipelineUsage& usage) {
+    if (usage.hit_count == 0) {
+        const auto elapsed{std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - usage_epoch)};
+        usage.first_use_ms = static_cast<u32>(
+            std::min<s64>(elapsed.count(), std::numeric_limits<u32>::max()));
+    }
+    if (usage.hit_count != std::numeric_limits<u32>::max()) {
+        ++usage.hit_count;
+    }
+}
+
+void PipelineCache::SavePipelineUsage() {
+    if (pipeline_usage_filename.empty()) {
+        return;
+    }
+    const auto merge_usage{[this](const auto& cache) {
+        for (const auto& [key, pipeline] : cache) {
+            if (!pipeline || pipeline->Usage().hit_count == 0) {
+                continue;
+            }
+            const VideoCommon::PipelineUsage& usage{pipeline->Usage()};
+            const auto [it, is_new]{
+                pipeline_usage.try_emplace(VideoCommon::PipelineKeyHash(key), usage)};
+            if (!is_new) {
+                // Keep the earliest first use seen across sessions and accumulate the hits
+                it->second.first_use_ms = std::min(it->second.first_use_ms, usage.first_use_ms);
+                it->second.hit_count = static_cast<u32>(
+                    std::min<u64>(u64{it->second.hit_count} + usage.hit_count,
+                                  std::numeric_limits<u32>::max()));
+            }
+        }
+    }};
+    merge_usage(graphics_cache);
+    merge_usage(compute_cache);
+    VideoCommon::SavePipelineUsage(pipeline_usage_filename, pipeline_usage);
 }
 
 GraphicsPipeline* PipelineCache::CurrentGraphicsPipelineSlowPath() {
+    if (has_background_pipelines.load(std::memory_order_acquire)) {
+        TakeBackgroundPipelines();
+    }
     const auto [pair, is_new]{graphics_cache.try_emplace(graphics_key)};
     auto& pipeline{pair->second};
     if (is_new) {
+        MarkPipelineCreated(VideoCommon::PipelineKeyHash(graphics_key));
         pipeline = CreateGraphicsPipeline();
     }
     if (!pipeline) {
@@ -578,6 +781,9 @@ GraphicsPipeline* PipelineCache::CurrentGraphicsPipelineSlowPath() {
     if (current_pipeline) {
         current_pipeline->AddTransition(pipeline.get());
     }
+    if (pipeline.get() != current_pipeline) {
+        RecordUsage(pipeline->Usage());
+    }
     current_pipeline = pipeline.get();
     return BuiltPipeline(current_pipeline);
 }
@@ -655,6 +861,11 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     }
     std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
     std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
+    std::array<Shader::RuntimeInfo, Maxwell::MaxShaderStage> runtime_infos;
+    std::array<Shader::Backend::Bindings, Maxwell::MaxShaderStage> stage_bindings;
+    std::array<std::vector<u32>, Maxwell::MaxShaderStage> codes;
+    std::array<std::exception_ptr, Maxwell::MaxShaderStage> exceptions;
+    boost::container::static_vector<size_t, Maxwell::MaxShaderStage> stages;
 
     const Shader::IR::Program* previous_stage{};
     Shader::Backend::Bindings binding;
@@ -671,16 +882,47 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         const size_t stage_index{index - 1};
         infos[stage_index] = &program.info;
 
-        const auto runtime_info{MakeRuntimeInfo(programs, key, program, previous_stage)};
-        ConvertLegacyToGeneric(program, runtime_info);
-        const std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
+        runtime_infos[stage_index] = MakeRuntimeInfo(programs, key, program, previous_stage);
+        ConvertLegacyToGeneric(program, runtime_infos[stage_index]);
+
+        // Assign the bindings of each stage up front so stages don't depend on each other
+        stage_bindings[stage_index] = binding;
+        Shader::Backend::SPIRV::AdvanceBindings(profile, program.info, binding);
+        stages.push_back(index);
+        previous_stage = &program;
+    }
+    const auto emit_stage{[&](size_t index) {
+        const size_t stage_index{index - 1};
+        try {
+            codes[stage_index] = EmitSPIRV(profile, runtime_infos[stage_index], programs[index],
+                                           stage_bindings[stage_index]);
+        } catch (...) {
+            exceptions[stage_index] = std::current_exception();
+        }
+    }};
+    if (build_in_parallel && stages.size() > 1) {
+        // The rasterizer is waiting on this pipeline, emit the first stage on this thread and the
+        // rest on the emit workers
+        for (size_t i = 1; i < stages.size(); ++i) {
+            emit_workers.QueueWork([&emit_stage, index = stages[i]] { emit_stage(index); });
+        }
+        emit_stage(stages.front());
+        emit_workers.WaitForRequests();
+    } else {
+        std::ranges::for_each(stages, emit_stage);
+    }
+    for (const size_t index : stages) {
+        const size_t stage_index{index - 1};
+        if (exceptions[stage_index]) {
+            std::rethrow_exception(exceptions[stage_index]);
+        }
+        const std::vector<u32>& code{codes[stage_index]};
         device.SaveShader(code);
         modules[stage_index] = BuildShader(device, code);
         if (device.HasDebuggingToolAttached()) {
             const std::string name{fmt::format("Shader {:016x}", key.unique_hashes[index])};
             modules[stage_index].SetObjectNameEXT(name.c_str());
         }
-        previous_stage = &program;
     }
     Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
     return std::make_unique<GraphicsPipeline>(
@@ -4,14 +4,20 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "common/common_types.h"
+#include "common/polyfill_thread.h"
 #include "common/thread_worker.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/value.h"
@@ -27,6 +33,7 @@
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/shader_cache.h"
+#include "video_core/shader_environment.h"
 
 namespace Core {
 class System;
@@ -118,6 +125,23 @@ private:
 
     [[nodiscard]] GraphicsPipeline* BuiltPipeline(GraphicsPipeline* pipeline) const noexcept;
 
+    /// Build the cached pipelines that were not needed first, after the boot has completed
+    void BuildColdPipelines(std::stop_token stop_token,
+                            std::unique_ptr<VideoCommon::PipelineCacheLoader> loader,
+                            size_t first_index);
+
+    /// Move the pipelines built in the background into the pipeline caches
+    void TakeBackgroundPipelines();
+
+    /// Stop the background builds from building a pipeline the rasterizer already created
+    void MarkPipelineCreated(u64 key_hash);
+
+    [[nodiscard]] bool HasDynamicFeatures(const GraphicsPipelineCacheKey& key) const noexcept;
+
+    void RecordUsage(VideoCommon::PipelineUsage& usage);
+
+    void SavePipelineUsage();
+
     std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline();
 
     std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline(
@@ -164,12 +188,27 @@ private:
 
     std::filesystem::path pipeline_cache_filename;
 
+    std::filesystem::path pipeline_usage_filename;
+    VideoCommon::PipelineUsageMap pipeline_usage;
+    std::chrono::steady_clock::time_point usage_epoch{std::chrono::steady_clock::now()};
+
     std::filesystem::path vulkan_pipeline_cache_filename;
     vk::PipelineCache vulkan_pipeline_cache;
 
     Common::ThreadWorker workers;
     Common::ThreadWorker serialization_thread;
+    Common::ThreadWorker emit_workers;
     DynamicFeatures dynamic_features;
+
+    std::mutex background_mutex;
+    std::vector<std::pair<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipeline>>>
+        background_graphics;
+    std::vector<std::pair<ComputePipelineCacheKey, std::unique_ptr<ComputePipeline>>>
+        background_compute;
+    std::unordered_set<u64> created_key_hashes;
+    std::atomic_bool has_background_pipelines{};
+    std::atomic_bool is_building_background{};
+    std::jthread background_thread;
 };
 
 } // namespace Vulkan
@@ -841,6 +841,10 @@ std::optional<FramebufferTextureInfo> RasterizerVulkan::AccelerateDisplay(
 
 void RasterizerVulkan::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
+    {
+        std::scoped_lock lock{texture_cache.mutex};
+        texture_cache.LoadDiskResources(title_id);
+    }
     pipeline_cache.LoadDiskResources(title_id, stop_loading, callback);
 }
 
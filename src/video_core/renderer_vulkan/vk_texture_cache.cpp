@@ -897,7 +897,18 @@ bool TextureCacheRuntime::ShouldReinterpret(Image& dst, Image& src) {
         src.info.format == PixelFormat::D32_FLOAT_S8_UINT) {
         return true;
     }
-    return false;
+    // Copy the bits of same sized formats without a conversion pass through a buffer
+    if (VideoCommon::FindFormatConversion(dst.info.format, src.info.format) !=
+            VideoCommon::FormatConversion::None ||
+        !VideoCore::Surface::IsReinterpretCompatible(dst.info.format, src.info.format)) {
+        return false;
+    }
+    // Alternative host formats store texels differently, e.g. X8_D24 emulated with D32_SFLOAT
+    const auto is_alternative = [this](PixelFormat format) {
+        return MaxwellToVK::SurfaceFormat(device, FormatType::Optimal, false, format)
+            .is_alternative;
+    };
+    return !is_alternative(dst.info.format) && !is_alternative(src.info.format);
 }
 
 VkBuffer TextureCacheRuntime::GetTemporaryBuffer(size_t needed_size) {
@@ -946,10 +957,12 @@ void TextureCacheRuntime::ReinterpretImage(Image& dst, Image& src,
     std::ranges::transform(copies, vk_out_copies.begin(), [dst_aspect_mask](const auto& copy) {
         return MakeBufferImageCopy(copy, false, dst_aspect_mask);
     });
-    const u32 img_bpp = BytesPerBlock(dst.info.format);
-    size_t total_size = 0;
-    for (const auto& copy : copies) {
-        total_size += copy.extent.width * copy.extent.height * copy.extent.depth * img_bpp;
+    boost::container::small_vector<size_t, 16> buffer_offsets(copies.size());
+    const size_t total_size = VideoCommon::MakeReinterpretBufferOffsets(
+        copies, BytesPerBlock(dst.info.format), buffer_offsets);
+    for (size_t i = 0; i < copies.size(); ++i) {
+        vk_in_copies[i].bufferOffset = buffer_offsets[i];
+        vk_out_copies[i].bufferOffset = buffer_offsets[i];
     }
     const VkBuffer copy_buffer = GetTemporaryBuffer(total_size);
     const VkImage dst_image = dst.Handle();
@@ -1188,66 +1201,26 @@ void TextureCacheRuntime::BlitImage(Framebuffer* dst_framebuffer, ImageView& dst
 }
 
 void TextureCacheRuntime::ConvertImage(Framebuffer* dst, ImageView& dst_view, ImageView& src_view) {
-    switch (dst_view.format) {
-    case PixelFormat::R16_UNORM:
-        if (src_view.format == PixelFormat::D16_UNORM) {
-            return blit_image_helper.ConvertD16ToR16(dst, src_view);
-        }
-        break;
-    case PixelFormat::A8B8G8R8_SRGB:
-        if (src_view.format == PixelFormat::D32_FLOAT) {
-            return blit_image_helper.ConvertD32FToABGR8(dst, src_view);
-        }
-        break;
-    case PixelFormat::A8B8G8R8_UNORM:
-        if (src_view.format == PixelFormat::S8_UINT_D24_UNORM) {
-            return blit_image_helper.ConvertD24S8ToABGR8(dst, src_view);
-        }
-        if (src_view.format == PixelFormat::D24_UNORM_S8_UINT) {
-            return blit_image_helper.ConvertS8D24ToABGR8(dst, src_view);
-        }
-        if (src_view.format == PixelFormat::D32_FLOAT) {
-            return blit_image_helper.ConvertD32FToABGR8(dst, src_view);
-        }
-        break;
-    case PixelFormat::B8G8R8A8_SRGB:
-        if (src_view.format == PixelFormat::D32_FLOAT) {
-            return blit_image_helper.ConvertD32FToABGR8(dst, src_view);
-        }
-        break;
-    case PixelFormat::B8G8R8A8_UNORM:
-        if (src_view.format == PixelFormat::D32_FLOAT) {
-            return blit_image_helper.ConvertD32FToABGR8(dst, src_view);
-        }
-        break;
-    case PixelFormat::R32_FLOAT:
-        if (src_view.format == PixelFormat::D32_FLOAT) {
-            return blit_image_helper.ConvertD32ToR32(dst, src_view);
-        }
-        break;
-    case PixelFormat::D16_UNORM:
-        if (src_view.format == PixelFormat::R16_UNORM) {
-            return blit_image_helper.ConvertR16ToD16(dst, src_view);
-        }
-        break;
-    case PixelFormat::S8_UINT_D24_UNORM:
-        if (src_view.format == PixelFormat::A8B8G8R8_UNORM ||
-            src_view.format == PixelFormat::B8G8R8A8_UNORM) {
-            return blit_image_helper.ConvertABGR8ToD24S8(dst, src_view);
-        }
-        break;
-    case PixelFormat::D32_FLOAT:
-        if (src_view.format == PixelFormat::A8B8G8R8_UNORM ||
-            src_view.format == PixelFormat::B8G8R8A8_UNORM ||
-            src_view.format == PixelFormat::A8B8G8R8_SRGB ||
-            src_view.format == PixelFormat::B8G8R8A8_SRGB) {
-            return blit_image_helper.ConvertABGR8ToD32F(dst, src_view);
-        }
-        if (src_view.format == PixelFormat::R32_FLOAT) {
-            return blit_image_helper.ConvertR32ToD32(dst, src_view);
-        }
-        break;
-    default:
+    switch (VideoCommon::FindFormatConversion(dst_view.format, src_view.format)) {
+    case VideoCommon::FormatConversion::D16ToR16:
+        return blit_image_helper.ConvertD16ToR16(dst, src_view);
+    case VideoCommon::FormatConversion::R16ToD16:
+        return blit_image_helper.ConvertR16ToD16(dst, src_view);
+    case VideoCommon::FormatConversion::D32ToR32:
+        return blit_image_helper.ConvertD32ToR32(dst, src_view);
+    case VideoCommon::FormatConversion::R32ToD32:
+        return blit_image_helper.ConvertR32ToD32(dst, src_view);
+    case VideoCommon::FormatConversion::D24S8ToABGR8:
+        return blit_image_helper.ConvertD24S8ToABGR8(dst, src_view);
+    case VideoCommon::FormatConversion::S8D24ToABGR8:
+        return blit_image_helper.ConvertS8D24ToABGR8(dst, src_view);
+    case VideoCommon::FormatConversion::D32FToABGR8:
+        return blit_image_helper.ConvertD32FToABGR8(dst, src_view);
+    case VideoCommon::FormatConversion::ABGR8ToD24S8:
+        return blit_image_helper.ConvertABGR8ToD24S8(dst, src_view);
+    case VideoCommon::FormatConversion::ABGR8ToD32F:
+        return blit_image_helper.ConvertABGR8ToD32F(dst, src_view);
+    case VideoCommon::FormatConversion::None:
         break;
     }
     UNIMPLEMENTED_MSG("Unimplemented format copy from {} to {}", src_view.format, dst_view.format);
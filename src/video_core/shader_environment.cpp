@@ -2,11 +2,20 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/cityhash.h"
@@ -14,8 +23,10 @@
 #include "common/div_ceil.h"
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
 #include "common/polyfill_ranges.h"
+#include "common/zstd_compression.h"
 #include "shader_recompiler/environment.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/memory_manager.h"
@@ -26,6 +37,9 @@
 namespace VideoCommon {
 
 constexpr std::array<char, 8> MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+constexpr std::array<char, 8> INDEXED_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'p', 'i', 'd', 'x'};
+constexpr std::array<char, 8> USAGE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'u', 's', 'a', 'g'};
+constexpr u32 USAGE_VERSION = 1;
 
 constexpr size_t INST_SIZE = sizeof(u64);
 
@@ -193,7 +207,7 @@ void GenericEnvironment::Dump(u64 pipeline_hash, u64 shader_hash) {
     DumpImpl(pipeline_hash, shader_hash, code, read_highest, read_lowest, initial_offset, stage);
 }
 
-void GenericEnvironment::Serialize(std::ofstream& file) const {
+void GenericEnvironment::Serialize(std::ostream& file) const {
     const u64 code_size{static_cast<u64>(CachedSizeBytes())};
     const u64 num_texture_types{static_cast<u64>(texture_types.size())};
     const u64 num_texture_pixel_formats{static_cast<u64>(texture_pixel_formats.size())};
@@ -448,7 +462,7 @@ u32 ComputeEnvironment::ReadViewportTransformState() {
     return viewport_transform_state;
 }
 
-void FileEnvironment::Deserialize(std::ifstream& file) {
+void FileEnvironment::Deserialize(std::istream& file) {
     u64 code_size{};
     u64 num_texture_types{};
     u64 num_texture_pixel_formats{};
@@ -582,58 +596,349 @@ std::optional<Shader::ReplaceConstant> FileEnvironment::GetReplaceConstBuffer(u3
     return it->second;
 }
 
-void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
-                       const std::filesystem::path& filename, u32 cache_version) try {
-    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
+namespace {
+using namespace Common::Literals;
+
+/// Header preceding each zstd compressed pipeline record in an indexed cache file
+static_assert(sizeof(PipelineRecordHeader) == 16);
+
+/// Upper bound of an uncompressed record, used to reject corrupted headers
+constexpr u32 MAX_RECORD_SIZE = 64_MiB;
+
+/// Read-only stream buffer over a decompressed record
+class RecordStreamBuf final : public std::streambuf {
+public:
+    explicit RecordStreamBuf(std::span<const u8> data) {
+        // The stream is only read from, std::streambuf needs a mutable pointer nonetheless
+        char* const begin{const_cast<char*>(reinterpret_cast<const char*>(data.data()))};
+        setg(begin, begin, begin + data.size());
+    }
+};
+
+void WriteRecord(std::ostream& file, std::string_view record, u64 key_hash) {
+    const std::vector<u8> compressed{Common::Compression::CompressDataZSTDDefault(
+        reinterpret_cast<const u8*>(record.data()), record.size())};
+    const PipelineRecordHeader header{
+        .key_hash = key_hash,
+        .compressed_size = static_cast<u32>(compressed.size()),
+        .uncompressed_size = static_cast<u32>(record.size()),
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header))
+        .write(reinterpret_cast<const char*>(compressed.data()),
+               static_cast<std::streamsize>(compressed.size()));
+}
+
+void WriteFileHeader(std::ostream& file, u32 cache_version) {
+    file.write(INDEXED_MAGIC_NUMBER.data(), INDEXED_MAGIC_NUMBER.size())
+        .write(reinterpret_cast<const char*>(&cache_version), sizeof(cache_version));
+}
+
+void RemoveCacheFile(const std::filesystem::path& filename) {
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+
+/// Deserialize the environments of a record and hand the stream to the matching callback
+template <typename LoadCompute, typename LoadGraphics>
+void LoadRecord(std::istream& stream, LoadCompute&& load_compute, LoadGraphics&& load_graphics) {
+    u32 num_envs{};
+    stream.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
+    if (num_envs == 0 || num_envs > Maxwell::MaxShaderProgram) {
+        throw std::ios_base::failure("Invalid number of environments");
+    }
+    std::vector<FileEnvironment> envs(num_envs);
+    for (FileEnvironment& env : envs) {
+        env.Deserialize(stream);
+    }
+    if (envs.front().ShaderStage() == Shader::Stage::Compute) {
+        load_compute(stream, std::move(envs.front()));
+    } else {
+        load_graphics(stream, std::move(envs));
+    }
+}
+
+/// Scan the record headers of an indexed cache file, seeking over the compressed payloads.
+/// Records superseded by a later record with the same key are dropped from the index.
+/// @returns Offset where the last well formed record ends
+std::streamoff BuildIndex(std::ifstream& file, std::streamoff end,
+                          std::vector<PipelineRecord>& records) {
+    std::unordered_map<u64, size_t> latest;
+    std::streamoff offset{file.tellg()};
+    while (end - offset >= static_cast<std::streamoff>(sizeof(PipelineRecordHeader))) {
+        PipelineRecordHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        const std::streamoff record_end{offset + static_cast<std::streamoff>(sizeof(header)) +
+                                        header.compressed_size};
+        if (header.uncompressed_size > MAX_RECORD_SIZE || record_end > end) {
+            break;
+        }
+        const auto [it, is_new]{latest.try_emplace(header.key_hash, records.size())};
+        if (is_new) {
+            records.push_back({offset, header});
+        } else {
+            records[it->second] = {offset, header};
+        }
+        file.seekg(record_end);
+        offset = record_end;
+    }
+    std::ranges::sort(records, {}, &PipelineRecord::offset);
+    return offset;
+}
+
+/// Move the records with usage statistics to the front, in first use order
+void SortByUsage(std::vector<PipelineRecord>& records, const PipelineUsageMap& usage) {
+    if (usage.empty()) {
+        return;
+    }
+    const auto find_usage{[&](const PipelineRecord& record) -> const PipelineUsage* {
+        const auto it{usage.find(record.header.key_hash)};
+        return it != usage.end() ? &it->second : nullptr;
+    }};
+    const auto used_end{std::stable_partition(
+        records.begin(), records.end(),
+        [&](const PipelineRecord& record) { return find_usage(record) != nullptr; })};
+    std::stable_sort(records.begin(), used_end,
+                     [&](const PipelineRecord& lhs, const PipelineRecord& rhs) {
+                         const PipelineUsage& lhs_usage{*find_usage(lhs)};
+                         const PipelineUsage& rhs_usage{*find_usage(rhs)};
+                         if (lhs_usage.first_use_ms != rhs_usage.first_use_ms) {
+                             return lhs_usage.first_use_ms < rhs_usage.first_use_ms;
+                         }
+                         return lhs_usage.hit_count > rhs_usage.hit_count;
+                     });
+}
+
+/// Read the compressed payload of an indexed record
+void ReadRecordData(std::ifstream& file, const PipelineRecord& record,
+                    std::vector<u8>& compressed) {
+    compressed.resize(record.header.compressed_size);
+    file.seekg(record.offset + static_cast<std::streamoff>(sizeof(PipelineRecordHeader)))
+        .read(reinterpret_cast<char*>(compressed.data()),
+              static_cast<std::streamsize>(compressed.size()));
+}
+
+/// Decompress the payload of an indexed record
+std::vector<u8> DecompressRecord(const PipelineRecord& record, std::span<const u8> compressed) {
+    std::vector<u8> payload{Common::Compression::DecompressDataZSTD(compressed)};
+    if (payload.size() != record.header.uncompressed_size) {
+        throw std::ios_base::failure("Corrupted pipeline cache record");
+    }
+    return payload;
+}
+
+/// Read and decompress the payload of an indexed record
+std::vector<u8> ReadRecordPayload(std::ifstream& file, const PipelineRecord& record,
+                                  std::vector<u8>& compressed) {
+    ReadRecordData(file, record, compressed);
+    return DecompressRecord(record, compressed);
+}
+
+/// Return true when a non empty cache file starts with the indexed magic number
+bool IsIndexedCacheFile(const std::filesystem::path& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    std::array<char, 8> magic_number{};
+    file.read(magic_number.data(), magic_number.size());
+    return file && magic_number == INDEXED_MAGIC_NUMBER;
+}
+
+/// Read the next record of a legacy sequential cache file, the environments followed by the key
+/// @returns Offset of the key in the record
+size_t ReadLegacyRecord(std::ifstream& file, std::streamoff end, size_t compute_key_size,
+                        size_t graphics_key_size, std::string& record) {
+    const std::streamoff record_begin{file.tellg()};
+    std::streamoff key_begin{};
+    size_t key_size{};
+    LoadRecord(
+        file,
+        [&](std::istream& stream, FileEnvironment) {
+            key_begin = stream.tellg();
+            key_size = compute_key_size;
+        },
+        [&](std::istream& stream, std::vector<FileEnvironment>) {
+            key_begin = stream.tellg();
+            key_size = graphics_key_size;
+        });
+    const std::streamoff record_end{key_begin + static_cast<std::streamoff>(key_size)};
+    if (record_end > end) {
+        throw std::ios_base::failure("Truncated legacy pipeline cache record");
+    }
+    record.resize(static_cast<size_t>(record_end - record_begin));
+    file.seekg(record_begin).read(record.data(), static_cast<std::streamsize>(record.size()));
+    return static_cast<size_t>(key_begin - record_begin);
+}
+
+/// Convert a legacy sequential cache file to an indexed cache file. The records are written to a
+/// temporary file that replaces the legacy file once every record has been converted, so an
+/// interrupted conversion leaves the legacy file untouched.
+/// @returns False when the conversion was interrupted or the file couldn't be replaced
+bool MigrateLegacyPipelines(std::stop_token stop_loading, std::ifstream& file, std::streamoff end,
+                            const std::filesystem::path& filename, u32 cache_version,
+                            size_t compute_key_size, size_t graphics_key_size) {
+    auto temp_filename{filename};
+    temp_filename += ".tmp";
+    std::ofstream output(temp_filename, std::ios::binary | std::ios::trunc);
+    const auto discard{[&] {
+        output.close();
+        std::error_code ec;
+        std::filesystem::remove(temp_filename, ec);
+    }};
+    try {
+        output.exceptions(std::ios::failbit);
+        WriteFileHeader(output, cache_version);
+
+        std::string record;
+        while (file.tellg() != end) {
+            if (stop_loading.stop_requested()) {
+                discard();
+                return false;
+            }
+            const size_t key_offset{
+                ReadLegacyRecord(file, end, compute_key_size, graphics_key_size, record)};
+            WriteRecord(output, record, PipelineKeyHash(std::span(record).subspan(key_offset)));
+        }
+        output.close();
+    } catch (const std::ios_base::failure&) {
+        discard();
+        throw;
+    }
+    file.close();
+
+    std::error_code ec;
+    std::filesystem::rename(temp_filename, filename, ec);
+    if (ec) {
+        LOG_ERROR(Common_Filesystem, "Failed to replace the legacy pipeline cache: {}",
+                  ec.message());
+        discard();
+        return false;
+    }
+    LOG_INFO(Common_Filesystem, "Migrated pipeline cache to the indexed format");
+    return true;
+}
+} // Anonymous namespace
+
+u64 PipelineKeyHash(std::span<const char> key) {
+    return Common::CityHash64(key.data(), key.size());
+}
+
+PipelineUsageMap LoadPipelineUsage(const std::filesystem::path& filename) try {
+    PipelineUsageMap usage;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return usage;
+    }
     file.exceptions(std::ifstream::failbit);
+    std::array<char, 8> magic_number;
+    u32 version;
+    u32 num_entries;
+    file.read(magic_number.data(), magic_number.size())
+        .read(reinterpret_cast<char*>(&version), sizeof(version))
+        .read(reinterpret_cast<char*>(&num_entries), sizeof(num_entries));
+    if (magic_number != USAGE_MAGIC_NUMBER || version != USAGE_VERSION) {
+        LOG_INFO(Common_Filesystem, "Ignoring invalid pipeline usage file");
+        return usage;
+    }
+    usage.reserve(num_entries);
+    for (u32 i = 0; i < num_entries; ++i) {
+        u64 key_hash;
+        PipelineUsage entry;
+        file.read(reinterpret_cast<char*>(&key_hash), sizeof(key_hash))
+            .read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        usage.insert_or_assign(key_hash, entry);
+    }
+    return usage;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "Failed to read pipeline usage file: {}", e.what());
+    return {};
+}
+
+void SavePipelineUsage(const std::filesystem::path& filename, const PipelineUsageMap& usage) try {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline usage file {}",
                   Common::FS::PathToUTF8String(filename));
         return;
     }
-    if (file.tellp() == 0) {
-        // Write header
-        file.write(MAGIC_NUMBER.data(), MAGIC_NUMBER.size())
-            .write(reinterpret_cast<const char*>(&cache_version), sizeof(cache_version));
+    file.exceptions(std::ofstream::failbit);
+    const u32 num_entries{static_cast<u32>(usage.size())};
+    file.write(USAGE_MAGIC_NUMBER.data(), USAGE_MAGIC_NUMBER.size())
+        .write(reinterpret_cast<const char*>(&USAGE_VERSION), sizeof(USAGE_VERSION))
+        .write(reinterpret_cast<const char*>(&num_entries), sizeof(num_entries));
+    for (const auto& [key_hash, entry] : usage) {
+        file.write(reinterpret_cast<const char*>(&key_hash), sizeof(key_hash))
+            .write(reinterpret_cast<const char*>(&entry), sizeof(entry));
     }
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "Failed to write pipeline usage file: {}", e.what());
+    RemoveCacheFile(filename);
+}
+
+void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
+                       const std::filesystem::path& filename, u32 cache_version) try {
     if (!std::ranges::all_of(envs, &GenericEnvironment::CanBeSerialized)) {
         return;
     }
+    std::ostringstream record;
+    record.exceptions(std::ios::failbit);
     const u32 num_envs{static_cast<u32>(envs.size())};
-    file.write(reinterpret_cast<const char*>(&num_envs), sizeof(num_envs));
+    record.write(reinterpret_cast<const char*>(&num_envs), sizeof(num_envs));
     for (const GenericEnvironment* const env : envs) {
-        env->Serialize(file);
+        env->Serialize(record);
     }
-    file.write(key.data(), key.size_bytes());
+    record.write(key.data(), key.size_bytes());
 
-} catch (const std::ios_base::failure& e) {
-    LOG_ERROR(Common_Filesystem, "{}", e.what());
-    if (!Common::FS::RemoveFile(filename)) {
-        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
+    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
+    file.exceptions(std::ifstream::failbit);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
                   Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    if (file.tellp() == 0) {
+        WriteFileHeader(file, cache_version);
+    } else if (!IsIndexedCacheFile(filename)) {
+        // A legacy file whose migration was interrupted, it is migrated on the next load
+        LOG_WARNING(Common_Filesystem, "Not appending to legacy pipeline cache file {}",
+                    Common::FS::PathToUTF8String(filename));
+        return;
     }
+    WriteRecord(file, record.view(), PipelineKeyHash(key));
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    RemoveCacheFile(filename);
 }
 
-void LoadPipelines(
-    std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics) try {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
-        return;
+PipelineCacheLoader::PipelineCacheLoader() = default;
+
+PipelineCacheLoader::~PipelineCacheLoader() = default;
+
+bool PipelineCacheLoader::Open(std::stop_token stop_loading, const std::filesystem::path& filename,
+                               u32 expected_cache_version, const PipelineUsageMap& usage,
+                               size_t compute_key_size, size_t graphics_key_size) try {
+    records.clear();
+    file = std::make_unique<std::ifstream>(filename, std::ios::binary | std::ios::ate);
+    if (!file->is_open()) {
+        file.reset();
+        return false;
     }
-    file.exceptions(std::ifstream::failbit);
-    const auto end{file.tellg()};
-    file.seekg(0, std::ios::beg);
+    file->exceptions(std::ifstream::failbit);
+    std::streamoff end{file->tellg()};
+    file->seekg(0, std::ios::beg);
 
     std::array<char, 8> magic_number;
     u32 cache_version;
-    file.read(magic_number.data(), magic_number.size())
+    file->read(magic_number.data(), magic_number.size())
         .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
-    if (magic_number != MAGIC_NUMBER || cache_version != expected_cache_version) {
-        file.close();
+    const bool is_indexed{magic_number == INDEXED_MAGIC_NUMBER};
+    const bool is_legacy{magic_number == MAGIC_NUMBER};
+    if (!(is_indexed || is_legacy) || cache_version != expected_cache_version) {
+        file.reset();
         if (Common::FS::RemoveFile(filename)) {
-            if (magic_number != MAGIC_NUMBER) {
+            if (!(is_indexed || is_legacy)) {
                 LOG_ERROR(Common_Filesystem, "Invalid pipeline cache file");
             }
             if (cache_version != expected_cache_version) {
@@ -644,31 +949,181 @@ void LoadPipelines(
                       "Invalid pipeline cache file and failed to delete it in \"{}\"",
                       Common::FS::PathToUTF8String(filename));
         }
+        return false;
+    }
+    if (is_legacy) {
+        if (!MigrateLegacyPipelines(stop_loading, *file, end, filename, expected_cache_version,
+                                    compute_key_size, graphics_key_size)) {
+            file.reset();
+            return false;
+        }
+        file->open(filename, std::ios::binary | std::ios::ate);
+        end = file->tellg();
+        file->seekg(static_cast<std::streamoff>(magic_number.size() + sizeof(cache_version)));
+    }
+    const std::streamoff valid_end{BuildIndex(*file, end, records)};
+    if (valid_end != end) {
+        LOG_WARNING(Common_Filesystem, "Pipeline cache file is truncated, dropping {} bytes",
+                    end - valid_end);
+        file->close();
+        std::error_code ec;
+        std::filesystem::resize_file(filename, static_cast<std::uintmax_t>(valid_end), ec);
+        if (ec) {
+            LOG_ERROR(Common_Filesystem, "Failed to truncate pipeline cache file: {}",
+                      ec.message());
+        }
+        file->open(filename, std::ios::binary);
+    }
+    SortByUsage(records, usage);
+    return true;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    file.reset();
+    records.clear();
+    RemoveCacheFile(filename);
+    return false;
+}
+
+void PipelineCacheLoader::Load(
+    size_t index, const Common::UniqueFunction<void, std::istream&, FileEnvironment>& load_compute,
+    const Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>>&
+        load_graphics) {
+    const PipelineRecord& record{records[index]};
+    std::vector<u8> compressed;
+    {
+        std::scoped_lock lock{mutex};
+        ReadRecordData(*file, record, compressed);
+    }
+    const std::vector<u8> payload{DecompressRecord(record, compressed)};
+    RecordStreamBuf buffer{payload};
+    std::istream stream{&buffer};
+    stream.exceptions(std::ios::failbit);
+    LoadRecord(stream, load_compute, load_graphics);
+}
+
+void LoadPipelines(
+    std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
+    const PipelineUsageMap& usage, size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::istream&, FileEnvironment> load_compute,
+    Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>> load_graphics) try {
+    PipelineCacheLoader loader;
+    if (!loader.Open(stop_loading, filename, expected_cache_version, usage, compute_key_size,
+                     graphics_key_size)) {
         return;
     }
-    while (file.tellg() != end) {
+    for (size_t index = 0; index < loader.NumRecords(); ++index) {
         if (stop_loading.stop_requested()) {
             return;
         }
-        u32 num_envs{};
-        file.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
-        std::vector<FileEnvironment> envs(num_envs);
-        for (FileEnvironment& env : envs) {
-            env.Deserialize(file);
+        loader.Load(index, load_compute, load_graphics);
+    }
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    RemoveCacheFile(filename);
+}
+
+std::optional<u32> ReadPipelineCache(const std::filesystem::path& filename,
+                                     std::vector<PipelineCacheRecord>& records,
+                                     size_t compute_key_size, size_t graphics_key_size) try {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+        return std::nullopt;
+    }
+    file.exceptions(std::ifstream::failbit);
+    const std::streamoff end{file.tellg()};
+    file.seekg(0, std::ios::beg);
+
+    std::array<char, 8> magic_number;
+    u32 cache_version;
+    file.read(magic_number.data(), magic_number.size())
+        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
+    if (magic_number == MAGIC_NUMBER) {
+        // Legacy records can't be split without the key sizes of the renderer that wrote them
+        if (compute_key_size == 0 || graphics_key_size == 0) {
+            LOG_ERROR(Common_Filesystem,
+                      "{} is a legacy pipeline cache file of an unknown renderer",
+                      Common::FS::PathToUTF8String(filename));
+            return std::nullopt;
         }
-        if (envs.front().ShaderStage() == Shader::Stage::Compute) {
-            load_compute(file, std::move(envs.front()));
-        } else {
-            load_graphics(file, std::move(envs));
+        std::string record;
+        while (file.tellg() != end) {
+            const size_t key_offset{
+                ReadLegacyRecord(file, end, compute_key_size, graphics_key_size, record)};
+            records.push_back({
+                .key_hash = PipelineKeyHash(std::span(record).subspan(key_offset)),
+                .data = std::vector<u8>(record.begin(), record.end()),
+            });
         }
+        return cache_version;
+    }
+    if (magic_number != INDEXED_MAGIC_NUMBER) {
+        LOG_ERROR(Common_Filesystem, "{} is not a pipeline cache file",
+                  Common::FS::PathToUTF8String(filename));
+        return std::nullopt;
+    }
+    std::vector<PipelineRecord> index;
+    if (BuildIndex(file, end, index) != end) {
+        LOG_WARNING(Common_Filesystem, "Pipeline cache file {} is truncated",
+                    Common::FS::PathToUTF8String(filename));
     }
+    records.reserve(records.size() + index.size());
+    std::vector<u8> compressed;
+    for (const PipelineRecord& record : index) {
+        records.push_back({
+            .key_hash = record.header.key_hash,
+            .data = ReadRecordPayload(file, record, compressed),
+        });
+    }
+    return cache_version;
 
 } catch (const std::ios_base::failure& e) {
     LOG_ERROR(Common_Filesystem, "{}", e.what());
-    if (!Common::FS::RemoveFile(filename)) {
-        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
+    return std::nullopt;
+}
+
+bool WritePipelineCache(const std::filesystem::path& filename, u32 cache_version,
+                        std::span<const PipelineCacheRecord> records) try {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
                   Common::FS::PathToUTF8String(filename));
+        return false;
+    }
+    file.exceptions(std::ofstream::failbit);
+    WriteFileHeader(file, cache_version);
+    for (const PipelineCacheRecord& record : records) {
+        const std::string_view data{reinterpret_cast<const char*>(record.data.data()),
+                                    record.data.size()};
+        WriteRecord(file, data, record.key_hash);
+    }
+    return true;
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    RemoveCacheFile(filename);
+    return false;
+}
+
+std::vector<FileEnvironment> DeserializePipelineRecord(std::span<const u8> record,
+                                                       std::span<const u8>& key) {
+    RecordStreamBuf buffer{record};
+    std::istream stream{&buffer};
+    stream.exceptions(std::ios::failbit);
+    u32 num_envs{};
+    stream.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
+    if (num_envs == 0 || num_envs > Maxwell::MaxShaderProgram) {
+        throw std::ios_base::failure("Invalid number of environments");
+    }
+    std::vector<FileEnvironment> envs(num_envs);
+    for (FileEnvironment& env : envs) {
+        env.Deserialize(stream);
     }
+    key = record.subspan(static_cast<size_t>(std::streamoff{stream.tellg()}));
+    return envs;
 }
 
 } // namespace VideoCommon
@@ -8,6 +8,7 @@
 #include <iosfwd>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <type_traits>
@@ -60,7 +61,7 @@ public:
 
     void Dump(u64 pipeline_hash, u64 shader_hash) override;
 
-    void Serialize(std::ofstream& file) const;
+    void Serialize(std::ostream& file) const;
 
     bool HasHLEMacroState() const override {
         return has_hle_engine_state;
@@ -165,7 +166,7 @@ public:
     FileEnvironment& operator=(const FileEnvironment&) = delete;
     FileEnvironment(const FileEnvironment&) = delete;
 
-    void Deserialize(std::ifstream& file);
+    void Deserialize(std::istream& file);
 
     [[nodiscard]] u64 ReadInstruction(u32 address) override;
 
@@ -212,6 +213,28 @@ private:
     u32 viewport_transform_state = 1;
 };
 
+/// Usage statistics of a cached pipeline, used to prioritize its build on the next boot
+struct PipelineUsage {
+    u32 first_use_ms; ///< Time from the end of the boot to the first bind of the pipeline
+    u32 hit_count;    ///< Number of times the pipeline has been bound
+};
+
+/// Pipeline usage statistics indexed by the hash of the pipeline key
+using PipelineUsageMap = std::unordered_map<u64, PipelineUsage>;
+
+[[nodiscard]] u64 PipelineKeyHash(std::span<const char> key);
+
+template <typename Key>
+[[nodiscard]] u64 PipelineKeyHash(const Key& key) {
+    static_assert(std::is_trivially_copyable_v<Key>);
+    static_assert(std::has_unique_object_representations_v<Key>);
+    return PipelineKeyHash(std::span(reinterpret_cast<const char*>(&key), sizeof(key)));
+}
+
+[[nodiscard]] PipelineUsageMap LoadPipelineUsage(const std::filesystem::path& filename);
+
+void SavePipelineUsage(const std::filesystem::path& filename, const PipelineUsageMap& usage);
+
 void SerializePipeline(std::span<const char> key, std::span<const GenericEnvironment* const> envs,
                        const std::filesystem::path& filename, u32 cache_version);
 
@@ -224,9 +247,89 @@ void SerializePipeline(const Key& key, const Envs& envs, const std::filesystem::
                       std::span(envs.data(), envs.size()), filename, cache_version);
 }
 
+/// Pipeline record of an indexed cache file, the serialized environments followed by the key
+struct PipelineCacheRecord {
+    u64 key_hash;
+    std::vector<u8> data;
+};
+
+/// Append the records of a pipeline cache file to records, the file is never modified.
+/// Legacy sequential files are split with the key sizes of the renderer that wrote them, they are
+/// rejected when the key sizes are zero.
+/// @returns The cache version of the file, or std::nullopt when it can't be read
+[[nodiscard]] std::optional<u32> ReadPipelineCache(const std::filesystem::path& filename,
+                                                   std::vector<PipelineCacheRecord>& records,
+                                                   size_t compute_key_size,
+                                                   size_t graphics_key_size);
+
+/// Write records to an indexed pipeline cache file, replacing its previous contents
+bool WritePipelineCache(const std::filesystem::path& filename, u32 cache_version,
+                        std::span<const PipelineCacheRecord> records);
+
+/// Deserialize the environments of a pipeline record, key is set to the remaining key bytes
+/// @throws std::ios_base::failure when the record is malformed
+[[nodiscard]] std::vector<FileEnvironment> DeserializePipelineRecord(std::span<const u8> record,
+                                                                     std::span<const u8>& key);
+
+/// Header of a record in an indexed pipeline cache file, followed by the compressed record
+struct PipelineRecordHeader {
+    u64 key_hash;
+    u32 compressed_size;
+    u32 uncompressed_size;
+};
+
+/// Location of a record in an indexed pipeline cache file
+struct PipelineRecord {
+    s64 offset;
+    PipelineRecordHeader header;
+};
+
+/**
+ * Indexed pipeline cache file opened for loading.
+ *
+ * Opening the file only reads the record headers to build an index, each record is read,
+ * decompressed and deserialized when it is loaded. Pipelines can then be built on demand, or
+ * in the background after the ones needed first.
+ */
+class PipelineCacheLoader {
+public:
+    explicit PipelineCacheLoader();
+    ~PipelineCacheLoader();
+
+    /// Open a cache file and index its records. Records with usage statistics come first, in the
+    /// order they were first used, followed by the rest in file order. Files in the legacy
+    /// sequential format are converted first, the key sizes are needed to find their records.
+    /// @returns False when there is no usable cache file
+    bool Open(std::stop_token stop_loading, const std::filesystem::path& filename,
+              u32 expected_cache_version, const PipelineUsageMap& usage, size_t compute_key_size,
+              size_t graphics_key_size);
+
+    [[nodiscard]] size_t NumRecords() const noexcept {
+        return records.size();
+    }
+
+    [[nodiscard]] u64 KeyHash(size_t index) const noexcept {
+        return records[index].header.key_hash;
+    }
+
+    /// Load a record and hand it to the callback of its pipeline type, thread safe
+    /// @throws std::ios_base::failure when the record is malformed
+    void Load(size_t index,
+              const Common::UniqueFunction<void, std::istream&, FileEnvironment>& load_compute,
+              const Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>>&
+                  load_graphics);
+
+private:
+    std::mutex mutex;
+    std::unique_ptr<std::ifstream> file;
+    std::vector<PipelineRecord> records;
+};
+
+/// Load all the pipelines of a cache file, in the order of PipelineCacheLoader
 void LoadPipelines(
     std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics);
+    const PipelineUsageMap& usage, size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::istream&, FileEnvironment> load_compute,
+    Common::UniqueFunction<void, std::istream&, std::vector<FileEnvironment>> load_graphics);
 
 } // namespace VideoCommon
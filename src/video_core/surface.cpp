@@ -367,6 +367,14 @@ bool IsPixelFormatSignedInteger(PixelFormat format) {
     }
 }
 
+bool IsReinterpretCompatible(PixelFormat lhs, PixelFormat rhs) {
+    const auto is_plain = [](PixelFormat format) {
+        return DefaultBlockWidth(format) == 1 && DefaultBlockHeight(format) == 1 &&
+               GetFormatType(format) != SurfaceType::DepthStencil;
+    };
+    return is_plain(lhs) && is_plain(rhs) && BytesPerBlock(lhs) == BytesPerBlock(rhs);
+}
+
 size_t PixelComponentSizeBitsInteger(PixelFormat format) {
     switch (format) {
     case PixelFormat::A8B8G8R8_SINT:
@@ -513,6 +513,11 @@ bool IsPixelFormatInteger(PixelFormat format);
 
 bool IsPixelFormatSignedInteger(PixelFormat format);
 
+/// Returns true when the texels of one format can be copied bit for bit into the other.
+/// Combined depth stencil formats are excluded, their aspects are stored separately on the host.
+/// Only guest block sizes are compared, callers must check the host stores both formats natively.
+bool IsReinterpretCompatible(PixelFormat lhs, PixelFormat rhs);
+
 size_t PixelComponentSizeBitsInteger(PixelFormat format);
 
 std::pair<u32, u32> GetASTCBlockSize(PixelFormat format);
@@ -3,17 +3,29 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstring>
 #include <span>
 #include <bc_decoder.h>
 
+#include "common/alignment.h"
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/texture_cache/decode_bc.h"
+#include "video_core/textures/workers.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
 
 namespace VideoCommon {
 
 namespace {
 constexpr u32 BLOCK_SIZE = 4;
 
+/// Minimum amount of blocks decoded by each worker task
+constexpr u32 MIN_BLOCKS_PER_TASK = 256;
+
 using VideoCore::Surface::PixelFormat;
 
 constexpr bool IsSigned(PixelFormat pixel_format) {
@@ -41,6 +53,398 @@ constexpr u32 BlockSize(PixelFormat pixel_format) {
         return 16;
     }
 }
+
+constexpr std::array<u16, 4> WEIGHTS_2{0, 21, 43, 64};
+constexpr std::array<u16, 8> WEIGHTS_3{0, 9, 18, 27, 37, 46, 55, 64};
+constexpr std::array<u16, 16> WEIGHTS_4{0, 4, 9, 13, 17, 21, 26, 30,
+                                        34, 38, 43, 47, 51, 55, 60, 64};
+
+/// Bits of a 128-bit block, read from the least significant bit
+class BlockBits {
+public:
+    explicit BlockBits(const u8* src) {
+        std::memcpy(&low, src, sizeof(low));
+        std::memcpy(&high, src + sizeof(low), sizeof(high));
+    }
+
+    /// Returns up to 64 bits starting at 'offset'
+    [[nodiscard]] u64 Get64(u32 offset) const {
+        if (offset >= 64) {
+            return high >> (offset - 64);
+        }
+        return offset == 0 ? low : (low >> offset) | (high << (64 - offset));
+    }
+
+    [[nodiscard]] u32 Get(u32 offset, u32 count) const {
+        return static_cast<u32>(Get64(offset) & ((1ULL << count) - 1));
+    }
+
+    [[nodiscard]] u8 LowByte() const {
+        return static_cast<u8>(low);
+    }
+
+private:
+    u64 low;
+    u64 high;
+};
+
+/**
+ * Splits a stream of 16 indices into one index per texel. The first texel is an anchor, its index
+ * is stored with its most significant bit omitted.
+ */
+template <u32 index_bits>
+std::array<u8, 16> UnpackIndices(u64 stream) {
+    constexpr u64 mask = (1ULL << index_bits) - 1;
+    std::array<u8, 16> indices;
+    indices[0] = static_cast<u8>(stream & (mask >> 1));
+    stream >>= index_bits - 1;
+    for (size_t texel = 1; texel < indices.size(); ++texel) {
+        indices[texel] = static_cast<u8>(stream & mask);
+        stream >>= index_bits;
+    }
+    return indices;
+}
+
+/// Writes the texels of a decoded block, clipping them against the image
+template <typename Texel>
+void StoreBlock(const std::array<Texel, 16>& texels, u8* dst, size_t x, size_t y, size_t width,
+                size_t height) {
+    const size_t pitch = width * sizeof(Texel);
+    const size_t block_width = std::min<size_t>(BLOCK_SIZE, width - x);
+    const size_t block_height = std::min<size_t>(BLOCK_SIZE, height - y);
+    for (size_t row = 0; row < block_height; ++row) {
+        std::memcpy(dst + row * pitch, texels.data() + row * BLOCK_SIZE,
+                    block_width * sizeof(Texel));
+    }
+}
+
+/**
+ * Interpolates a BC7 palette between two RGBA8 endpoints. Each entry is
+ * ((64 - w) * e0 + w * e1 + 32) >> 6 for every channel, with 'w' the weight of the entry.
+ */
+template <size_t size>
+std::array<u32, size> InterpolateBc7(const std::array<u8, 4>& e0, const std::array<u8, 4>& e1,
+                                     const std::array<u16, size>& weights) {
+    std::array<u32, size> palette;
+#ifdef ARCHITECTURE_x86_64
+    // Two entries per register, four 16-bit channels each
+    s32 packed_e0;
+    s32 packed_e1;
+    std::memcpy(&packed_e0, e0.data(), sizeof(packed_e0));
+    std::memcpy(&packed_e1, e1.data(), sizeof(packed_e1));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i e0_lanes = _mm_unpacklo_epi8(_mm_set1_epi32(packed_e0), zero);
+    const __m128i e1_lanes = _mm_unpacklo_epi8(_mm_set1_epi32(packed_e1), zero);
+    const __m128i total = _mm_set1_epi16(64);
+    const __m128i round = _mm_set1_epi16(32);
+    const auto interpolate_pair = [&](u16 w0, u16 w1) {
+        const __m128i w = _mm_set_epi16(w1, w1, w1, w1, w0, w0, w0, w0);
+        const __m128i product_0 = _mm_mullo_epi16(e0_lanes, _mm_sub_epi16(total, w));
+        const __m128i product_1 = _mm_mullo_epi16(e1_lanes, w);
+        return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(product_0, product_1), round), 6);
+    };
+    for (size_t entry = 0; entry < size; entry += 4) {
+        const __m128i low = interpolate_pair(weights[entry], weights[entry + 1]);
+        const __m128i high = interpolate_pair(weights[entry + 2], weights[entry + 3]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(palette.data() + entry),
+                         _mm_packus_epi16(low, high));
+    }
+#else
+    for (size_t entry = 0; entry < size; ++entry) {
+        const u32 weight = weights[entry];
+        std::array<u8, 4> color;
+        for (size_t channel = 0; channel < 4; ++channel) {
+            color[channel] =
+                static_cast<u8>(((64 - weight) * e0[channel] + weight * e1[channel] + 32) >> 6);
+        }
+        std::memcpy(&palette[entry], color.data(), sizeof(u32));
+    }
+#endif
+    return palette;
+}
+
+/// Swaps the alpha byte of each entry with the channel it is rotated into
+template <size_t size>
+void RotateBc7(std::array<u32, size>& palette, u32 alpha_shift) {
+    for (u32& color : palette) {
+        const u32 alpha = color >> 24;
+        const u32 channel = (color >> alpha_shift) & 0xFF;
+        color &= ~((0xFFU << alpha_shift) | 0xFF000000U);
+        color |= (alpha << alpha_shift) | (channel << 24);
+    }
+}
+
+/**
+ * Decodes BC7 blocks with separate color and alpha indices (modes 4 and 5). Colors and alphas
+ * come from their own palettes, merged after applying the channel rotation.
+ */
+template <size_t color_size, size_t alpha_size>
+void DecodeBc7SeparateAlpha(const std::array<u8, 4>& e0, const std::array<u8, 4>& e1,
+                            const std::array<u16, color_size>& color_weights,
+                            const std::array<u16, alpha_size>& alpha_weights,
+                            const std::array<u8, 16>& color_indices,
+                            const std::array<u8, 16>& alpha_indices, u32 rotation, u8* dst,
+                            size_t x, size_t y, size_t width, size_t height) {
+    auto color_palette = InterpolateBc7(e0, e1, color_weights);
+    auto alpha_palette = InterpolateBc7(e0, e1, alpha_weights);
+    // Rotation 0 keeps alpha in place, others swap it with red, green or blue
+    const u32 alpha_shift = rotation == 0 ? 24 : (rotation - 1) * 8;
+    if (rotation != 0) {
+        RotateBc7(color_palette, alpha_shift);
+        RotateBc7(alpha_palette, alpha_shift);
+    }
+    const u32 alpha_mask = 0xFFU << alpha_shift;
+    std::array<u32, 16> texels;
+    for (size_t texel = 0; texel < texels.size(); ++texel) {
+        texels[texel] = (color_palette[color_indices[texel]] & ~alpha_mask) |
+                        (alpha_palette[alpha_indices[texel]] & alpha_mask);
+    }
+    StoreBlock(texels, dst, x, y, width, height);
+}
+
+/// Decodes the single subset BC7 modes (4, 5 and 6), returns false for other modes
+bool DecodeBc7SingleSubset(const u8* src, u8* dst, size_t x, size_t y, size_t width,
+                           size_t height) {
+    const BlockBits bits{src};
+    const u8 mode_bits = bits.LowByte();
+    if ((mode_bits & 0x0F) != 0 || (mode_bits & 0x70) == 0) {
+        return false;
+    }
+    // Endpoints are stored as R0 R1 G0 G1 B0 B1 A0 A1
+    const auto read_endpoints = [&](u32 offset, u32 color_bits, u32 alpha_bits) {
+        std::array<std::array<u8, 4>, 2> endpoints;
+        for (u32 channel = 0; channel < 4; ++channel) {
+            const u32 channel_bits = channel < 3 ? color_bits : alpha_bits;
+            for (u32 endpoint = 0; endpoint < 2; ++endpoint) {
+                endpoints[endpoint][channel] = static_cast<u8>(bits.Get(offset, channel_bits));
+                offset += channel_bits;
+            }
+        }
+        return endpoints;
+    };
+    // Replicates the most significant bits of each channel into the low bits
+    const auto expand = [](std::array<u8, 4>& endpoint, u32 color_bits, u32 alpha_bits) {
+        for (u32 channel = 0; channel < 4; ++channel) {
+            const u32 channel_bits = channel < 3 ? color_bits : alpha_bits;
+            const u32 value = endpoint[channel] << (8 - channel_bits);
+            endpoint[channel] = static_cast<u8>(value | (value >> channel_bits));
+        }
+    };
+    switch (std::countr_zero(mode_bits)) {
+    case 4: {
+        auto [e0, e1] = read_endpoints(8, 5, 6);
+        expand(e0, 5, 6);
+        expand(e1, 5, 6);
+        const u32 rotation = bits.Get(5, 2);
+        const auto indices_2 = UnpackIndices<2>(bits.Get64(50));
+        const auto indices_3 = UnpackIndices<3>(bits.Get64(81));
+        if (bits.Get(7, 1) == 0) {
+            DecodeBc7SeparateAlpha(e0, e1, WEIGHTS_2, WEIGHTS_3, indices_2, indices_3, rotation,
+                                   dst, x, y, width, height);
+        } else {
+            DecodeBc7SeparateAlpha(e0, e1, WEIGHTS_3, WEIGHTS_2, indices_3, indices_2, rotation,
+                                   dst, x, y, width, height);
+        }
+        return true;
+    }
+    case 5: {
+        auto [e0, e1] = read_endpoints(8, 7, 8);
+        expand(e0, 7, 8);
+        expand(e1, 7, 8);
+        DecodeBc7SeparateAlpha(e0, e1, WEIGHTS_2, WEIGHTS_2, UnpackIndices<2>(bits.Get64(66)),
+                               UnpackIndices<2>(bits.Get64(97)), bits.Get(6, 2), dst, x, y,
+                               width, height);
+        return true;
+    }
+    default: {
+        // Mode 6, each endpoint has a P-bit appended to all of its channels
+        auto [e0, e1] = read_endpoints(7, 7, 7);
+        const u32 p0 = bits.Get(63, 1);
+        const u32 p1 = bits.Get(64, 1);
+        for (u32 channel = 0; channel < 4; ++channel) {
+            e0[channel] = static_cast<u8>((e0[channel] << 1) | p0);
+            e1[channel] = static_cast<u8>((e1[channel] << 1) | p1);
+        }
+        const auto palette = InterpolateBc7(e0, e1, WEIGHTS_4);
+        const auto indices = UnpackIndices<4>(bits.Get64(65));
+        std::array<u32, 16> texels;
+        for (size_t texel = 0; texel < texels.size(); ++texel) {
+            texels[texel] = palette[indices[texel]];
+        }
+        StoreBlock(texels, dst, x, y, width, height);
+        return true;
+    }
+    }
+}
+
+void DecodeBc7(const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height) {
+    if (!DecodeBc7SingleSubset(src, dst, x, y, width, height)) {
+        bcn::DecodeBc7(src, dst, x, y, width, height);
+    }
+}
+
+/// Sign extends the low 'bits' bits of a BC6H channel, keeping 16 bits
+constexpr u16 ExtendSign(u32 value, u32 bits) {
+    const u32 mask = 1U << (bits - 1);
+    return static_cast<u16>((value ^ mask) - mask);
+}
+
+/// Scales a BC6H endpoint channel to 16 bits
+constexpr u16 Unquantize(u16 value, u32 bits, bool is_signed) {
+    if (!is_signed) {
+        if (bits >= 15 || value == 0) {
+            return value;
+        }
+        if (value == (1U << bits) - 1) {
+            return 0xFFFF;
+        }
+        return static_cast<u16>(((u32{value} << 16) + 0x8000) >> bits);
+    }
+    if (bits >= 16 || value == 0) {
+        return value;
+    }
+    s32 magnitude = static_cast<s16>(value);
+    const bool is_negative = magnitude < 0;
+    if (is_negative) {
+        magnitude = -magnitude;
+    }
+    s32 result = 0x7FFF;
+    if (magnitude < (1 << (bits - 1)) - 1) {
+        result = ((magnitude << 15) + 0x4000) >> (bits - 1);
+    }
+    return static_cast<u16>(is_negative ? -result : result);
+}
+
+/**
+ * Interpolates the 16 entry palette of a single region BC6H block, then scales the results to
+ * the range of half floats. Entries are RGBA16F with alpha set to one.
+ */
+std::array<u64, 16> InterpolateBc6(const std::array<u16, 3>& e0, const std::array<u16, 3>& e1,
+                                   bool is_signed) {
+    constexpr u64 ALPHA_ONE = 0x3C00ULL << 48;
+    std::array<u64, 16> palette;
+    palette.fill(ALPHA_ONE);
+    for (size_t channel = 0; channel < 3; ++channel) {
+        const s32 c0 = is_signed ? static_cast<s16>(e0[channel]) : e0[channel];
+        const s32 c1 = is_signed ? static_cast<s16>(e1[channel]) : e1[channel];
+        const u32 shift = static_cast<u32>(channel * 16);
+#ifdef ARCHITECTURE_x86_64
+        // Products stay below 2^24, so single precision multiplies them exactly
+        const __m128 f0 = _mm_set1_ps(static_cast<float>(c0));
+        const __m128 f1 = _mm_set1_ps(static_cast<float>(c1));
+        const __m128i round = _mm_set1_epi32(32);
+        for (size_t entry = 0; entry < palette.size(); entry += 4) {
+            const __m128 w1 = _mm_setr_ps(WEIGHTS_4[entry], WEIGHTS_4[entry + 1],
+                                          WEIGHTS_4[entry + 2], WEIGHTS_4[entry + 3]);
+            const __m128 w0 = _mm_sub_ps(_mm_set1_ps(64.0f), w1);
+            const __m128 sum = _mm_add_ps(_mm_mul_ps(f0, w0), _mm_mul_ps(f1, w1));
+            const __m128i value =
+                _mm_srai_epi32(_mm_add_epi32(_mm_cvttps_epi32(sum), round), 6);
+            __m128i result;
+            if (is_signed) {
+                // Scale the magnitude by 31/32 and keep the sign bit, negative zero is zero
+                const __m128i sign = _mm_srai_epi32(value, 31);
+                const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(value, sign), sign);
+                const __m128i scaled =
+                    _mm_srli_epi32(_mm_sub_epi32(_mm_slli_epi32(magnitude, 5), magnitude), 5);
+                const __m128i is_zero = _mm_cmpeq_epi32(scaled, _mm_setzero_si128());
+                const __m128i sign_bit = _mm_and_si128(sign, _mm_set1_epi32(0x8000));
+                result = _mm_or_si128(scaled, _mm_andnot_si128(is_zero, sign_bit));
+            } else {
+                result = _mm_srli_epi32(_mm_sub_epi32(_mm_slli_epi32(value, 5), value), 6);
+            }
+            alignas(16) std::array<u32, 4> results;
+            _mm_store_si128(reinterpret_cast<__m128i*>(results.data()), result);
+            for (size_t lane = 0; lane < results.size(); ++lane) {
+                palette[entry + lane] |= u64{results[lane] & 0xFFFF} << shift;
+            }
+        }
+#else
+        for (size_t entry = 0; entry < palette.size(); ++entry) {
+            const s32 w1 = WEIGHTS_4[entry];
+            const u32 value = static_cast<u32>((c0 * (64 - w1) + c1 * w1 + 32) >> 6);
+            u32 result;
+            if (is_signed) {
+                result = (value & 0x80000000) != 0 ? (((~value + 1) * 31) >> 5) | 0x8000
+                                                    : (value * 31) >> 5;
+                if (result == 0x8000) {
+                    result = 0;
+                }
+            } else {
+                result = (value * 31) >> 6;
+            }
+            palette[entry] |= u64{result & 0xFFFF} << shift;
+        }
+#endif
+    }
+    return palette;
+}
+
+/// Decodes the single region BC6H modes, returns false for two region modes
+bool DecodeBc6SingleRegion(const u8* src, u8* dst, size_t x, size_t y, size_t width,
+                           size_t height, bool is_signed) {
+    const BlockBits bits{src};
+    const u32 mode = bits.LowByte() & 0x1F;
+    if ((mode & 0x13) != 0x03) {
+        return false;
+    }
+    // Modes 0b00011, 0b00111, 0b01011 and 0b01111
+    static constexpr std::array<u32, 4> ENDPOINT_BITS{10, 11, 12, 16};
+    static constexpr std::array<u32, 4> DELTA_BITS{10, 9, 8, 4};
+    const u32 endpoint_bits = ENDPOINT_BITS[mode >> 2];
+    const u32 delta_bits = DELTA_BITS[mode >> 2];
+    const bool has_delta = mode != 0x03;
+    const u32 high_bits = endpoint_bits - 10;
+
+    // The low 10 bits of the base endpoint come first, then each channel of the second endpoint
+    // followed by the high bits of the base endpoint in reverse order
+    std::array<u16, 3> e0;
+    std::array<u16, 3> e1;
+    u32 offset = 35;
+    for (u32 channel = 0; channel < 3; ++channel) {
+        u32 base = bits.Get(5 + channel * 10, 10);
+        e1[channel] = static_cast<u16>(bits.Get(offset, delta_bits));
+        offset += delta_bits;
+        if (high_bits > 0) {
+            for (u32 bit = 0; bit < high_bits; ++bit) {
+                base |= bits.Get(offset++, 1) << (endpoint_bits - 1 - bit);
+            }
+        }
+        e0[channel] = static_cast<u16>(base);
+    }
+    for (u32 channel = 0; channel < 3; ++channel) {
+        if (is_signed) {
+            e0[channel] = ExtendSign(e0[channel], endpoint_bits);
+        }
+        if (is_signed || has_delta) {
+            e1[channel] = ExtendSign(e1[channel], delta_bits);
+        }
+        if (has_delta) {
+            const u32 mask = (1U << endpoint_bits) - 1;
+            e1[channel] = static_cast<u16>((e0[channel] + e1[channel]) & mask);
+            if (is_signed) {
+                e1[channel] = ExtendSign(e1[channel], endpoint_bits);
+            }
+        }
+        e0[channel] = Unquantize(e0[channel], endpoint_bits, is_signed);
+        e1[channel] = Unquantize(e1[channel], endpoint_bits, is_signed);
+    }
+    const auto palette = InterpolateBc6(e0, e1, is_signed);
+    const auto indices = UnpackIndices<4>(bits.Get64(65));
+    std::array<u64, 16> texels;
+    for (size_t texel = 0; texel < texels.size(); ++texel) {
+        texels[texel] = palette[indices[texel]];
+    }
+    StoreBlock(texels, dst, x, y, width, height);
+    return true;
+}
+
+void DecodeBc6(const u8* src, u8* dst, size_t x, size_t y, size_t width, size_t height,
+               bool is_signed) {
+    if (!DecodeBc6SingleRegion(src, dst, x, y, width, height, is_signed)) {
+        bcn::DecodeBc6(src, dst, x, y, width, height, is_signed);
+    }
+}
 } // Anonymous namespace
 
 u32 ConvertedBytesPerBlock(VideoCore::Surface::PixelFormat pixel_format) {
@@ -70,12 +474,17 @@ void DecompressBlocks(std::span<const u8> input, std::span<u8> output, BufferIma
     const u32 block_width = std::min(width, BLOCK_SIZE);
     const u32 block_height = std::min(height, BLOCK_SIZE);
     const u32 pitch = width * out_bpp;
-    size_t input_offset = 0;
-    size_t output_offset = 0;
-    for (u32 slice = 0; slice < depth; ++slice) {
-        for (u32 y = 0; y < height; y += block_height) {
-            size_t src_offset = input_offset;
-            size_t dst_offset = output_offset;
+    const u32 rows = Common::DivideUp(height, block_height);
+    const u32 total_rows = rows * depth;
+    const size_t input_row_stride = copy.buffer_row_length * block_size / block_width;
+    const size_t output_row_stride = block_height * pitch;
+
+    // Rows of blocks are independent, row 'n' starts at 'n' strides in both input and output
+    const auto decompress_rows = [=](u32 first_row, u32 last_row) {
+        for (u32 row = first_row; row < last_row; ++row) {
+            const u32 y = (row % rows) * block_height;
+            size_t src_offset = row * input_row_stride;
+            size_t dst_offset = row * output_row_stride;
             for (u32 x = 0; x < width; x += block_width) {
                 const u8* src = input.data() + src_offset;
                 u8* const dst = output.data() + dst_offset;
@@ -87,10 +496,23 @@ void DecompressBlocks(std::span<const u8> input, std::span<u8> output, BufferIma
                 src_offset += block_size;
                 dst_offset += block_width * out_bpp;
             }
-            input_offset += copy.buffer_row_length * block_size / block_width;
-            output_offset += block_height * pitch;
         }
+    };
+
+    const u32 blocks_per_row = Common::DivideUp(width, block_width);
+    const u32 rows_per_task = std::max(1U, MIN_BLOCKS_PER_TASK / blocks_per_row);
+    if (total_rows <= rows_per_task) {
+        decompress_rows(0, total_rows);
+        return;
+    }
+    Common::ThreadWorker& workers{Tegra::Texture::GetThreadWorkers()};
+    for (u32 first_row = 0; first_row < total_rows; first_row += rows_per_task) {
+        const u32 last_row = std::min(total_rows, first_row + rows_per_task);
+        workers.QueueWork([decompress_rows, first_row, last_row] {
+            decompress_rows(first_row, last_row);
+        });
     }
+    workers.WaitForRequests();
 }
 
 void DecompressBCn(std::span<const u8> input, std::span<u8> output, BufferImageCopy& copy,
@@ -120,12 +542,12 @@ void DecompressBCn(std::span<const u8> input, std::span<u8> output, BufferImageC
         break;
     case PixelFormat::BC6H_SFLOAT:
     case PixelFormat::BC6H_UFLOAT:
-        DecompressBlocks<bcn::DecodeBc6, PixelFormat::BC6H_UFLOAT>(
+        DecompressBlocks<DecodeBc6, PixelFormat::BC6H_UFLOAT>(
             input, output, copy, pixel_format == PixelFormat::BC6H_SFLOAT);
         break;
     case PixelFormat::BC7_SRGB:
     case PixelFormat::BC7_UNORM:
-        DecompressBlocks<bcn::DecodeBc7, PixelFormat::BC7_UNORM>(input, output, copy);
+        DecompressBlocks<DecodeBc7, PixelFormat::BC7_UNORM>(input, output, copy);
         break;
     default:
         LOG_WARNING(HW_GPU, "Unimplemented BCn decompression {}", pixel_format);
@@ -102,6 +102,7 @@ struct ImageBase {
     VAddr cpu_addr_end = 0;
 
     u64 modification_tick = 0;
+    u64 last_use_tick = 0;
     size_t lru_index = SIZE_MAX;
 
     std::array<u32, MAX_MIP_LEVELS> mip_level_offsets{};
@@ -113,6 +114,8 @@ struct ImageBase {
     boost::container::small_vector<SubresourceBase, 16> slice_subresources;
 
     std::vector<AliasedImage> aliased_images;
+    /// Alias copies JoinImages left to SynchronizeAliases that have not run yet
+    u32 num_deferred_alias_copies = 0;
     std::vector<ImageId> overlapping_images;
     ImageMapId map_view_id{};
 };
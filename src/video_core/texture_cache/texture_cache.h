@@ -68,6 +68,15 @@ TextureCache<P>::TextureCache(Runtime& runtime_, Tegra::MaxwellDeviceMemoryManag
         critical_memory = DEFAULT_CRITICAL_MEMORY + 1_GiB;
         minimum_memory = 0;
     }
+    u64 budget = static_cast<u64>(Settings::values.vram_budget.GetValue()) * 1_MiB;
+    if (budget != 0) {
+        if constexpr (HAS_DEVICE_MEMORY_INFO) {
+            budget = std::min<u64>(budget, runtime.GetDeviceLocalMemory());
+        }
+        critical_memory = budget;
+        expected_memory = budget - budget / 5;
+        minimum_memory = budget / 4;
+    }
 }
 
 template <class P>
@@ -76,6 +85,8 @@ void TextureCache<P>::RunGarbageCollector() {
     bool aggressive_mode = false;
     u64 ticks_to_destroy = 0;
     size_t num_iterations = 0;
+    const u64 num_evictions = residency_stats.num_evictions;
+    const u64 evicted_bytes = residency_stats.evicted_bytes;
 
     const auto Configure = [&](bool allow_aggressive) {
         high_priority_mode = total_used_memory >= expected_memory;
@@ -83,13 +94,10 @@ void TextureCache<P>::RunGarbageCollector() {
         ticks_to_destroy = aggressive_mode ? 10ULL : high_priority_mode ? 25ULL : 50ULL;
         num_iterations = aggressive_mode ? 40 : (high_priority_mode ? 20 : 10);
     };
-    const auto Cleanup = [this, &num_iterations, &high_priority_mode,
-                          &aggressive_mode](ImageId image_id) {
-        if (num_iterations == 0) {
-            return true;
-        }
-        --num_iterations;
-        auto& image = slot_images[image_id];
+    const auto MustDownload = [](const Image& image) {
+        return image.IsSafeDownload() && False(image.flags & ImageFlagBits::BadOverlap);
+    };
+    const auto CanEvict = [&](const Image& image) {
         if (True(image.flags & ImageFlagBits::IsDecoding)) {
             // This image is still being decoded, deleting it will invalidate the slot
             // used by the async decoder thread.
@@ -98,50 +106,126 @@ void TextureCache<P>::RunGarbageCollector() {
         if (!aggressive_mode && True(image.flags & ImageFlagBits::CostlyLoad)) {
             return false;
         }
-        const bool must_download =
-            image.IsSafeDownload() && False(image.flags & ImageFlagBits::BadOverlap);
-        if (!high_priority_mode && must_download) {
-            return false;
-        }
-        if (must_download) {
+        return high_priority_mode || !MustDownload(image);
+    };
+    const auto Evict = [&](ImageId image_id) {
+        auto& image = slot_images[image_id];
+        const u64 used_memory = total_used_memory;
+        if (MustDownload(image)) {
             auto map = runtime.DownloadStagingBuffer(image.unswizzled_size_bytes);
             const auto copies = FullDownloadCopies(image.info);
             image.DownloadMemory(map, copies);
             runtime.Finish();
             SwizzleImage(*gpu_memory, image.gpu_addr, image.info, copies, map.mapped_span,
                          swizzle_data_buffer);
+            ++residency_stats.num_downloads;
         }
         if (True(image.flags & ImageFlagBits::Tracked)) {
             UntrackImage(image, image_id);
         }
         UnregisterImage(image_id);
         DeleteImage(image_id, image.scale_tick > frame_tick + 5);
-        if (total_used_memory < critical_memory) {
+        ++residency_stats.num_evictions;
+        residency_stats.evicted_bytes += used_memory - total_used_memory;
+    };
+    const auto Cleanup = [&] {
+        // Gather the least recently used images and evict those that are cheapest to reload
+        eviction_candidates.clear();
+        lru_cache.ForEachItemBelow(frame_tick - ticks_to_destroy, [&](ImageId image_id) {
+            const Image& image = slot_images[image_id];
+            if (CanEvict(image)) {
+                eviction_candidates.push_back({EvictionPriority(image), image_id});
+            }
+            return eviction_candidates.size() >= MAX_EVICTION_CANDIDATES;
+        });
+        std::ranges::stable_sort(eviction_candidates, std::ranges::greater{},
+                                 &EvictionCandidate::priority);
+        for (const EvictionCandidate& candidate : eviction_candidates) {
+            if (num_iterations == 0) {
+                return;
+            }
+            // The pressure may have dropped since the candidate was picked
+            if (!CanEvict(slot_images[candidate.image_id])) {
+                continue;
+            }
+            --num_iterations;
+            Evict(candidate.image_id);
+            if (total_used_memory >= critical_memory) {
+                continue;
+            }
             if (aggressive_mode) {
                 // Sink the aggresiveness.
                 num_iterations >>= 2;
                 aggressive_mode = false;
-                return false;
+                continue;
             }
             if (high_priority_mode && total_used_memory < expected_memory) {
                 num_iterations >>= 1;
                 high_priority_mode = false;
             }
         }
-        return false;
     };
 
     // Try to remove anything old enough and not high priority.
     Configure(false);
-    lru_cache.ForEachItemBelow(frame_tick - ticks_to_destroy, Cleanup);
+    Cleanup();
 
     // If pressure is still too high, prune aggressively.
     if (total_used_memory >= critical_memory) {
         Configure(true);
-        lru_cache.ForEachItemBelow(frame_tick - ticks_to_destroy, Cleanup);
+        Cleanup();
+    }
+    if (residency_stats.num_evictions != num_evictions) {
+        LOG_DEBUG(HW_GPU, "Evicted {} images ({} KiB), {} MiB of {} MiB in use",
+                  residency_stats.num_evictions - num_evictions,
+                  (residency_stats.evicted_bytes - evicted_bytes) / 1_KiB,
+                  total_used_memory / 1_MiB, critical_memory / 1_MiB);
+    }
+}
+
+template <class P>
+u64 TextureCache<P>::EvictionPriority(const ImageBase& image) const noexcept {
+    // Weight the age of the image by how expensive it is to bring it back
+    u64 reload_cost = 1;
+    if (True(image.flags & ImageFlagBits::CostlyLoad)) {
+        reload_cost *= 4;
+    }
+    if (image.IsSafeDownload()) {
+        // GPU modified contents have to be read back before eviction
+        reload_cost *= 2;
+    }
+    const u64 age = frame_tick - image.last_use_tick;
+    return (age << 8) / reload_cost;
+}
+
+template <class P>
+TextureCache<P>::~TextureCache() {
+    const TextureResidencyStatistics residency{GetResidencyStatistics()};
+    if (residency.num_evictions != 0) {
+        LOG_INFO(HW_GPU, "Texture cache evicted {} images ({} MiB), {} needed a readback",
+                 residency.num_evictions, residency.evicted_bytes / 1_MiB,
+                 residency.num_downloads);
+    }
+    const TextureAliasStatistics aliases{GetAliasStatistics()};
+    if (aliases.num_deferred_copies != 0) {
+        LOG_INFO(HW_GPU, "Texture cache deferred {} alias copies, made {} and avoided {}",
+                 aliases.num_deferred_copies, aliases.num_copies, aliases.num_avoided_copies);
     }
 }
 
+template <class P>
+TextureAliasStatistics TextureCache<P>::GetAliasStatistics() const noexcept {
+    return alias_stats;
+}
+
+template <class P>
+TextureResidencyStatistics TextureCache<P>::GetResidencyStatistics() const noexcept {
+    TextureResidencyStatistics stats{residency_stats};
+    stats.used_memory = total_used_memory;
+    stats.budget = critical_memory;
+    return stats;
+}
+
 template <class P>
 void TextureCache<P>::TickFrame() {
     // If we can obtain the memory info, use it instead of the estimate.
@@ -167,6 +251,11 @@ void TextureCache<P>::TickFrame() {
     }
 }
 
+template <class P>
+void TextureCache<P>::LoadDiskResources(u64 title_id) {
+    disk_cache.Load(title_id);
+}
+
 template <class P>
 const typename P::ImageView& TextureCache<P>::GetImageView(ImageViewId id) const noexcept {
     return slot_image_views[id];
@@ -558,14 +647,22 @@ void TextureCache<P>::DownloadMemory(DAddr cpu_addr, size_t size) {
     std::ranges::sort(images, [this](ImageId lhs, ImageId rhs) {
         return slot_images[lhs].modification_tick < slot_images[rhs].modification_tick;
     });
+    // Record every download before waiting, so the GPU is only waited on once
+    boost::container::small_vector<AsyncBuffer, 16> maps;
     for (const ImageId image_id : images) {
         Image& image = slot_images[image_id];
-        auto map = runtime.DownloadStagingBuffer(image.unswizzled_size_bytes);
+        auto map = runtime.DownloadStagingBuffer(image.unswizzled_size_bytes, true);
         const auto copies = FullDownloadCopies(image.info);
         image.DownloadMemory(map, copies);
-        runtime.Finish();
-        SwizzleImage(*gpu_memory, image.gpu_addr, image.info, copies, map.mapped_span,
+        maps.push_back(map);
+    }
+    runtime.Finish();
+    for (size_t index = 0; index < images.size(); ++index) {
+        Image& image = slot_images[images[index]];
+        const auto copies = FullDownloadCopies(image.info);
+        SwizzleImage(*gpu_memory, image.gpu_addr, image.info, copies, maps[index].mapped_span,
                      swizzle_data_buffer);
+        runtime.FreeDeferredStagingBuffer(maps[index]);
     }
 }
 
@@ -1087,11 +1184,23 @@ void TextureCache<P>::UploadImageContents(Image& image, StagingBuffer& staging)
         *gpu_memory, gpu_addr, image.guest_size_bytes, &swizzle_data_buffer);
 
     if (True(image.flags & ImageFlagBits::Converted)) {
+        u64 disk_cache_key{};
+        if (disk_cache.IsEnabled()) {
+            disk_cache_key = TextureDiskCache::MakeKey(image.info, swizzle_data);
+            // Only entries prefetched by the cache thread are used, the file is never read here
+            if (disk_cache.TryRead(disk_cache_key, mapped_span, disk_cache_copies)) {
+                image.UploadMemory(staging, disk_cache_copies);
+                return;
+            }
+        }
         unswizzle_data_buffer.resize_destructive(image.unswizzled_size_bytes);
         auto copies =
             UnswizzleImage(*gpu_memory, gpu_addr, image.info, swizzle_data, unswizzle_data_buffer);
         ConvertImage(unswizzle_data_buffer, image.info, mapped_span, copies);
         image.UploadMemory(staging, copies);
+        if (disk_cache.IsEnabled()) {
+            disk_cache.Write(disk_cache_key, mapped_span.first(image.converted_size_bytes), copies);
+        }
     } else {
         const auto copies =
             UnswizzleImage(*gpu_memory, gpu_addr, image.info, swizzle_data, mapped_span);
@@ -1292,16 +1401,32 @@ void TextureCache<P>::QueueAsyncDecode(Image& image, ImageId image_id) {
     Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::UnsafeRead> swizzle_data(
         *gpu_memory, image.gpu_addr, image.guest_size_bytes, &swizzle_data_buffer);
 
+    const size_t out_size = MapSizeBytes(image);
+
+    // The guest data is hashed here, the cache file is read by the decode worker
+    const bool use_disk_cache = disk_cache.IsEnabled();
+    const u64 disk_cache_key =
+        use_disk_cache ? TextureDiskCache::MakeKey(image.info, swizzle_data) : 0;
+
     auto copies = UnswizzleImage(*gpu_memory, image.gpu_addr, image.info, swizzle_data,
                                  local_unswizzle_data_buffer);
-    const size_t out_size = MapSizeBytes(image);
 
     auto func = [out_size, copies, info = image.info,
-                 input = std::move(local_unswizzle_data_buffer),
-                 async_decode = decode_ptr]() mutable {
+                 input = std::move(local_unswizzle_data_buffer), async_decode = decode_ptr,
+                 use_disk_cache, disk_cache_key, disk_cache = &disk_cache]() mutable {
         async_decode->decoded_data.resize_destructive(out_size);
+        if (use_disk_cache &&
+            disk_cache->Read(disk_cache_key, async_decode->decoded_data, copies)) {
+            std::unique_lock lock{async_decode->mutex};
+            async_decode->copies = std::move(copies);
+            async_decode->complete = true;
+            return;
+        }
         std::span copies_span{copies.data(), copies.size()};
         ConvertImage(input, info, async_decode->decoded_data, copies_span);
+        if (use_disk_cache) {
+            disk_cache->Write(disk_cache_key, async_decode->decoded_data, copies);
+        }
 
         // TODO: Do we need this lock?
         std::unique_lock lock{async_decode->mutex};
@@ -1550,22 +1675,34 @@ ImageId TextureCache<P>::JoinImages(const ImageInfo& info, GPUVAddr gpu_addr, DA
         }
     }
 
+    // Aliases keep their contents, so copying them can wait until the new image is used.
+    // SynchronizeAliases copies them then, unless the new image is overwritten first.
+    join_deferred_alias_ids.clear();
+    const auto copy_deferred_aliases = [&] {
+        for (const ImageId aliased_id : join_deferred_alias_ids) {
+            const AliasedImage& aliased =
+                new_image.aliased_images[join_alias_indices.at(aliased_id)];
+            CopyImage(new_image_id, aliased.id, aliased.copies);
+            new_image.modification_tick = slot_images[aliased_id].modification_tick;
+            ++alias_stats.num_copies;
+        }
+        join_deferred_alias_ids.clear();
+    };
     for (const auto& copy_object : join_copies_to_do) {
         Image& overlap = slot_images[copy_object.id];
         if (copy_object.is_alias) {
             if (!overlap.IsSafeDownload()) {
                 continue;
             }
-            const auto alias_pointer = join_alias_indices.find(copy_object.id);
-            if (alias_pointer == join_alias_indices.end()) {
+            if (!join_alias_indices.contains(copy_object.id)) {
                 continue;
             }
-            const AliasedImage& aliased = new_image.aliased_images[alias_pointer->second];
-            CopyImage(new_image_id, aliased.id, aliased.copies);
-            new_image.modification_tick = overlap.modification_tick;
+            join_deferred_alias_ids.push_back(copy_object.id);
             continue;
         }
         if (True(overlap.flags & ImageFlagBits::GpuModified)) {
+            // Older aliases have to be copied before newer contents
+            copy_deferred_aliases();
             new_image.flags |= ImageFlagBits::GpuModified;
             const auto& resolution = Settings::values.resolution_info;
             const SubresourceBase base = new_image.TryFindBase(overlap.gpu_addr).value();
@@ -1586,6 +1723,13 @@ ImageId TextureCache<P>::JoinImages(const ImageInfo& info, GPUVAddr gpu_addr, DA
         DeleteImage(copy_object.id);
     }
 
+    for (const ImageId aliased_id : join_deferred_alias_ids) {
+        if (new_image.modification_tick < slot_images[aliased_id].modification_tick) {
+            ++new_image.num_deferred_alias_copies;
+        }
+    }
+    alias_stats.num_deferred_copies += new_image.num_deferred_alias_copies;
+
     RegisterImage(new_image_id);
     return new_image_id;
 }
@@ -1999,6 +2143,7 @@ void TextureCache<P>::RegisterImage(ImageId image_id) {
     }
     total_used_memory += Common::AlignUp(tentative_size, 1024);
     image.lru_index = lru_cache.Insert(image_id, frame_tick);
+    image.last_use_tick = frame_tick;
 
     ForEachGPUPage(image.gpu_addr, image.guest_size_bytes, [this, image_id](u64 page) {
         (*channel_state->gpu_page_table)[page].push_back(image_id);
@@ -2325,6 +2470,7 @@ void TextureCache<P>::SynchronizeAliases(ImageId image_id) {
         const ImageBase& rhs_image = slot_images[rhs->id];
         return lhs_image.modification_tick < rhs_image.modification_tick;
     });
+    alias_stats.num_copies += aliased_images.size();
     const auto& resolution = Settings::values.resolution_info;
     for (const AliasedImage* const aliased : aliased_images) {
         if (!resolution.active || !any_rescaled) {
@@ -2350,14 +2496,21 @@ void TextureCache<P>::PrepareImage(ImageId image_id, bool is_modification, bool
         if (False(image.flags & ImageFlagBits::Tracked)) {
             TrackImage(image, image_id);
         }
+        if (is_modification) {
+            // Deferred alias copies are overwritten before being synchronized
+            alias_stats.num_avoided_copies += image.num_deferred_alias_copies;
+            image.num_deferred_alias_copies = 0;
+        }
     } else {
         RefreshContents(image, image_id);
         SynchronizeAliases(image_id);
+        image.num_deferred_alias_copies = 0;
     }
     if (is_modification) {
         MarkModification(image);
     }
     lru_cache.Touch(image.lru_index, frame_tick);
+    image.last_use_tick = frame_tick;
 }
 
 template <class P>
@@ -33,6 +33,7 @@
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view_base.h"
 #include "video_core/texture_cache/render_targets.h"
+#include "video_core/texture_cache/texture_disk_cache.h"
 #include "video_core/texture_cache/types.h"
 #include "video_core/textures/texture.h"
 
@@ -63,6 +64,26 @@ struct AsyncDecodeContext {
     std::atomic_bool complete;
 };
 
+struct TextureResidencyStatistics {
+    /// Estimated memory used by cached images
+    u64 used_memory{};
+    /// Memory usage above which images are evicted regardless of their cost
+    u64 budget{};
+    u64 num_evictions{};
+    u64 evicted_bytes{};
+    /// Evictions that had to read back GPU modified contents
+    u64 num_downloads{};
+};
+
+struct TextureAliasStatistics {
+    /// Alias copies left to SynchronizeAliases when joining images
+    u64 num_deferred_copies{};
+    /// Copies made from aliases into the images that use them
+    u64 num_copies{};
+    /// Deferred alias copies dropped because the image was overwritten before they ran
+    u64 num_avoided_copies{};
+};
+
 using TextureCacheGPUMap = std::unordered_map<u64, std::vector<ImageId>, Common::IdentityHash<u64>>;
 
 class TextureCacheChannelInfo : public ChannelInfo {
@@ -111,6 +132,7 @@ class TextureCache : public VideoCommon::ChannelSetupCaches<TextureCacheChannelI
     static constexpr s64 DEFAULT_EXPECTED_MEMORY = 1_GiB + 125_MiB;
     static constexpr s64 DEFAULT_CRITICAL_MEMORY = 1_GiB + 625_MiB;
     static constexpr size_t GC_EMERGENCY_COUNTS = 2;
+    static constexpr size_t MAX_EVICTION_CANDIDATES = 256;
 
     using Runtime = typename P::Runtime;
     using Image = typename P::Image;
@@ -130,10 +152,20 @@ class TextureCache : public VideoCommon::ChannelSetupCaches<TextureCacheChannelI
 
 public:
     explicit TextureCache(Runtime&, Tegra::MaxwellDeviceMemoryManager&);
+    ~TextureCache();
 
     /// Notify the cache that a new frame has been queued
     void TickFrame();
 
+    /// Load the persistent texture cache of a title
+    void LoadDiskResources(u64 title_id);
+
+    /// Return the counters of copies between aliased images
+    [[nodiscard]] TextureAliasStatistics GetAliasStatistics() const noexcept;
+
+    /// Return the memory usage and eviction counters of the cache
+    [[nodiscard]] TextureResidencyStatistics GetResidencyStatistics() const noexcept;
+
     /// Return a constant reference to the given image view id
     [[nodiscard]] const ImageView& GetImageView(ImageViewId id) const noexcept;
 
@@ -289,6 +321,9 @@ private:
     /// Runs the Garbage Collector.
     void RunGarbageCollector();
 
+    /// Returns how eagerly an image should be evicted, higher values are evicted first
+    [[nodiscard]] u64 EvictionPriority(const ImageBase& image) const noexcept;
+
     /// Fills image_view_ids in the image views in indices
     template <bool has_blacklists>
     void FillImageViews(DescriptorTable<TICEntry>& table,
@@ -443,6 +478,13 @@ private:
     u64 expected_memory;
     u64 critical_memory;
 
+    struct EvictionCandidate {
+        u64 priority;
+        ImageId image_id;
+    };
+    std::vector<EvictionCandidate> eviction_candidates;
+    TextureResidencyStatistics residency_stats;
+
     struct BufferDownload {
         GPUVAddr address;
         size_t size;
@@ -489,6 +531,10 @@ private:
     u64 modification_tick = 0;
     u64 frame_tick = 0;
 
+    // Declared before the decode worker, its queued jobs write to the disk cache
+    TextureDiskCache disk_cache;
+    boost::container::small_vector<BufferImageCopy, 16> disk_cache_copies;
+
     Common::ThreadWorker texture_decode_worker{1, "TextureDecoder"};
     std::vector<std::unique_ptr<AsyncDecodeContext>> async_decodes;
 
@@ -505,6 +551,9 @@ private:
     };
     boost::container::small_vector<JoinCopy, 4> join_copies_to_do;
     std::unordered_map<ImageId, size_t> join_alias_indices;
+    boost::container::small_vector<ImageId, 4> join_deferred_alias_ids;
+
+    TextureAliasStatistics alias_stats;
 };
 
 } // namespace VideoCommon
@@ -0,0 +1,444 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "common/zstd_compression.h"
+#include "video_core/texture_cache/texture_disk_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+constexpr u32 CACHE_MAGIC = Common::MakeMagic('Y', 'T', 'X', 'C');
+constexpr u32 CACHE_VERSION = 1;
+
+/// Upper bound of copies in an entry, used to reject corrupted entries
+constexpr u32 MAX_COPIES = 64;
+
+/// Size the cache file may grow to before it is trimmed
+constexpr u64 MAX_FILE_SIZE = 1ULL << 30;
+
+/// Size the cache file is trimmed down to, leaving room for new entries before the next trim
+constexpr u64 TRIM_TARGET_SIZE = MAX_FILE_SIZE / 4 * 3;
+
+/// Decompressed size of the entries prefetched for uploads on the render thread
+constexpr u64 MAX_PREFETCH_SIZE = 128ULL << 20;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+
+struct EntryHeader {
+    u64 key;
+    u64 payload_size;
+    u32 compressed_size;
+    u32 num_copies;
+};
+
+static_assert(std::is_trivially_copyable_v<BufferImageCopy>);
+} // Anonymous namespace
+
+TextureDiskCache::TextureDiskCache() = default;
+
+TextureDiskCache::~TextureDiskCache() = default;
+
+void TextureDiskCache::Load(u64 title_id) {
+    if (title_id == 0 || !Settings::values.use_disk_texture_cache.GetValue()) {
+        return;
+    }
+    const auto shader_dir{Common::FS::GetYuzuPath(Common::FS::YuzuPath::ShaderDir)};
+    const auto base_dir{shader_dir / fmt::format("{:016x}", title_id)};
+    if (!Common::FS::CreateDir(shader_dir) || !Common::FS::CreateDir(base_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create texture cache directories");
+        return;
+    }
+    {
+        std::scoped_lock lock{mutex, read_mutex};
+        Disable();
+        path = base_dir / "textures.bin";
+        file.Open(path, Common::FS::FileAccessMode::ReadAppend);
+        if (!file.IsOpen()) {
+            LOG_ERROR(Common_Filesystem, "Failed to open texture cache file");
+            return;
+        }
+        FileHeader header{};
+        if (!file.Seek(0) || !file.ReadObject(header) || header.magic != CACHE_MAGIC ||
+            header.version != CACHE_VERSION) {
+            // Missing, foreign or outdated cache, start over
+            if (!file.SetSize(0) || !file.WriteObject(FileHeader{CACHE_MAGIC, CACHE_VERSION}) ||
+                !file.Flush()) {
+                LOG_ERROR(Common_Filesystem, "Failed to initialize texture cache file");
+                file.Close();
+                return;
+            }
+            file_size = sizeof(FileHeader);
+        } else {
+            BuildIndex();
+        }
+        read_file.Open(path, Common::FS::FileAccessMode::Read, Common::FS::FileType::BinaryFile,
+                       Common::FS::FileShareFlag::ShareReadWrite);
+        if (!read_file.IsOpen()) {
+            LOG_ERROR(Common_Filesystem, "Failed to open texture cache file for reading");
+            Disable();
+            return;
+        }
+    }
+    // The cache is not enabled yet, so nothing else uses the file while it is trimmed
+    if (file_size > MAX_FILE_SIZE && !Trim()) {
+        return;
+    }
+    std::vector<std::pair<u64, u64>> prefetch_order;
+    prefetch_order.reserve(entries.size());
+    for (const auto& [key, entry] : entries) {
+        prefetch_order.emplace_back(entry.offset, key);
+    }
+    // File order approximates the order textures were first used in earlier sessions
+    std::ranges::sort(prefetch_order);
+    LOG_INFO(HW_GPU, "Loaded {} cached textures", entries.size());
+    is_enabled = true;
+    for (const auto& [offset, key] : prefetch_order) {
+        writer.QueueWork([this, key] { Prefetch(key); });
+    }
+}
+
+u64 TextureDiskCache::MakeKey(const ImageInfo& info, std::span<const u8> guest_data) {
+    const bool is_linear = info.type == ImageType::Linear;
+    const std::array<u32, 14> params{
+        static_cast<u32>(info.format),
+        static_cast<u32>(info.type),
+        info.size.width,
+        info.size.height,
+        info.size.depth,
+        static_cast<u32>(info.resources.levels),
+        static_cast<u32>(info.resources.layers),
+        is_linear ? info.pitch : info.block.width,
+        is_linear ? 0 : info.block.height,
+        is_linear ? 0 : info.block.depth,
+        info.layer_stride,
+        info.num_samples,
+        info.tile_width_spacing,
+        static_cast<u32>(Settings::values.astc_recompression.GetValue()),
+    };
+    const u64 data_hash =
+        Common::CityHash64(reinterpret_cast<const char*>(guest_data.data()), guest_data.size());
+    const u64 params_hash =
+        Common::CityHash64(reinterpret_cast<const char*>(params.data()), sizeof(params));
+    return Common::Hash128to64({data_hash, params_hash});
+}
+
+bool TextureDiskCache::Read(u64 key, std::span<u8> output,
+                            boost::container::small_vector<BufferImageCopy, 16>& copies) {
+    if (TakePrefetched(key, output, copies)) {
+        return true;
+    }
+    PrefetchedEntry entry;
+    if (!ReadEntry(key, output.size(), true, entry)) {
+        return false;
+    }
+    std::memcpy(output.data(), entry.payload.data(), entry.payload.size());
+    copies = std::move(entry.copies);
+    return true;
+}
+
+bool TextureDiskCache::TryRead(u64 key, std::span<u8> output,
+                               boost::container::small_vector<BufferImageCopy, 16>& copies) {
+    return TakePrefetched(key, output, copies);
+}
+
+void TextureDiskCache::Write(u64 key, std::span<const u8> payload,
+                             std::span<const BufferImageCopy> copies) {
+    if (!is_enabled) {
+        return;
+    }
+    std::vector<u8> payload_data(payload.begin(), payload.end());
+    std::vector<BufferImageCopy> copies_data(copies.begin(), copies.end());
+    writer.QueueWork([this, key, payload_data = std::move(payload_data),
+                      copies_data = std::move(copies_data)] {
+        const std::vector<u8> compressed =
+            Common::Compression::CompressDataZSTDDefault(payload_data.data(), payload_data.size());
+        Entry entry{
+            .offset = 0,
+            .payload_size = payload_data.size(),
+            .compressed_size = static_cast<u32>(compressed.size()),
+            .num_copies = static_cast<u32>(copies_data.size()),
+            .last_use = 0,
+        };
+        const u64 entry_size = EntrySize(entry);
+        if (sizeof(FileHeader) + entry_size > TRIM_TARGET_SIZE) {
+            return;
+        }
+
+        bool needs_trim;
+        {
+            std::scoped_lock lock{mutex};
+            if (!file.IsOpen() || entries.contains(key)) {
+                return;
+            }
+            needs_trim = file_size + entry_size > MAX_FILE_SIZE;
+        }
+        if (needs_trim && !Trim()) {
+            return;
+        }
+        std::scoped_lock lock{mutex};
+        if (!file.IsOpen() || !file.Seek(0, Common::FS::SeekOrigin::End)) {
+            return;
+        }
+        const EntryHeader header{
+            .key = key,
+            .payload_size = entry.payload_size,
+            .compressed_size = entry.compressed_size,
+            .num_copies = entry.num_copies,
+        };
+        if (!file.WriteObject(header) ||
+            file.WriteSpan(std::span(copies_data)) != copies_data.size() ||
+            file.WriteSpan(std::span(compressed)) != compressed.size() || !file.Flush()) {
+            // Leave the file as is, the truncated entry is dropped on the next load
+            LOG_ERROR(Common_Filesystem, "Failed to write to the texture cache file");
+            std::scoped_lock read_lock{read_mutex};
+            Disable();
+            return;
+        }
+        entry.offset = file_size + sizeof(EntryHeader);
+        entry.last_use = ++use_tick;
+        entries.emplace(key, entry);
+        file_size += entry_size;
+    });
+}
+
+u64 TextureDiskCache::EntrySize(const Entry& entry) {
+    return sizeof(EntryHeader) + u64{entry.num_copies} * sizeof(BufferImageCopy) +
+           entry.compressed_size;
+}
+
+bool TextureDiskCache::ReadEntry(u64 key, size_t max_size, bool touch, PrefetchedEntry& result) {
+    Entry entry;
+    u64 entry_generation;
+    {
+        std::scoped_lock lock{mutex};
+        const auto it = entries.find(key);
+        if (it == entries.end() || it->second.payload_size > max_size) {
+            return false;
+        }
+        if (touch) {
+            it->second.last_use = ++use_tick;
+        }
+        entry = it->second;
+        entry_generation = generation;
+    }
+    boost::container::small_vector<BufferImageCopy, 16> entry_copies(entry.num_copies);
+    std::vector<u8> compressed(entry.compressed_size);
+    {
+        std::scoped_lock read_lock{read_mutex};
+        if (generation != entry_generation || !read_file.IsOpen()) {
+            // The file was trimmed or closed since the lookup
+            return false;
+        }
+        if (!read_file.Seek(static_cast<s64>(entry.offset)) ||
+            read_file.ReadSpan(std::span(entry_copies.data(), entry_copies.size())) !=
+                entry_copies.size() ||
+            read_file.ReadSpan(std::span(compressed)) != compressed.size()) {
+            LOG_ERROR(Common_Filesystem, "Failed to read cached texture {:016x}", key);
+            return false;
+        }
+    }
+    std::vector<u8> payload = Common::Compression::DecompressDataZSTD(compressed);
+    if (payload.size() != entry.payload_size) {
+        LOG_ERROR(HW_GPU, "Cached texture {:016x} is corrupted", key);
+        return false;
+    }
+    result.payload = std::move(payload);
+    result.copies = std::move(entry_copies);
+    return true;
+}
+
+bool TextureDiskCache::TakePrefetched(u64 key, std::span<u8> output,
+                                      boost::container::small_vector<BufferImageCopy, 16>& copies) {
+    PrefetchedEntry entry;
+    {
+        std::scoped_lock lock{prefetch_mutex};
+        const auto it = prefetched.find(key);
+        if (it == prefetched.end() || it->second.payload.size() > output.size()) {
+            return false;
+        }
+        // The uploaded image keeps the contents, the payload won't be needed again
+        entry = std::move(it->second);
+        prefetched.erase(it);
+        prefetched_size -= entry.payload.size();
+    }
+    std::memcpy(output.data(), entry.payload.data(), entry.payload.size());
+    copies = std::move(entry.copies);
+
+    // Keep the entry on the next trim, unless the writer thread holds the index
+    std::unique_lock lock{mutex, std::try_to_lock};
+    if (lock.owns_lock()) {
+        if (const auto it = entries.find(key); it != entries.end()) {
+            it->second.last_use = ++use_tick;
+        }
+    }
+    return true;
+}
+
+void TextureDiskCache::Prefetch(u64 key) {
+    {
+        std::scoped_lock lock{prefetch_mutex};
+        if (prefetched_size >= MAX_PREFETCH_SIZE) {
+            return;
+        }
+    }
+    PrefetchedEntry entry;
+    if (!is_enabled || !ReadEntry(key, MAX_PREFETCH_SIZE, false, entry)) {
+        return;
+    }
+    std::scoped_lock lock{prefetch_mutex};
+    if (prefetched_size + entry.payload.size() > MAX_PREFETCH_SIZE) {
+        return;
+    }
+    prefetched_size += entry.payload.size();
+    prefetched.emplace(key, std::move(entry));
+}
+
+void TextureDiskCache::BuildIndex() {
+    const u64 disk_size = file.GetSize();
+    u64 offset = sizeof(FileHeader);
+    while (offset < disk_size) {
+        EntryHeader header;
+        if (!file.Seek(static_cast<s64>(offset)) || !file.ReadObject(header)) {
+            break;
+        }
+        // Entries are appended, so the file order approximates the order of last use
+        const Entry entry{
+            .offset = offset + sizeof(EntryHeader),
+            .payload_size = header.payload_size,
+            .compressed_size = header.compressed_size,
+            .num_copies = header.num_copies,
+            .last_use = ++use_tick,
+        };
+        const u64 entry_size = EntrySize(entry);
+        if (header.num_copies > MAX_COPIES || offset + entry_size > disk_size) {
+            break;
+        }
+        entries.insert_or_assign(header.key, entry);
+        offset += entry_size;
+    }
+    if (offset != disk_size) {
+        LOG_WARNING(Common_Filesystem, "Texture cache file is corrupted, dropping {} bytes",
+                    disk_size - offset);
+        if (!file.SetSize(offset)) {
+            LOG_ERROR(Common_Filesystem, "Failed to truncate texture cache file");
+        }
+    }
+    file_size = offset;
+}
+
+bool TextureDiskCache::Trim() {
+    std::vector<std::pair<u64, Entry>> kept;
+    {
+        std::scoped_lock lock{mutex};
+        kept.assign(entries.begin(), entries.end());
+    }
+    const size_t num_entries = kept.size();
+    std::ranges::sort(kept, std::greater{}, [](const auto& pair) { return pair.second.last_use; });
+    u64 new_size = sizeof(FileHeader);
+    size_t num_kept = 0;
+    for (; num_kept < kept.size(); ++num_kept) {
+        const u64 entry_size = EntrySize(kept[num_kept].second);
+        if (new_size + entry_size > TRIM_TARGET_SIZE) {
+            break;
+        }
+        new_size += entry_size;
+    }
+    kept.resize(num_kept);
+    // Write the least recently used entries first, so the order is kept when the file is reloaded
+    std::ranges::reverse(kept);
+
+    // Only the writer thread appends to the file, so its entries can be copied without the locks
+    auto temp_path = path;
+    temp_path += ".tmp";
+    Common::FS::IOFile temp{temp_path, Common::FS::FileAccessMode::Write};
+    bool success = temp.IsOpen() && temp.WriteObject(FileHeader{CACHE_MAGIC, CACHE_VERSION});
+    u64 offset = sizeof(FileHeader);
+    std::vector<u8> data;
+    for (auto& [key, entry] : kept) {
+        if (!success) {
+            break;
+        }
+        const EntryHeader header{
+            .key = key,
+            .payload_size = entry.payload_size,
+            .compressed_size = entry.compressed_size,
+            .num_copies = entry.num_copies,
+        };
+        data.resize(EntrySize(entry) - sizeof(EntryHeader));
+        success = file.Seek(static_cast<s64>(entry.offset)) &&
+                  file.ReadSpan(std::span(data)) == data.size() && temp.WriteObject(header) &&
+                  temp.WriteSpan(std::span<const u8>(data)) == data.size();
+        entry.offset = offset + sizeof(EntryHeader);
+        offset += EntrySize(entry);
+    }
+    temp.Close();
+
+    std::scoped_lock lock{mutex, read_mutex};
+    file.Close();
+    read_file.Close();
+    std::error_code ec;
+    if (success) {
+        std::filesystem::rename(temp_path, path, ec);
+    }
+    if (!success || ec) {
+        LOG_ERROR(Common_Filesystem, "Failed to trim the texture cache file");
+        std::filesystem::remove(temp_path, ec);
+        Disable();
+        return false;
+    }
+    file.Open(path, Common::FS::FileAccessMode::ReadAppend);
+    read_file.Open(path, Common::FS::FileAccessMode::Read, Common::FS::FileType::BinaryFile,
+                   Common::FS::FileShareFlag::ShareReadWrite);
+    if (!file.IsOpen() || !read_file.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Failed to reopen the texture cache file");
+        Disable();
+        return false;
+    }
+    LOG_INFO(HW_GPU, "Trimmed texture cache from {} to {} entries", num_entries, kept.size());
+    // Lookups made during the copy updated the last use of the entries
+    std::unordered_map<u64, Entry> kept_entries;
+    for (auto& [key, entry] : kept) {
+        if (const auto it = entries.find(key); it != entries.end()) {
+            entry.last_use = it->second.last_use;
+        }
+        kept_entries.emplace(key, entry);
+    }
+    entries = std::move(kept_entries);
+    file_size = offset;
+    ++generation;
+    return true;
+}
+
+void TextureDiskCache::Disable() {
+    is_enabled = false;
+    file.Close();
+    read_file.Close();
+    entries.clear();
+    file_size = 0;
+    ++generation;
+    std::scoped_lock lock{prefetch_mutex};
+    prefetched.clear();
+    prefetched_size = 0;
+}
+
+} // namespace VideoCommon
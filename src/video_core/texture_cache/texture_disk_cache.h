@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "common/common_types.h"
+#include "common/fs/file.h"
+#include "common/thread_worker.h"
+#include "video_core/texture_cache/image_info.h"
+#include "video_core/texture_cache/types.h"
+
+namespace VideoCommon {
+
+/**
+ * Persistent cache of converted (decoded or transcoded) texture contents.
+ *
+ * Entries are keyed by a hash of the guest texture bytes and the image parameters that affect the
+ * conversion, and store the zstd compressed host payload with the buffer copies needed to upload
+ * it. Entries are appended to a per title file in a background thread. When the file outgrows its
+ * size limit it is rewritten keeping only the most recently used entries.
+ *
+ * After loading, the background thread also reads and decompresses entries in file order, up to a
+ * memory budget, so uploads on the render thread can take them without touching the file.
+ */
+class TextureDiskCache {
+public:
+    explicit TextureDiskCache();
+    ~TextureDiskCache();
+
+    /// Open the cache file of a title, does nothing when the disk texture cache is disabled
+    void Load(u64 title_id);
+
+    /// Return true when a cache file is open and lookups can be made
+    [[nodiscard]] bool IsEnabled() const noexcept {
+        return is_enabled;
+    }
+
+    /// Return the key identifying the converted contents of a guest image
+    [[nodiscard]] static u64 MakeKey(const ImageInfo& info, std::span<const u8> guest_data);
+
+    /// Read a cached payload into output and its upload copies into copies, reading the cache file
+    /// when the entry was not prefetched
+    /// @retval True on a cache hit, false otherwise
+    [[nodiscard]] bool Read(u64 key, std::span<u8> output,
+                            boost::container::small_vector<BufferImageCopy, 16>& copies);
+
+    /// Same as Read, but only takes prefetched entries and never reads the cache file
+    [[nodiscard]] bool TryRead(u64 key, std::span<u8> output,
+                               boost::container::small_vector<BufferImageCopy, 16>& copies);
+
+    /// Queue a converted payload to be stored in the cache
+    void Write(u64 key, std::span<const u8> payload, std::span<const BufferImageCopy> copies);
+
+private:
+    struct Entry {
+        u64 offset;
+        u64 payload_size;
+        u32 compressed_size;
+        u32 num_copies;
+        u64 last_use;
+    };
+
+    struct PrefetchedEntry {
+        std::vector<u8> payload;
+        boost::container::small_vector<BufferImageCopy, 16> copies;
+    };
+
+    /// Return the size in the file of an entry, including its header
+    [[nodiscard]] static u64 EntrySize(const Entry& entry);
+
+    /// Read and decompress an entry from the cache file
+    /// @param touch Mark the entry as used, keeping it on the next trim
+    bool ReadEntry(u64 key, size_t max_size, bool touch, PrefetchedEntry& result);
+
+    /// Move a prefetched entry to output and copies
+    bool TakePrefetched(u64 key, std::span<u8> output,
+                        boost::container::small_vector<BufferImageCopy, 16>& copies);
+
+    /// Read an entry into the prefetched entries, if it fits in the prefetch budget
+    void Prefetch(u64 key);
+
+    /// Build the entry index from the file contents, dropping any trailing corrupted entry
+    void BuildIndex();
+
+    /// Rewrite the file with the most recently used entries that fit in the trim target size.
+    /// Only called from the writer thread or before the cache is enabled, without locks held.
+    /// Entries are copied without blocking lookups, the locks are only taken to swap the files.
+    /// @retval True on success, false if the cache had to be disabled
+    bool Trim();
+
+    /// Close the cache files and disable the cache, mutex and read_mutex have to be held
+    void Disable();
+
+    std::atomic<bool> is_enabled = false;
+
+    std::mutex mutex;
+    std::filesystem::path path;
+    Common::FS::IOFile file;
+    std::unordered_map<u64, Entry> entries;
+    u64 file_size = 0;
+    u64 use_tick = 0;
+
+    /// Separate handle for lookups, so reads are not serialized with appends
+    std::mutex read_mutex;
+    Common::FS::IOFile read_file;
+    /// Incremented every time the file is rewritten, invalidating offsets read before it
+    u64 generation = 0;
+
+    std::mutex prefetch_mutex;
+    std::unordered_map<u64, PrefetchedEntry> prefetched;
+    u64 prefetched_size = 0;
+
+    Common::ThreadWorker writer{1, "TextureDiskCache"};
+};
+
+} // namespace VideoCommon
@@ -815,6 +815,82 @@ boost::container::small_vector<ImageCopy, 16> MakeReinterpretImageCopies(const I
     return copies;
 }
 
+FormatConversion FindFormatConversion(PixelFormat dst_format, PixelFormat src_format) noexcept {
+    switch (dst_format) {
+    case PixelFormat::R16_UNORM:
+        if (src_format == PixelFormat::D16_UNORM) {
+            return FormatConversion::D16ToR16;
+        }
+        break;
+    case PixelFormat::A8B8G8R8_UNORM:
+        if (src_format == PixelFormat::S8_UINT_D24_UNORM) {
+            return FormatConversion::D24S8ToABGR8;
+        }
+        if (src_format == PixelFormat::D24_UNORM_S8_UINT) {
+            return FormatConversion::S8D24ToABGR8;
+        }
+        if (src_format == PixelFormat::D32_FLOAT) {
+            return FormatConversion::D32FToABGR8;
+        }
+        break;
+    case PixelFormat::A8B8G8R8_SRGB:
+    case PixelFormat::B8G8R8A8_SRGB:
+    case PixelFormat::B8G8R8A8_UNORM:
+        if (src_format == PixelFormat::D32_FLOAT) {
+            return FormatConversion::D32FToABGR8;
+        }
+        break;
+    case PixelFormat::R32_FLOAT:
+        if (src_format == PixelFormat::D32_FLOAT) {
+            return FormatConversion::D32ToR32;
+        }
+        break;
+    case PixelFormat::D16_UNORM:
+        if (src_format == PixelFormat::R16_UNORM) {
+            return FormatConversion::R16ToD16;
+        }
+        break;
+    case PixelFormat::S8_UINT_D24_UNORM:
+        if (src_format == PixelFormat::A8B8G8R8_UNORM ||
+            src_format == PixelFormat::B8G8R8A8_UNORM) {
+            return FormatConversion::ABGR8ToD24S8;
+        }
+        break;
+    case PixelFormat::D32_FLOAT:
+        if (src_format == PixelFormat::A8B8G8R8_UNORM ||
+            src_format == PixelFormat::B8G8R8A8_UNORM ||
+            src_format == PixelFormat::A8B8G8R8_SRGB ||
+            src_format == PixelFormat::B8G8R8A8_SRGB) {
+            return FormatConversion::ABGR8ToD32F;
+        }
+        if (src_format == PixelFormat::R32_FLOAT) {
+            return FormatConversion::R32ToD32;
+        }
+        break;
+    default:
+        break;
+    }
+    return FormatConversion::None;
+}
+
+size_t MakeReinterpretBufferOffsets(std::span<const ImageCopy> copies, u32 bytes_per_block,
+                                    std::span<size_t> offsets) {
+    ASSERT(offsets.size() >= copies.size());
+    // Depth stencil copies need offsets aligned to 4 bytes
+    const size_t alignment = std::max(bytes_per_block, 4U);
+    size_t total_size = 0;
+    for (size_t i = 0; i < copies.size(); ++i) {
+        const ImageCopy& copy = copies[i];
+        total_size = Common::AlignUp(total_size, alignment);
+        offsets[i] = total_size;
+        const size_t num_texels = static_cast<size_t>(copy.extent.width) * copy.extent.height *
+                                  copy.extent.depth *
+                                  static_cast<size_t>(copy.dst_subresource.num_layers);
+        total_size += num_texels * bytes_per_block;
+    }
+    return total_size;
+}
+
 bool IsValidEntry(const Tegra::MemoryManager& gpu_memory, const TICEntry& config) {
     const GPUVAddr address = config.Address();
     if (address == 0) {
@@ -21,6 +21,20 @@ using Tegra::Texture::TICEntry;
 
 using LevelArray = std::array<u32, MAX_MIP_LEVELS>;
 
+/// Conversion passes for format pairs whose bits can't be copied unchanged
+enum class FormatConversion {
+    None,
+    D16ToR16,
+    R16ToD16,
+    D32ToR32,
+    R32ToD32,
+    D24S8ToABGR8,
+    S8D24ToABGR8,
+    D32FToABGR8,
+    ABGR8ToD24S8,
+    ABGR8ToD32F,
+};
+
 struct OverlapResult {
     GPUVAddr gpu_addr;
     VAddr cpu_addr;
@@ -60,6 +74,17 @@ struct OverlapResult {
 [[nodiscard]] boost::container::small_vector<ImageCopy, 16> MakeReinterpretImageCopies(
     const ImageInfo& src, u32 up_scale = 1, u32 down_shift = 0);
 
+/// Returns the conversion pass needed to copy src_format into dst_format
+[[nodiscard]] FormatConversion FindFormatConversion(
+    VideoCore::Surface::PixelFormat dst_format,
+    VideoCore::Surface::PixelFormat src_format) noexcept;
+
+/// Places each reinterpreted copy in its own range of a staging buffer, so every copy can be read
+/// into the buffer before any is written out. Offsets are aligned for depth stencil copies.
+/// @returns Size of the staging buffer
+[[nodiscard]] size_t MakeReinterpretBufferOffsets(std::span<const ImageCopy> copies,
+                                                  u32 bytes_per_block, std::span<size_t> offsets);
+
 [[nodiscard]] bool IsValidEntry(const Tegra::MemoryManager& gpu_memory, const TICEntry& config);
 
 [[nodiscard]] boost::container::small_vector<BufferImageCopy, 16> UnswizzleImage(
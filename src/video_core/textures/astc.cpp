@@ -5,6 +5,7 @@
 // <http://gamma.cs.unc.edu/FasTC/>
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cassert>
 #include <cstring>
@@ -13,6 +14,10 @@
 
 #include <boost/container/static_vector.hpp>
 
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/polyfill_ranges.h"
@@ -43,20 +48,29 @@ public:
     }
 
     constexpr u32 ReadBits(std::size_t nBits) {
+        // Consume as many bits as possible from the current byte on each iteration, bits past the
+        // end of the stream are read as zero like in ReadBit.
         u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
+        std::size_t shift = 0;
+        while (shift < nBits && bits_read < total_bits * 8) {
+            const std::size_t count =
+                std::min({nBits - shift, 8 - next_bit, total_bits * 8 - bits_read});
+            const u32 chunk = (static_cast<u32>(*cur_byte) >> next_bit) & ((1U << count) - 1);
+            ret |= chunk << shift;
+            shift += count;
+            bits_read += count;
+            next_bit += count;
+            if (next_bit >= 8) {
+                next_bit -= 8;
+                ++cur_byte;
+            }
         }
         return ret;
     }
 
     template <std::size_t nBits>
     constexpr u32 ReadBits() {
-        u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
-        }
-        return ret;
+        return ReadBits(nBits);
     }
 
 private:
@@ -815,6 +829,113 @@ public:
     }
 };
 
+/// Four values for each of the two endpoints of up to four partitions
+static constexpr u32 MAX_COLOR_VALUES = 32;
+
+/// Constants to unquantize color values with trits or quints, see ASTC spec C.2.13. The bits
+/// above the lowest one of a value are masked to x, and B is x * b_multiplier | x >> b_shift.
+struct ColorUnquantization {
+    u16 c;
+    u16 b_mask;
+    u16 b_multiplier;
+    u16 b_shift;
+};
+
+static constexpr std::array<ColorUnquantization, 7> TRIT_COLOR_UNQUANTIZATION{{
+    {},
+    {204, 0, 0, 16},
+    {93, 1, 0b100010110, 16},    // B = b000b0bb0
+    {44, 3, 0b010000101, 16},    // B = cb000cbcb
+    {22, 7, 0b001000001, 16},    // B = dcb000dcb
+    {11, 0xF, 0b000100000, 2},   // B = edcb000ed
+    {5, 0x1F, 0b000010000, 4},   // B = fedcb000f
+}};
+
+static constexpr std::array<ColorUnquantization, 6> QUINT_COLOR_UNQUANTIZATION{{
+    {},
+    {113, 0, 0, 16},
+    {54, 1, 0b100001100, 16},    // B = b0000bb00
+    {26, 3, 0b010000010, 1},     // B = cb0000cbc
+    {13, 7, 0b001000000, 1},     // B = dcb0000dc
+    {6, 0xF, 0b000100000, 3},    // B = edcb0000e
+}};
+
+/// Unquantizes color values sharing an encoding to the 0-255 range. Values are processed eight
+/// at a time, so the arrays are padded to MAX_COLOR_VALUES.
+static void UnquantizeColorValues(std::array<u16, MAX_COLOR_VALUES>& out,
+                                  const std::array<u16, MAX_COLOR_VALUES>& bit_values,
+                                  const std::array<u16, MAX_COLOR_VALUES>& digits,
+                                  IntegerEncoding encoding, u32 num_bits) {
+    if (encoding == IntegerEncoding::JustBits) {
+        if (num_bits == 0) {
+            out.fill(0);
+            return;
+        }
+        // Replicate bits, doubling the number of filled bits on each step
+        const u32 to_top = 8 - std::min(num_bits, 8U);
+#ifdef ARCHITECTURE_x86_64
+        for (u32 i = 0; i < MAX_COLOR_VALUES; i += 8) {
+            __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(&bit_values[i]));
+            value = _mm_sll_epi16(value, _mm_cvtsi32_si128(static_cast<int>(to_top)));
+            for (u32 filled = num_bits; filled < 8; filled *= 2) {
+                const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(filled));
+                value = _mm_or_si128(value, _mm_srl_epi16(value, shift));
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(&out[i]), value);
+        }
+#else
+        for (u32 i = 0; i < MAX_COLOR_VALUES; ++i) {
+            u32 value = static_cast<u32>(bit_values[i]) << to_top;
+            for (u32 filled = num_bits; filled < 8; filled *= 2) {
+                value |= value >> filled;
+            }
+            out[i] = static_cast<u16>(value);
+        }
+#endif
+        return;
+    }
+    ColorUnquantization params{};
+    if (encoding == IntegerEncoding::Trit && num_bits < TRIT_COLOR_UNQUANTIZATION.size()) {
+        params = TRIT_COLOR_UNQUANTIZATION[num_bits];
+    } else if (encoding == IntegerEncoding::Quint &&
+               num_bits < QUINT_COLOR_UNQUANTIZATION.size()) {
+        params = QUINT_COLOR_UNQUANTIZATION[num_bits];
+    } else {
+        assert(false && "Unsupported color value encoding!");
+    }
+    // T = D * C + B, then A (the lowest bit replicated 9 times) is xored in and the result is
+    // scaled down to 8 bits, keeping the top bit of A
+#ifdef ARCHITECTURE_x86_64
+    const __m128i c = _mm_set1_epi16(static_cast<s16>(params.c));
+    const __m128i b_mask = _mm_set1_epi16(static_cast<s16>(params.b_mask));
+    const __m128i b_multiplier = _mm_set1_epi16(static_cast<s16>(params.b_multiplier));
+    const __m128i b_shift = _mm_cvtsi32_si128(params.b_shift);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i a_mask = _mm_set1_epi16(0x1FF);
+    const __m128i top_bit = _mm_set1_epi16(0x80);
+    for (u32 i = 0; i < MAX_COLOR_VALUES; i += 8) {
+        const __m128i bits = _mm_load_si128(reinterpret_cast<const __m128i*>(&bit_values[i]));
+        const __m128i d = _mm_load_si128(reinterpret_cast<const __m128i*>(&digits[i]));
+        const __m128i x = _mm_and_si128(_mm_srli_epi16(bits, 1), b_mask);
+        const __m128i b = _mm_or_si128(_mm_mullo_epi16(x, b_multiplier), _mm_srl_epi16(x, b_shift));
+        const __m128i a =
+            _mm_and_si128(_mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(bits, one)), a_mask);
+        const __m128i t = _mm_xor_si128(_mm_add_epi16(_mm_mullo_epi16(d, c), b), a);
+        const __m128i result = _mm_or_si128(_mm_and_si128(a, top_bit), _mm_srli_epi16(t, 2));
+        _mm_store_si128(reinterpret_cast<__m128i*>(&out[i]), result);
+    }
+#else
+    for (u32 i = 0; i < MAX_COLOR_VALUES; ++i) {
+        const u32 bits = bit_values[i];
+        const u32 x = (bits >> 1) & params.b_mask;
+        const u32 b = (x * params.b_multiplier) | (x >> params.b_shift);
+        const u32 a = ReplicateBitTo9(bits & 1);
+        const u32 t = ((digits[i] * params.c) + b) ^ a;
+        out[i] = static_cast<u16>((a & 0x80) | (t >> 2));
+    }
+#endif
+}
+
 static void DecodeColorValues(u32* out, std::span<u8> data, const u32* modes, const u32 nPartitions,
                               const u32 nBitsForColorData) {
     // First figure out how many color values we have
@@ -852,136 +973,24 @@ static void DecodeColorValues(u32* out, std::span<u8> data, const u32* modes, co
 
     // Once we have the decoded values, we need to dequantize them to the 0-255 range
     // This procedure is outlined in ASTC spec C.2.13
-    u32 outIdx = 0;
-    for (auto itr = decodedColorValues.begin(); itr != decodedColorValues.end(); ++itr) {
-        // Have we already decoded all that we need?
-        if (outIdx >= nValues) {
-            break;
-        }
-
-        const IntegerEncodedValue& val = *itr;
-        u32 bitlen = val.num_bits;
-        u32 bitval = val.bit_value;
-
-        assert(bitlen >= 1);
-
-        u32 A = 0, B = 0, C = 0, D = 0;
-        // A is just the lsb replicated 9 times.
-        A = ReplicateBitTo9(bitval & 1);
-
-        switch (val.encoding) {
-        // Replicate bits
-        case IntegerEncoding::JustBits:
-            out[outIdx++] = FastReplicateTo8(bitval, bitlen);
-            break;
-
-        // Use algorithm in C.2.13
-        case IntegerEncoding::Trit: {
-
-            D = val.trit_value;
-
-            switch (bitlen) {
-            case 1: {
-                C = 204;
-            } break;
-
-            case 2: {
-                C = 93;
-                // B = b000b0bb0
-                u32 b = (bitval >> 1) & 1;
-                B = (b << 8) | (b << 4) | (b << 2) | (b << 1);
-            } break;
-
-            case 3: {
-                C = 44;
-                // B = cb000cbcb
-                u32 cb = (bitval >> 1) & 3;
-                B = (cb << 7) | (cb << 2) | cb;
-            } break;
-
-            case 4: {
-                C = 22;
-                // B = dcb000dcb
-                u32 dcb = (bitval >> 1) & 7;
-                B = (dcb << 6) | dcb;
-            } break;
-
-            case 5: {
-                C = 11;
-                // B = edcb000ed
-                u32 edcb = (bitval >> 1) & 0xF;
-                B = (edcb << 5) | (edcb >> 2);
-            } break;
-
-            case 6: {
-                C = 5;
-                // B = fedcb000f
-                u32 fedcb = (bitval >> 1) & 0x1F;
-                B = (fedcb << 4) | (fedcb >> 4);
-            } break;
-
-            default:
-                assert(false && "Unsupported trit encoding for color values!");
-                break;
-            } // switch(bitlen)
-        }     // case IntegerEncoding::Trit
-        break;
-
-        case IntegerEncoding::Quint: {
-
-            D = val.quint_value;
-
-            switch (bitlen) {
-            case 1: {
-                C = 113;
-            } break;
-
-            case 2: {
-                C = 54;
-                // B = b0000bb00
-                u32 b = (bitval >> 1) & 1;
-                B = (b << 8) | (b << 3) | (b << 2);
-            } break;
-
-            case 3: {
-                C = 26;
-                // B = cb0000cbc
-                u32 cb = (bitval >> 1) & 3;
-                B = (cb << 7) | (cb << 1) | (cb >> 1);
-            } break;
-
-            case 4: {
-                C = 13;
-                // B = dcb0000dc
-                u32 dcb = (bitval >> 1) & 7;
-                B = (dcb << 6) | (dcb >> 1);
-            } break;
-
-            case 5: {
-                C = 6;
-                // B = edcb0000e
-                u32 edcb = (bitval >> 1) & 0xF;
-                B = (edcb << 5) | (edcb >> 3);
-            } break;
-
-            default:
-                assert(false && "Unsupported quint encoding for color values!");
-                break;
-            } // switch(bitlen)
-        }     // case IntegerEncoding::Quint
-        break;
-        } // switch(val.encoding)
-
-        if (val.encoding != IntegerEncoding::JustBits) {
-            u32 T = D * C + B;
-            T ^= A;
-            T = (A & 0x80) | (T >> 2);
-            out[outIdx++] = T;
-        }
+    const u32 num_decoded = std::min(nValues, static_cast<u32>(decodedColorValues.size()));
+    if (num_decoded == 0) {
+        return;
     }
+    alignas(16) std::array<u16, MAX_COLOR_VALUES> bit_values{};
+    alignas(16) std::array<u16, MAX_COLOR_VALUES> digits{};
+    for (u32 i = 0; i < num_decoded; ++i) {
+        bit_values[i] = static_cast<u16>(decodedColorValues[i].bit_value);
+        digits[i] = static_cast<u16>(decodedColorValues[i].trit_value);
+    }
+    alignas(16) std::array<u16, MAX_COLOR_VALUES> values;
+    const IntegerEncodedValue& encoding = decodedColorValues[0];
+    assert(encoding.num_bits >= 1);
+    UnquantizeColorValues(values, bit_values, digits, encoding.encoding, encoding.num_bits);
+    std::copy_n(values.begin(), num_decoded, out);
 
     // Make sure that each of our values is in the proper range...
-    for (u32 i = 0; i < nValues; i++) {
+    for (u32 i = 0; i < num_decoded; i++) {
         assert(out[i] <= 255);
     }
 }
@@ -1419,8 +1428,8 @@ static void FillError(std::span<u32> outBuf, u32 blockWidth, u32 blockHeight) {
     }
 }
 
-static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
-                            const u32 blockHeight, std::span<u32, 12 * 12> outBuf) {
+void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth, const u32 blockHeight,
+                     std::span<u32, 12 * 12> outBuf) {
     InputBitStream strm(inBuf);
     TexelWeightParams weightParams = DecodeBlockInfo(strm);
 
@@ -1617,77 +1626,103 @@ static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
     u32 weights[2][144];
     UnquantizeTexelWeights(weights, texelWeightValues, weightParams, blockWidth, blockHeight);
 
+    // Expand the endpoints to 16 bits and resolve the plane of each channel once per block, so the
+    // per texel interpolation below is plain integer arithmetic
+    std::array<std::array<u32, 4>, 4> endpoints0;
+    std::array<std::array<u32, 4>, 4> endpoints1;
+    for (u32 i = 0; i < nPartitions; i++) {
+        for (u32 c = 0; c < 4; c++) {
+            u32 C0 = endpoints[i][0].Component(c);
+            endpoints0[i][c] = ReplicateByteTo16(C0);
+            u32 C1 = endpoints[i][1].Component(c);
+            endpoints1[i][c] = ReplicateByteTo16(C1);
+        }
+    }
+    std::array<u32, 4> planes{};
+    if (weightParams.m_bDualPlane) {
+        planes[(planeIdx + 1) & 3] = 1;
+    }
+
+    // Channels are stored as ARGB and packed as ABGR
+    static constexpr std::array<u32, 4> channel_shifts{24, 0, 8, 16};
+
     // Now that we have endpoints and weights, we can interpolate and generate
     // the proper decoding...
-    for (u32 j = 0; j < blockHeight; j++)
+    for (u32 j = 0; j < blockHeight; j++) {
         for (u32 i = 0; i < blockWidth; i++) {
-            u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions,
+            u32 partition = 0;
+            if (nPartitions > 1) {
+                partition = Select2DPartition(partitionIndex, i, j, nPartitions,
                                               (blockHeight * blockWidth) < 32);
-            assert(partition < nPartitions);
+                assert(partition < nPartitions);
+            }
 
-            Pixel p;
+            const u32 texel = j * blockWidth + i;
+            u32 packed = 0;
             for (u32 c = 0; c < 4; c++) {
-                u32 C0 = endpoints[partition][0].Component(c);
-                C0 = ReplicateByteTo16(C0);
-                u32 C1 = endpoints[partition][1].Component(c);
-                C1 = ReplicateByteTo16(C1);
-
-                u32 plane = 0;
-                if (weightParams.m_bDualPlane && (((planeIdx + 1) & 3) == c)) {
-                    plane = 1;
-                }
-
-                u32 weight = weights[plane][j * blockWidth + i];
-                u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
-                if (C == 65535) {
-                    p.Component(c) = 255;
-                } else {
-                    double Cf = static_cast<double>(C);
-                    p.Component(c) = static_cast<u16>(255.0 * (Cf / 65536.0) + 0.5);
-                }
+                const u32 weight = weights[planes[c]][texel];
+                const u32 C =
+                    (endpoints0[partition][c] * (64 - weight) + endpoints1[partition][c] * weight +
+                     32) /
+                    64;
+                // Same as rounding 255.0 * (C / 65536.0) in double precision, both are exact
+                packed |= ((C * 255 + 32768) >> 16) << channel_shifts[c];
             }
-
-            outBuf[j * blockWidth + i] = p.Pack();
+            outBuf[texel] = packed;
         }
+    }
 }
 
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
                 uint32_t block_width, uint32_t block_height, std::span<uint8_t> output) {
+    if (width == 0 || height == 0 || depth == 0) {
+        return;
+    }
     const u32 rows = Common::DivideUp(height, block_height);
     const u32 cols = Common::DivideUp(width, block_width);
 
+    // Group block rows so each task decodes a reasonable amount of blocks, small textures would
+    // otherwise spend more time queueing work than decoding it.
+    static constexpr u32 MIN_BLOCKS_PER_TASK = 256;
+    const u32 rows_per_task = std::max(1U, MIN_BLOCKS_PER_TASK / cols);
+
     Common::ThreadWorker& workers{GetThreadWorkers()};
 
+    // Queue every slice before waiting, so the workers are never idle between slices
     for (u32 z = 0; z < depth; ++z) {
         const u32 depth_offset = z * height * width * 4;
-        for (u32 y_index = 0; y_index < rows; ++y_index) {
-            auto decompress_stride = [data, width, height, block_width, block_height, output, rows,
-                                      cols, z, depth_offset, y_index] {
-                const u32 y = y_index * block_height;
-                for (u32 x_index = 0; x_index < cols; ++x_index) {
-                    const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
-                    const u32 x = x_index * block_width;
-
-                    const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
-
-                    // Blocks can be at most 12x12
-                    std::array<u32, 12 * 12> uncompData;
-                    DecompressBlock(blockPtr, block_width, block_height, uncompData);
-
-                    u32 decompWidth = std::min(block_width, width - x);
-                    u32 decompHeight = std::min(block_height, height - y);
-
-                    const std::span<u8> outRow = output.subspan(depth_offset + (y * width + x) * 4);
-                    for (u32 h = 0; h < decompHeight; ++h) {
-                        std::memcpy(outRow.data() + h * width * 4,
-                                    uncompData.data() + h * block_width, decompWidth * 4);
+        for (u32 first_row = 0; first_row < rows; first_row += rows_per_task) {
+            const u32 last_row = std::min(rows, first_row + rows_per_task);
+            auto decompress_rows = [data, width, height, block_width, block_height, output, rows,
+                                    cols, z, depth_offset, first_row, last_row] {
+                for (u32 y_index = first_row; y_index < last_row; ++y_index) {
+                    const u32 y = y_index * block_height;
+                    for (u32 x_index = 0; x_index < cols; ++x_index) {
+                        const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
+                        const u32 x = x_index * block_width;
+
+                        const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
+
+                        // Blocks can be at most 12x12
+                        std::array<u32, 12 * 12> uncompData;
+                        DecompressBlock(blockPtr, block_width, block_height, uncompData);
+
+                        u32 decompWidth = std::min(block_width, width - x);
+                        u32 decompHeight = std::min(block_height, height - y);
+
+                        const std::span<u8> outRow =
+                            output.subspan(depth_offset + (y * width + x) * 4);
+                        for (u32 h = 0; h < decompHeight; ++h) {
+                            std::memcpy(outRow.data() + h * width * 4,
+                                        uncompData.data() + h * block_width, decompWidth * 4);
+                        }
                     }
                 }
             };
-            workers.QueueWork(std::move(decompress_stride));
+            workers.QueueWork(std::move(decompress_rows));
         }
-        workers.WaitForRequests();
     }
+    workers.WaitForRequests();
 }
 
 } // namespace Tegra::Texture::ASTC
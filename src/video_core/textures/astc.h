@@ -8,4 +8,8 @@ namespace Tegra::Texture::ASTC {
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
                 uint32_t block_width, uint32_t block_height, std::span<uint8_t> output);
 
+/// Decodes a single block into packed RGBA8 texels, as done by Decompress
+void DecompressBlock(std::span<const uint8_t, 16> block, uint32_t block_width,
+                     uint32_t block_height, std::span<uint32_t, 12 * 12> output);
+
 } // namespace Tegra::Texture::ASTC
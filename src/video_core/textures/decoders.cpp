@@ -13,6 +13,17 @@
 #include "video_core/gpu.h"
 #include "video_core/textures/decoders.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DECODERS_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DECODERS_TARGET_AVX2
+#endif
+#endif
+
 namespace Tegra::Texture {
 namespace {
 template <u32 mask>
@@ -33,6 +44,179 @@ void incrpdep(u32& value) {
     value = ((value | ~mask) + swizzled_incr) & mask;
 }
 
+/// Size in bytes of the linear runs inside a GOB row (16 bytes x 2 sector packing)
+constexpr u32 GOB_SECTOR_SIZE = 16;
+constexpr u32 GOB_SECTOR_SIZE_SHIFT = 4;
+
+/// Offsets of the four sectors of a 64 bytes GOB row relative to the start of the row
+constexpr std::array<u32, GOB_SIZE_X / GOB_SECTOR_SIZE> GOB_ROW_SECTOR_OFFSETS{
+    pdep<SWIZZLE_X_BITS>(0 * GOB_SECTOR_SIZE),
+    pdep<SWIZZLE_X_BITS>(1 * GOB_SECTOR_SIZE),
+    pdep<SWIZZLE_X_BITS>(2 * GOB_SECTOR_SIZE),
+    pdep<SWIZZLE_X_BITS>(3 * GOB_SECTOR_SIZE),
+};
+
+/// Texels of these sizes never straddle a sector, so lines can be copied a sector at a time
+constexpr bool IsSectorCopyable(u32 bytes_per_pixel) {
+    return std::has_single_bit(bytes_per_pixel) && bytes_per_pixel <= GOB_SECTOR_SIZE;
+}
+
+/**
+ * Copies 'num_gobs' consecutive 64 bytes GOB rows of a line.
+ * @param swizzled_offset Offset of the first GOB row in the block linear buffer
+ * @param linear_offset   Offset of the first byte in the linear buffer
+ * @param gob_stride      Distance in bytes between two horizontally adjacent GOBs
+ */
+using GobRowCopyFn = void (*)(u8* output, const u8* input, u32 swizzled_offset, u32 linear_offset,
+                              u32 num_gobs, u32 gob_stride);
+
+template <bool TO_LINEAR>
+void CopySpan(u8* output, const u8* input, u32 swizzled_offset, u32 linear_offset, u32 size) {
+    if constexpr (TO_LINEAR) {
+        std::memcpy(output + swizzled_offset, input + linear_offset, size);
+    } else {
+        std::memcpy(output + linear_offset, input + swizzled_offset, size);
+    }
+}
+
+template <bool TO_LINEAR>
+void CopyGobRowsScalar(u8* output, const u8* input, u32 swizzled_offset, u32 linear_offset,
+                       u32 num_gobs, u32 gob_stride) {
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        for (u32 sector = 0; sector < GOB_ROW_SECTOR_OFFSETS.size(); ++sector) {
+            CopySpan<TO_LINEAR>(output, input, swizzled_offset + GOB_ROW_SECTOR_OFFSETS[sector],
+                                linear_offset + sector * GOB_SECTOR_SIZE, GOB_SECTOR_SIZE);
+        }
+        swizzled_offset += gob_stride;
+        linear_offset += GOB_SIZE_X;
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+template <bool TO_LINEAR>
+void CopyGobRowsSSE2(u8* output, const u8* input, u32 swizzled_offset, u32 linear_offset,
+                     u32 num_gobs, u32 gob_stride) {
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        if constexpr (TO_LINEAR) {
+            const auto* const src = reinterpret_cast<const __m128i*>(input + linear_offset);
+            u8* const dst = output + swizzled_offset;
+            const __m128i sector_0 = _mm_loadu_si128(src + 0);
+            const __m128i sector_1 = _mm_loadu_si128(src + 1);
+            const __m128i sector_2 = _mm_loadu_si128(src + 2);
+            const __m128i sector_3 = _mm_loadu_si128(src + 3);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[0]), sector_0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[1]), sector_1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[2]), sector_2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[3]), sector_3);
+        } else {
+            const u8* const src = input + swizzled_offset;
+            auto* const dst = reinterpret_cast<__m128i*>(output + linear_offset);
+            const __m128i sector_0 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + GOB_ROW_SECTOR_OFFSETS[0]));
+            const __m128i sector_1 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + GOB_ROW_SECTOR_OFFSETS[1]));
+            const __m128i sector_2 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + GOB_ROW_SECTOR_OFFSETS[2]));
+            const __m128i sector_3 =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + GOB_ROW_SECTOR_OFFSETS[3]));
+            _mm_storeu_si128(dst + 0, sector_0);
+            _mm_storeu_si128(dst + 1, sector_1);
+            _mm_storeu_si128(dst + 2, sector_2);
+            _mm_storeu_si128(dst + 3, sector_3);
+        }
+        swizzled_offset += gob_stride;
+        linear_offset += GOB_SIZE_X;
+    }
+}
+
+template <bool TO_LINEAR>
+DECODERS_TARGET_AVX2 void CopyGobRowsAVX2(u8* output, const u8* input, u32 swizzled_offset,
+                                          u32 linear_offset, u32 num_gobs, u32 gob_stride) {
+    // Sectors 0-1 and 2-3 are 32 bytes apart in the swizzled GOB, so each pair maps to one
+    // 32 bytes linear half of the row.
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        if constexpr (TO_LINEAR) {
+            const auto* const src = reinterpret_cast<const __m256i*>(input + linear_offset);
+            u8* const dst = output + swizzled_offset;
+            const __m256i low = _mm256_loadu_si256(src + 0);
+            const __m256i high = _mm256_loadu_si256(src + 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[0]),
+                             _mm256_castsi256_si128(low));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[1]),
+                             _mm256_extracti128_si256(low, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[2]),
+                             _mm256_castsi256_si128(high));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + GOB_ROW_SECTOR_OFFSETS[3]),
+                             _mm256_extracti128_si256(high, 1));
+        } else {
+            const u8* const src = input + swizzled_offset;
+            auto* const dst = reinterpret_cast<__m256i*>(output + linear_offset);
+            const auto load_sector = [src](u32 sector) {
+                return _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(src + GOB_ROW_SECTOR_OFFSETS[sector]));
+            };
+            const __m256i low =
+                _mm256_inserti128_si256(_mm256_castsi128_si256(load_sector(0)), load_sector(1), 1);
+            const __m256i high =
+                _mm256_inserti128_si256(_mm256_castsi128_si256(load_sector(2)), load_sector(3), 1);
+            _mm256_storeu_si256(dst + 0, low);
+            _mm256_storeu_si256(dst + 1, high);
+        }
+        swizzled_offset += gob_stride;
+        linear_offset += GOB_SIZE_X;
+    }
+}
+#endif
+
+template <bool TO_LINEAR>
+GobRowCopyFn SelectGobRowCopy() {
+#ifdef ARCHITECTURE_x86_64
+    if (Common::GetCPUCaps().avx2) {
+        return &CopyGobRowsAVX2<TO_LINEAR>;
+    }
+    return &CopyGobRowsSSE2<TO_LINEAR>;
+#else
+    return &CopyGobRowsScalar<TO_LINEAR>;
+#endif
+}
+
+template <bool TO_LINEAR>
+GobRowCopyFn GetGobRowCopy() {
+    static const GobRowCopyFn copy_gob_rows = SelectGobRowCopy<TO_LINEAR>();
+    return copy_gob_rows;
+}
+
+/**
+ * Copies the bytes [x_begin, x_end) of a line. Whole GOB rows are handed to 'copy_gob_rows', the
+ * unaligned head and tail are copied one sector at a time.
+ * @param row_offset    Swizzled offset of the line at x = 0, including the GOB row bits
+ * @param linear_offset Linear offset of the byte at x_begin
+ */
+template <bool TO_LINEAR>
+void CopyLine(u8* output, const u8* input, GobRowCopyFn copy_gob_rows, u32 row_offset,
+              u32 linear_offset, u32 x_shift, u32 x_begin, u32 x_end) {
+    const auto copy_sectors = [&](u32 begin, u32 end) {
+        while (begin < end) {
+            const u32 sector_end =
+                std::min(end, Common::AlignUpLog2(begin + 1, GOB_SECTOR_SIZE_SHIFT));
+            const u32 swizzled_offset = row_offset + ((begin >> GOB_SIZE_X_SHIFT) << x_shift) +
+                                        pdep<SWIZZLE_X_BITS>(begin);
+            CopySpan<TO_LINEAR>(output, input, swizzled_offset, linear_offset + (begin - x_begin),
+                                sector_end - begin);
+            begin = sector_end;
+        }
+    };
+    const u32 gob_begin = std::min(x_end, Common::AlignUpLog2(x_begin, GOB_SIZE_X_SHIFT));
+    const u32 gob_end = std::max(gob_begin, Common::AlignDown(x_end, GOB_SIZE_X));
+    copy_sectors(x_begin, gob_begin);
+    if (gob_end > gob_begin) {
+        copy_gob_rows(output, input, row_offset + ((gob_begin >> GOB_SIZE_X_SHIFT) << x_shift),
+                      linear_offset + (gob_begin - x_begin),
+                      (gob_end - gob_begin) >> GOB_SIZE_X_SHIFT, 1U << x_shift);
+    }
+    copy_sectors(gob_end, x_end);
+}
+
 template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
 void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
                  u32 block_height, u32 block_depth, u32 stride) {
@@ -55,6 +239,8 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
     const u32 block_depth_mask = (1U << block_depth) - 1;
     const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
 
+    [[maybe_unused]] const GobRowCopyFn copy_gob_rows = GetGobRowCopy<TO_LINEAR>();
+
     for (u32 slice = 0; slice < depth; ++slice) {
         const u32 z = slice + origin_z;
         const u32 offset_z = (z >> block_depth) * slice_size +
@@ -67,6 +253,15 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
             const u32 offset_y = (block_y >> block_height) * block_size +
                                  ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
 
+            if constexpr (IsSectorCopyable(BYTES_PER_PIXEL)) {
+                const u32 x_begin = origin_x * BYTES_PER_PIXEL;
+                CopyLine<TO_LINEAR>(output.data(), input.data(), copy_gob_rows,
+                                    offset_z + offset_y + swizzled_y,
+                                    slice * pitch * height + line * pitch, x_shift, x_begin,
+                                    x_begin + width * BYTES_PER_PIXEL);
+                continue;
+            }
+
             u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
             for (u32 column = 0; column < width;
                  ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
@@ -110,6 +305,8 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
     const u32 block_depth_mask = (1U << block_depth) - 1;
     const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
 
+    [[maybe_unused]] const GobRowCopyFn copy_gob_rows = GetGobRowCopy<TO_LINEAR>();
+
     u32 unprocessed_lines = num_lines;
     u32 extent_y = std::min(num_lines, height - origin_y);
 
@@ -126,6 +323,15 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
             const u32 offset_y = (block_y >> block_height) * block_size +
                                  ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
 
+            if constexpr (IsSectorCopyable(BYTES_PER_PIXEL)) {
+                const u32 x_begin = origin_x * BYTES_PER_PIXEL;
+                CopyLine<TO_LINEAR>(output.data(), input.data(), copy_gob_rows,
+                                    offset_z + offset_y + swizzled_y,
+                                    slice * pitch * height + line * pitch, x_shift, x_begin,
+                                    x_begin + extent_x * BYTES_PER_PIXEL);
+                continue;
+            }
+
             u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
             for (u32 column = 0; column < extent_x;
                  ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
@@ -143,6 +143,9 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
            tr("Allows saving shaders to storage for faster loading on following game "
               "boots.\nDisabling "
               "it is only intended for debugging."));
+    INSERT(Settings, use_disk_texture_cache, tr("Use disk texture cache"),
+           tr("Saves decoded ASTC and BCn textures to storage, skipping their decoding on "
+              "following game boots.\nRequires the disk pipeline cache to be enabled."));
     INSERT(
         Settings, use_asynchronous_gpu_emulation, tr("Use asynchronous GPU emulation"),
         tr("Uses an extra CPU thread for rendering.\nThis option should always remain enabled."));
@@ -169,6 +172,10 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
               "of available video memory for performance. Has no effect on integrated graphics. "
               "Aggressive mode may severely impact the performance of other applications such as "
               "recording software."));
+    INSERT(Settings, vram_budget, tr("Texture VRAM Budget (MiB):"),
+           tr("Limits the video memory used by cached textures. Least recently used textures that "
+              "are cheap to reload are evicted first when the budget is exceeded.\n"
+              "0 picks a budget from the available video memory."));
     INSERT(
         Settings, vsync_mode, tr("VSync Mode:"),
         tr("FIFO (VSync) does not drop frames or exhibit tearing but is limited by the screen "
@@ -221,6 +228,11 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
               "unlocked."));
     INSERT(Settings, barrier_feedback_loops, tr("Barrier feedback loops"),
            tr("Improves rendering of transparency effects in specific games."));
+    INSERT(Settings, use_gpu_fastmem, tr("Enable GPU Fastmem"),
+           tr("Mirrors GPU address spaces in host memory, so GPU reads and writes of guest memory "
+              "become direct pointer accesses.
+Reserves 1 TiB of host address space for each "
+              "GPU address space."));
 
     // Renderer (Debug)
 
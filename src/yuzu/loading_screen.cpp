@@ -83,11 +83,14 @@ LoadingScreen::LoadingScreen(QWidget* parent)
         {VideoCore::LoadCallbackStage::Prepare, tr("Loading...")},
         {VideoCore::LoadCallbackStage::Build, tr("Loading Shaders %1 / %2")},
         {VideoCore::LoadCallbackStage::Complete, tr("Launching...")},
+        {VideoCore::LoadCallbackStage::HotSetReady,
+         tr("Launching... %1 shaders will be built in the background")},
     };
     progressbar_style = {
         {VideoCore::LoadCallbackStage::Prepare, PROGRESSBAR_STYLE_PREPARE},
         {VideoCore::LoadCallbackStage::Build, PROGRESSBAR_STYLE_BUILD},
         {VideoCore::LoadCallbackStage::Complete, PROGRESSBAR_STYLE_COMPLETE},
+        {VideoCore::LoadCallbackStage::HotSetReady, PROGRESSBAR_STYLE_COMPLETE},
     };
 }
 
@@ -128,6 +131,11 @@ void LoadingScreen::OnLoadComplete() {
 void LoadingScreen::OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size_t value,
                                    std::size_t total) {
     using namespace std::chrono;
+    if (stage == VideoCore::LoadCallbackStage::Complete &&
+        previous_stage == VideoCore::LoadCallbackStage::HotSetReady) {
+        // Keep showing how many shaders are left to build in the background
+        return;
+    }
     const auto now = steady_clock::now();
     // reset the timer if the stage changes
     if (stage != previous_stage) {
@@ -147,8 +155,9 @@ void LoadingScreen::OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size
         ui->progress_bar->setMaximum(static_cast<int>(total));
         previous_total = total;
     }
-    // Reset the progress bar ranges if compilation is done
-    if (stage == VideoCore::LoadCallbackStage::Complete) {
+    // Reset the progress bar ranges if compilation is done, or continues after the boot
+    if (stage == VideoCore::LoadCallbackStage::Complete ||
+        stage == VideoCore::LoadCallbackStage::HotSetReady) {
         ui->progress_bar->setRange(0, 0);
     }
 
@@ -177,6 +186,8 @@ void LoadingScreen::OnLoadProgress(VideoCore::LoadCallbackStage stage, std::size
     // update labels and progress bar
     if (stage == VideoCore::LoadCallbackStage::Build) {
         ui->stage->setText(stage_translations[stage].arg(value).arg(total));
+    } else if (stage == VideoCore::LoadCallbackStage::HotSetReady) {
+        ui->stage->setText(stage_translations[stage].arg(total - value));
     } else {
         ui->stage->setText(stage_translations[stage]);
     }
@@ -10,6 +10,7 @@
 #include <thread>
 #include "core/hle/service/am/applet_manager.h"
 #include "core/loader/nca.h"
+#include "core/tools/guest_profiler.h"
 #include "core/tools/renderdoc.h"
 
 #ifdef __APPLE__
@@ -1049,9 +1050,17 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a Switch frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    readback_stall_label = new QLabel();
+    readback_stall_label->setToolTip(
+        tr("Share of time the game was blocked waiting for memory written by the GPU to be "
+           "downloaded. Only shown when it is at least 1%."));
+    gpu_invalidation_label = new QLabel();
+    gpu_invalidation_label->setToolTip(
+        tr("Average number of GPU cache invalidations per frame caused by the game writing to "
+           "memory used by the GPU. Only shown when there is at least one per frame."));
 
     for (auto& label : {shader_building_label, res_scale_label, emu_speed_label, game_fps_label,
-                        emu_frametime_label}) {
+                        emu_frametime_label, readback_stall_label, gpu_invalidation_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -1391,6 +1400,11 @@ void GMainWindow::InitializeHotkeys() {
             system->GetRenderdocAPI().ToggleCapture();
         }
     });
+    connect_shortcut(QStringLiteral("Toggle Guest Profiling"), [this] {
+        if (emulation_running) {
+            system->GetGuestProfiler().ToggleProfiling();
+        }
+    });
     connect_shortcut(QStringLiteral("Toggle Mouse Panning"), [&] {
         Settings::values.mouse_panning = !Settings::values.mouse_panning;
         if (Settings::values.mouse_panning) {
@@ -2190,6 +2204,8 @@ void GMainWindow::OnEmulationStopped() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    readback_stall_label->setVisible(false);
+    gpu_invalidation_label->setVisible(false);
     renderer_status_button->setEnabled(!UISettings::values.has_broken_vulkan);
 
     if (!firmware_label->text().isEmpty()) {
@@ -4663,11 +4679,17 @@ void GMainWindow::UpdateStatusBar() {
             tr("Game: %1 FPS").arg(std::round(results.average_game_fps), 0, 'f', 0));
     }
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    readback_stall_label->setText(
+        tr("Readback: %1%").arg(results.readback_stall * 100.0, 0, 'f', 0));
+    gpu_invalidation_label->setText(
+        tr("Invalidations: %1 / frame").arg(results.gpu_invalidations, 0, 'f', 0));
 
     res_scale_label->setVisible(true);
     emu_speed_label->setVisible(!Settings::values.use_multi_core.GetValue());
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    readback_stall_label->setVisible(results.readback_stall >= 0.01);
+    gpu_invalidation_label->setVisible(results.gpu_invalidations >= 1.0);
     firmware_label->setVisible(false);
 }
 